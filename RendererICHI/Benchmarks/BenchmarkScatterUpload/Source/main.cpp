@@ -0,0 +1,276 @@
+#include <chrono>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <vulkan/vulkan.h>
+#include <GLFW/glfw3.h>
+
+#include <Util/Assert.h>
+#include <Util/Util.h>
+
+#include <Std/vector.h>
+
+#include <AsyncUploadQueue.h>
+#include <Buffer.h>
+#include <CommandBuffer.h>
+#include <CommandPoolManager.h>
+#include <RenderWindow.h>
+#include <RendererState.h>
+#include <ResourceDeleter.h>
+#include <ResourceTracker.h>
+#include <ScatterUploader.h>
+#include <Surface.h>
+#include <TimelineSemaphore.h>
+#include <VulkanDevice.h>
+#include <VulkanInstance.h>
+
+// Measures the time of updating many small, scattered records of a device local Buffer with copy regions compared to the
+// compute scatter of the ScatterUploader. The records are written on the graphics queue, and every batch is waited on, the
+// times include the recording and the submission of the CommandBuffer.
+
+namespace
+{
+namespace Internal
+{
+static constexpr uint64_t RecordSizeInBytes = 64u;
+// Every other record is updated, so neighbouring updates can't be merged into a single region
+static constexpr uint64_t RecordStrideInBytes = RecordSizeInBytes * 2u;
+static constexpr uint32_t MaxRecordCount = 65536u;
+static constexpr uint32_t IterationCount = 64u;
+
+enum class UploadMode : uint32_t
+{
+   CopyRegions = 0u,
+   Scatter,
+};
+
+const char* UploadModeToString(UploadMode p_uploadMode)
+{
+   switch (p_uploadMode)
+   {
+   case UploadMode::CopyRegions:
+      return "copy regions";
+   case UploadMode::Scatter:
+      return "scatter";
+   default:
+      return "invalid";
+   }
+}
+
+Render::Ptr<Render::VulkanDevice> SelectPhysicalDeviceAndCreate(Render::Ptr<Render::VulkanInstance> p_vulkanInstance,
+                                                                Render::Ptr<Render::Surface> p_surface)
+{
+   using namespace Render;
+
+   for (uint32_t i = 0u; i < p_vulkanInstance->GetPhysicalDevicesCount(); i++)
+   {
+      Ptr<VulkanDevice> vulkanDevice = VulkanDevice::CreateInstance(
+          VulkanDeviceDescriptor{.m_vulkanInstance = p_vulkanInstance, .m_physicalDeviceIndex = i, .m_surface = p_surface.get()});
+
+      // The copies and the dispatches are recorded on the same queue
+      const uint32_t queueFamilyIndex =
+          vulkanDevice->SupportQueueFamilyFlags(VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT);
+      if (queueFamilyIndex == static_cast<uint32_t>(-1) || !vulkanDevice->IsBufferDeviceAddressSupported() ||
+          !vulkanDevice->IsDeviceExtensionSupported(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME))
+      {
+         continue;
+      }
+
+      vulkanDevice->CreateLogicalDevice({VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME});
+      return vulkanDevice;
+   }
+
+   ASSERT(false, "There is no PhysicalDevice that supports buffer device addresses");
+   return nullptr;
+}
+
+// Returns the average time of a batch in milliseconds
+double Measure(Render::Ptr<Render::VulkanDevice> p_vulkanDevice, Render::ScatterUploader& p_scatterUploader,
+               Render::Ptr<Render::TimelineSemaphore> p_timelineSemaphore, uint64_t& p_timelineValue, UploadMode p_uploadMode,
+               Render::Ptr<Render::Buffer> p_stagingBuffer, uint8_t* p_stagingData, Render::Ptr<Render::Buffer> p_destBuffer,
+               Std::span<const Render::ScatterUploadRequest> p_scatterUploadRequests)
+{
+   using namespace Render;
+
+   double totalSeconds = 0.0;
+   for (uint32_t i = 0u; i < IterationCount; i++)
+   {
+      const auto startTime = std::chrono::steady_clock::now();
+
+      CommandBufferDescriptor commandBufferDesc;
+      commandBufferDesc.m_vulkanDevice = p_vulkanDevice;
+      commandBufferDesc.m_queueType = QueueFamilyType::GraphicsQueue;
+      Ptr<CommandBuffer> commandBuffer = CommandBuffer::CreateInstance(eastl::move(commandBufferDesc));
+
+      switch (p_uploadMode)
+      {
+      case UploadMode::CopyRegions:
+      {
+         // Pack the records in the staging memory, and copy every record with its own region
+         Std::vector<BufferCopyRegion> copyRegions;
+         copyRegions.reserve(p_scatterUploadRequests.size());
+         uint64_t stagingOffset = 0u;
+         for (const ScatterUploadRequest& scatterUploadRequest : p_scatterUploadRequests)
+         {
+            memcpy(p_stagingData + stagingOffset, scatterUploadRequest.m_sourceData, scatterUploadRequest.m_sizeInBytes);
+            copyRegions.push_back(BufferCopyRegion{.m_srcOffset = stagingOffset,
+                                                   .m_destOffset = scatterUploadRequest.m_destOffsetInBytes,
+                                                   .m_size = scatterUploadRequest.m_sizeInBytes});
+            stagingOffset += scatterUploadRequest.m_sizeInBytes;
+         }
+         commandBuffer->CopyBuffer(p_stagingBuffer, p_destBuffer, copyRegions);
+         break;
+      }
+      case UploadMode::Scatter:
+         p_scatterUploader.ScatterUpload(commandBuffer.get(), p_destBuffer, p_scatterUploadRequests);
+         break;
+      }
+
+      commandBuffer->Compile();
+
+      p_timelineValue++;
+      TimelineSemaphoreSubmitInfo signalTimelineSemaphore{.m_timelineSemaphore = p_timelineSemaphore,
+                                                          .p_waitOrSignalValue = p_timelineValue,
+                                                          .m_stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT};
+      Std::vector<Ptr<CommandBuffer>> commandBuffers{commandBuffer};
+      Std::vector<TimelineSemaphoreSubmitInfo> signalTimelineSemaphores{signalTimelineSemaphore};
+      p_vulkanDevice->QueueSubmit(QueueFamilyType::GraphicsQueue, commandBuffers, {}, {}, {}, signalTimelineSemaphores, {});
+      p_timelineSemaphore->WaitForValue(p_timelineValue);
+
+      const auto endTime = std::chrono::steady_clock::now();
+      totalSeconds += std::chrono::duration<double>(endTime - startTime).count();
+
+      // The batch is complete, the staging memory of the ScatterUploader can be reused
+      RenderStateInterface::Get()->IncrementFrameIndex();
+      ResourceDeleterInterface::Get()->DeleteStaleResources();
+   }
+
+   return totalSeconds / static_cast<double>(IterationCount) * 1e3;
+}
+
+void RunBenchmark()
+{
+   using namespace Render;
+
+   ASSERT(glfwInit(), "Failed to initialize glfw");
+
+   // The window is only used to create the Surface that the VulkanDevice requires
+   Ptr<RenderWindow> renderWindow = RenderWindow::CreateInstance(
+       RenderWindowDescriptor{.m_windowResolution = glm::uvec2(256u, 256u), .m_windowTitle = "BenchmarkScatterUpload"});
+
+   Ptr<VulkanInstance> vulkanInstance = VulkanInstance::CreateInstance(
+       VulkanInstanceDescriptor{.m_instanceName = "BenchmarkScatterUpload",
+                                .m_version = VK_API_VERSION_1_3,
+                                .m_debug = false,
+                                .m_layers = {},
+                                .m_instanceExtensions = {VK_KHR_SURFACE_EXTENSION_NAME, "VK_KHR_win32_surface"}});
+
+   Ptr<Surface> surface =
+       Surface::CreateInstance(SurfaceDescriptor{.m_vulkanInstance = vulkanInstance, .m_renderWindow = renderWindow});
+
+   Ptr<VulkanDevice> vulkanDevice = SelectPhysicalDeviceAndCreate(vulkanInstance, surface);
+
+   Std::unique_ptr<AsyncUploadQueue> asyncUploadQueue(
+       new AsyncUploadQueue(AsyncUploadQueueDescriptor{.m_vulkanDevice = vulkanDevice}));
+   AsyncUploadQueueInterface::Register(asyncUploadQueue.get());
+
+   Std::unique_ptr<CommandPoolManager> commandPoolManager(
+       new CommandPoolManager(CommandPoolManagerDescriptor{.m_vulkanDevice = vulkanDevice}));
+   CommandPoolManagerInterface::Register(commandPoolManager.get());
+
+   {
+      const uint64_t recordDataSize = MaxRecordCount * RecordSizeInBytes;
+
+      Ptr<Buffer> destBuffer;
+      {
+         BufferDescriptor bufferDescriptor;
+         bufferDescriptor.m_vulkanDevice = vulkanDevice;
+         bufferDescriptor.m_bufferSize = MaxRecordCount * RecordStrideInBytes;
+         bufferDescriptor.m_memoryProperties = MemoryPropertyFlags::DeviceLocal;
+         bufferDescriptor.m_bufferUsageFlags = Foundation::Util::SetFlags<BufferUsageFlags>(
+             BufferUsageFlags::TransferDestination, BufferUsageFlags::Storage, BufferUsageFlags::ShaderDeviceAddress);
+         destBuffer = Buffer::CreateInstance(eastl::move(bufferDescriptor));
+      }
+
+      // Staging memory of the copy regions, the batches are waited on so a single Buffer suffices
+      Ptr<Buffer> stagingBuffer;
+      {
+         BufferDescriptor bufferDescriptor;
+         bufferDescriptor.m_vulkanDevice = vulkanDevice;
+         bufferDescriptor.m_bufferSize = recordDataSize;
+         bufferDescriptor.m_memoryProperties =
+             Foundation::Util::SetFlags<MemoryPropertyFlags>(MemoryPropertyFlags::HostVisible, MemoryPropertyFlags::HostCoherent);
+         bufferDescriptor.m_bufferUsageFlags = BufferUsageFlags::TransferSource;
+         stagingBuffer = Buffer::CreateInstance(eastl::move(bufferDescriptor));
+      }
+      uint8_t* stagingData = static_cast<uint8_t*>(stagingBuffer->Map(0u));
+
+      ScatterUploader scatterUploader(ScatterUploaderDescriptor{
+          .m_vulkanDevice = vulkanDevice, .m_stagingSizeInBytesPerFrame = recordDataSize + MaxRecordCount * 16u + 16u});
+
+      Ptr<TimelineSemaphore> timelineSemaphore;
+      {
+         TimelineSemaphoreDescriptor timelineSemaphoreDesc;
+         timelineSemaphoreDesc.m_vulkanDevice = vulkanDevice;
+         timelineSemaphoreDesc.m_initailValue = 0ul;
+         timelineSemaphore = TimelineSemaphore::CreateInstance(timelineSemaphoreDesc);
+      }
+      uint64_t timelineValue = 0u;
+
+      Std::vector<uint8_t> sourceData(recordDataSize, 0xab);
+
+      printf("%-10s %-16s %s\n", "records", "mode", "ms/batch");
+      for (uint32_t recordCount = 64u; recordCount <= MaxRecordCount; recordCount *= 4u)
+      {
+         Std::vector<ScatterUploadRequest> scatterUploadRequests;
+         for (uint32_t i = 0u; i < recordCount; i++)
+         {
+            scatterUploadRequests.push_back(ScatterUploadRequest{.m_sourceData = sourceData.data() + i * RecordSizeInBytes,
+                                                                 .m_sizeInBytes = static_cast<uint32_t>(RecordSizeInBytes),
+                                                                 .m_destOffsetInBytes = i * RecordStrideInBytes});
+         }
+
+         for (const UploadMode uploadMode : {UploadMode::CopyRegions, UploadMode::Scatter})
+         {
+            const double milliseconds = Measure(vulkanDevice, scatterUploader, timelineSemaphore, timelineValue, uploadMode,
+                                                stagingBuffer, stagingData, destBuffer, scatterUploadRequests);
+            printf("%-10" PRIu32 " %-16s %.3f\n", recordCount, UploadModeToString(uploadMode), milliseconds);
+         }
+      }
+
+      stagingBuffer->Unmap();
+   }
+
+   CommandPoolManagerInterface::Unregister();
+   AsyncUploadQueueInterface::Unregister();
+}
+}; // namespace Internal
+}; // namespace
+
+int main()
+{
+   using namespace Render;
+
+   Std::unique_ptr<RenderState> renderState(new RenderState(RenderStateDescriptor{}));
+   RenderStateInterface::Register(renderState.get());
+
+   Std::unique_ptr<ResourceTracker> resourceTracker(new ResourceTracker());
+   ResourceTrackerInterface::Register(resourceTracker.get());
+
+   Std::unique_ptr<ResourceDeleter> resourceDeleter(new ResourceDeleter());
+   ResourceDeleterInterface::Register(resourceDeleter.get());
+
+   Internal::RunBenchmark();
+
+   resourceDeleter = nullptr;
+   ResourceDeleterInterface::Unregister();
+
+   resourceTracker = nullptr;
+   ResourceTrackerInterface::Unregister();
+
+   renderState = nullptr;
+   RenderStateInterface::Unregister();
+
+   return 0;
+}
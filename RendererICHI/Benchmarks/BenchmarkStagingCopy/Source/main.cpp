@@ -0,0 +1,120 @@
+#include <chrono>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <TaskScheduler.h>
+
+#include <Std/vector.h>
+
+#include <StagingCopy.h>
+
+// Measures the throughput of the staging copies of the AsyncUploadQueue for different request sizes and counts. The destination
+// is regular host memory, so write-combined memory will show different (usually larger) gains from the streaming stores.
+
+namespace
+{
+namespace Internal
+{
+// Upper bound of the bytes that are copied per measurement, keeps the working set of the large configurations in check
+static constexpr uint64_t MaxTotalSizeInBytes = 256u * 1024u * 1024u;
+// Minimum amount of bytes that are copied per measurement, small configurations are repeated
+static constexpr uint64_t MinCopiedBytes = 1024u * 1024u * 1024u;
+
+enum class CopyMode : uint32_t
+{
+   Memcpy = 0u,
+   Streaming,
+   ParallelStreaming,
+};
+
+const char* CopyModeToString(CopyMode p_copyMode)
+{
+   switch (p_copyMode)
+   {
+   case CopyMode::Memcpy:
+      return "memcpy";
+   case CopyMode::Streaming:
+      return "streaming";
+   case CopyMode::ParallelStreaming:
+      return "parallel streaming";
+   default:
+      return "invalid";
+   }
+}
+
+// Returns the throughput in GB/s
+double Measure(enki::TaskScheduler& p_taskScheduler, CopyMode p_copyMode,
+               Std::span<const Render::StagingCopy::CopyRange> p_copyRanges, uint64_t p_totalSize)
+{
+   const uint64_t iterationCount = (MinCopiedBytes + p_totalSize - 1u) / p_totalSize;
+
+   const auto startTime = std::chrono::steady_clock::now();
+   for (uint64_t i = 0u; i < iterationCount; i++)
+   {
+      switch (p_copyMode)
+      {
+      case CopyMode::Memcpy:
+         for (const Render::StagingCopy::CopyRange& copyRange : p_copyRanges)
+         {
+            memcpy(copyRange.m_dest, copyRange.m_source, copyRange.m_size);
+         }
+         break;
+      case CopyMode::Streaming:
+         Render::StagingCopy::ParallelStreamingCopy(nullptr, p_copyRanges);
+         break;
+      case CopyMode::ParallelStreaming:
+         Render::StagingCopy::ParallelStreamingCopy(&p_taskScheduler, p_copyRanges);
+         break;
+      }
+   }
+   const auto endTime = std::chrono::steady_clock::now();
+
+   const double seconds = std::chrono::duration<double>(endTime - startTime).count();
+   return static_cast<double>(p_totalSize * iterationCount) / seconds / 1e9;
+}
+}; // namespace Internal
+}; // namespace
+
+int main()
+{
+   enki::TaskScheduler taskScheduler;
+   taskScheduler.Initialize();
+
+   Std::vector<uint8_t> source(Internal::MaxTotalSizeInBytes, 0xab);
+   Std::vector<uint8_t> dest(Internal::MaxTotalSizeInBytes, 0u);
+
+   const uint64_t requestSizes[] = {4u * 1024u, 64u * 1024u, 1024u * 1024u, 16u * 1024u * 1024u};
+   const uint64_t requestCounts[] = {1u, 16u, 256u};
+
+   printf("%-12s %-8s %-20s %s\n", "size", "count", "mode", "GB/s");
+   for (const uint64_t requestSize : requestSizes)
+   {
+      for (const uint64_t requestCount : requestCounts)
+      {
+         const uint64_t totalSize = requestSize * requestCount;
+         if (totalSize > Internal::MaxTotalSizeInBytes)
+         {
+            continue;
+         }
+
+         // Requests are laid out after one another, like they are in a staging chunk
+         Std::vector<Render::StagingCopy::CopyRange> copyRanges;
+         for (uint64_t i = 0u; i < requestCount; i++)
+         {
+            copyRanges.push_back(Render::StagingCopy::CopyRange{
+                .m_dest = dest.data() + i * requestSize, .m_source = source.data() + i * requestSize, .m_size = requestSize});
+         }
+
+         for (const Internal::CopyMode copyMode :
+              {Internal::CopyMode::Memcpy, Internal::CopyMode::Streaming, Internal::CopyMode::ParallelStreaming})
+         {
+            const double throughput = Internal::Measure(taskScheduler, copyMode, copyRanges, totalSize);
+            printf("%-12" PRIu64 " %-8" PRIu64 " %-20s %.2f\n", requestSize, requestCount, Internal::CopyModeToString(copyMode),
+                   throughput);
+         }
+      }
+   }
+
+   return 0;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <AsyncReadbackQueueInterface.h>
+#include <RenderCommands.h>
+#include <RendererTypes.h>
+
+#include <mutex>
+
+#include <Std/vector.h>
+
+#include <StagingRingAllocator.h>
+
+namespace Render
+{
+
+class TimelineSemaphore;
+class VulkanDevice;
+class Buffer;
+
+struct AsyncReadbackQueueDescriptor
+{
+   Ptr<VulkanDevice> m_vulkanDevice;
+   // Queue the copies are submitted to, the copies are ordered after the work that was submitted to this queue before them
+   QueueFamilyType m_queueType = QueueFamilyType::GraphicsQueue;
+};
+
+class AsyncReadbackQueue final : public AsyncReadbackQueueInterface
+{
+   // Copy to the readback buffer that still needs to be recorded
+   struct PendingCopy
+   {
+      Ptr<Buffer> m_srcBuffer;
+      BufferCopyRegion m_copyRegion;
+   };
+
+   struct Readback
+   {
+      uint64_t m_readbackId = 0u;
+      StagingRingAllocator::Reservation m_reservation;
+      uint64_t m_sizeInBytes = 0u;
+      // 0 until the readback is submitted
+      uint64_t m_timelineValue = 0u;
+      ReadbackCallback m_callback;
+      bool m_released = false;
+   };
+
+ public:
+   static constexpr uint32_t ReadbackSizeInBytes = 16u * 1024u * 1024u;
+   static constexpr uint32_t ReadbackAlignment = 16u;
+
+ public:
+   AsyncReadbackQueue() = delete;
+   AsyncReadbackQueue(AsyncReadbackQueueDescriptor&& p_desc);
+
+ public:
+   ~AsyncReadbackQueue() final;
+
+ public:
+   ReadbackTicket QueueReadback(Ptr<BufferView> p_bufferView, uint64_t p_offsetInBytes, uint64_t p_sizeInBytes,
+                                ReadbackCallback p_callback = nullptr) final;
+
+   void Flush() final;
+   void Update() final;
+
+   bool IsReadbackComplete(const ReadbackTicket& p_readbackTicket) final;
+   void WaitForReadback(const ReadbackTicket& p_readbackTicket) final;
+
+   Std::span<const uint8_t> GetReadbackData(const ReadbackTicket& p_readbackTicket) final;
+   void ReleaseReadback(const ReadbackTicket& p_readbackTicket) final;
+
+ private:
+   // Both expect m_mutex to be locked
+   void FlushInternal();
+   void UpdateInternal();
+
+   Readback& FindReadback(uint64_t p_readbackId);
+
+ private:
+   AsyncReadbackQueueDescriptor m_descriptor;
+   Ptr<Buffer> m_readbackBuffer;
+   const uint8_t* m_readbackMappedData = nullptr;
+
+   StagingRingAllocator m_allocator;
+
+   // Signaled with an incrementing value by every submit
+   Ptr<TimelineSemaphore> m_timelineSemaphore;
+   uint64_t m_submittedValue = 0u;
+
+   // Readbacks are rare compared to uploads, a single mutex guards all the state. Callbacks are invoked while it's locked, and
+   // can't call back into the AsyncReadbackQueue
+   std::mutex m_mutex;
+
+   Std::vector<PendingCopy> m_pendingCopies;
+   // Readbacks that aren't retired yet, in reservation order
+   Std::vector<Readback> m_readbacks;
+   uint64_t m_nextReadbackId = 1u;
+};
+
+} // namespace Render
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include <EASTL/functional.h>
+
+#include <Std/span.h>
+
+#include <Util/ManagerInterface.h>
+
+#include <RenderResource.h>
+
+namespace Render
+{
+
+class BufferView;
+class TimelineSemaphore;
+
+// Future-like handle of a queued readback, the data is available once m_timelineSemaphore reaches m_value
+struct ReadbackTicket
+{
+   Ptr<TimelineSemaphore> m_timelineSemaphore;
+   uint64_t m_value = 0u;
+   // Identifies the readback within the AsyncReadbackQueue
+   uint64_t m_readbackId = 0u;
+};
+
+// Invoked by AsyncReadbackQueueInterface::Update once the data arrived. The data is only valid for the duration of the callback
+using ReadbackCallback = eastl::function<void(Std::span<const uint8_t> p_data)>;
+
+class AsyncReadbackQueueInterface : public Foundation::Util::ManagerInterface<AsyncReadbackQueueInterface>
+{
+ public:
+   AsyncReadbackQueueInterface() = default;
+   virtual ~AsyncReadbackQueueInterface() = default;
+
+   // Queues a copy of p_sizeInBytes bytes, starting at p_offsetInBytes of the BufferView, into the readback memory. The copy is
+   // submitted with the next Flush, after all the work that was submitted before it. If p_callback is provided, it's invoked
+   // by Update and the readback is released afterwards. Otherwise the readback needs to be released with ReleaseReadback. A
+   // readback can't be larger than the readback memory, blocks until the readbacks in front of it free up enough of it.
+   virtual ReadbackTicket QueueReadback(Ptr<BufferView> p_bufferView, uint64_t p_offsetInBytes, uint64_t p_sizeInBytes,
+                                        ReadbackCallback p_callback = nullptr) = 0u;
+
+   // Submits all the queued readbacks with a single submit. Should be called once per frame, after the frame is submitted
+   virtual void Flush() = 0u;
+
+   // Invokes the callbacks of the completed readbacks, and retires the released readbacks. Should be called once per frame
+   virtual void Update() = 0u;
+
+   // Checks or waits for the readback on the host. Waiting flushes the queue if the readback isn't submitted yet
+   virtual bool IsReadbackComplete(const ReadbackTicket& p_readbackTicket) = 0u;
+   virtual void WaitForReadback(const ReadbackTicket& p_readbackTicket) = 0u;
+
+   // Returns the data of a completed readback, which stays valid until the readback is released
+   virtual Std::span<const uint8_t> GetReadbackData(const ReadbackTicket& p_readbackTicket) = 0u;
+   virtual void ReleaseReadback(const ReadbackTicket& p_readbackTicket) = 0u;
+};
+
+} // namespace Render
@@ -1,89 +1,123 @@
 #pragma once
 
 #include <AsyncUploadQueueInterface.h>
+#include <RenderCommands.h>
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <mutex>
+#include <thread>
 
-#include <tlsf.h>
+#include <Std/array.h>
+#include <Std/vector.h>
 
-#include <Std/list.h>
+#include <EASTL/functional.h>
+
+#include <TaskScheduler.h>
+
+#include <StagingCopy.h>
+#include <StagingRingAllocator.h>
 
 namespace Render
 {
 
-class Fence;
+class TimelineSemaphore;
 class VulkanDevice;
 class CommandBuffer;
 
 struct AsyncUploadQueueDescriptor
 {
    Ptr<VulkanDevice> m_vulkanDevice;
+   // Workers that copy and decompress large uploads, next to the dispatch thread. The copies are bound by the memory bandwidth,
+   // a few workers saturate it without competing with the TaskScheduler of the application for the cores
+   uint32_t m_workerThreadCount = 3u;
 };
 
 class AsyncUploadQueue final : public AsyncUploadQueueInterface
 {
-   struct StagedRegion
+   // Copy from the staging buffer, or from imported source data, that still needs to be recorded
+   struct PendingCopy
    {
-      Ptr<Fence> m_stagingFence;
-      void* m_stagingAddress = nullptr;
+      Ptr<Buffer> m_srcBuffer;
+      Ptr<Buffer> m_destBuffer;
+      BufferCopyRegion m_copyRegion;
    };
 
-   // Used as a general allocator for the staging buffer
-   class SimpleTlsfAlloctor
+   // Copies of a flush between a single source and destination Buffer, in the order they were queued
+   struct PendingBufferCopies
    {
-    public:
-      SimpleTlsfAlloctor() = default;
-      ~SimpleTlsfAlloctor() = default;
-
-      void Init(void* p_poolMemory, uint64_t p_poolSize)
-      {
-         ASSERT(m_tlsf == nullptr, "SimpleTlsfAlloctor was already initialized");
-
-         m_poolAddress = p_poolMemory;
-
-         m_tlsf = tlsf_create_with_pool(p_poolMemory, p_poolSize);
-      }
-
-      void Destroy()
-      {
-         ASSERT(m_tlsf != nullptr, "SimpleTlsfAlloctor hasn't been initialized");
-
-         tlsf_destroy(m_tlsf);
-      }
-
-      void* Allocate(uint64_t p_size)
-      {
-         ASSERT(m_tlsf != nullptr, "SimpleTlsfAlloctor hasn't been initialized");
-         return tlsf_malloc(m_tlsf, p_size);
-      }
-
-      void Free(void* p_address)
-      {
-         ASSERT(m_tlsf != nullptr, "SimpleTlsfAlloctor hasn't been initialized");
+      Ptr<Buffer> m_srcBuffer;
+      Ptr<Buffer> m_destBuffer;
+      Std::vector<BufferCopyRegion> m_copyRegions;
+   };
 
-         tlsf_free(m_tlsf, p_address);
-      }
+   // Copy from the staging buffer to an Image that still needs to be recorded. The Image is transitioned before the first, and
+   // after the last copy of the request
+   struct PendingImageCopy
+   {
+      Ptr<Image> m_destImage;
+      Std::vector<BufferImageCopyRegion> m_copyRegions;
+      // Covers all the regions of the request, not only the regions of this chunk
+      VkImageSubresourceRange m_subresourceRange = {};
+      VkImageLayout m_oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+      VkImageLayout m_newLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+      bool m_transitionBefore = false;
+      bool m_transitionAfter = false;
+   };
 
-      uint32_t GetOverHeadSize() const
-      {
-         return static_cast<uint32_t>(tlsf_size());
-      }
+   // Staged chunk that isn't submitted yet. Chunks are pushed on a lock-free list, and consumed when the queue is flushed. The
+   // copies of zero-copy requests are pushed as a chunk without a reservation
+   struct PendingChunk
+   {
+      StagingRingAllocator::Reservation m_reservation;
+      bool m_staged = true;
+      Std::vector<PendingCopy> m_copies;
+      Std::vector<PendingImageCopy> m_imageCopies;
 
-      uintptr_t GetPoolAddress() const
-      {
-         ASSERT(m_tlsf != nullptr, "SimpleTlsfAlloctor hasn't been initialized");
+      PendingChunk* m_next = nullptr;
+   };
 
-         return reinterpret_cast<uintptr_t>(m_poolAddress);
-      }
+   // Block that is decompressed into the staging buffer
+   struct DecompressionJob
+   {
+      const UploadCodecInterface* m_codec = nullptr;
+      const CompressedUploadBlock* m_block = nullptr;
+      uint8_t* m_destData = nullptr;
+   };
 
-    private:
-      tlsf_t m_tlsf = nullptr;
+   // Region that is submitted, and retired once the TimelineSemaphore reaches m_timelineValue
+   struct StagedRegion
+   {
+      StagingRingAllocator::Reservation m_reservation;
+      uint64_t m_timelineValue = 0u;
+   };
 
-      void* m_poolAddress = nullptr;
+   // Imported source Buffer of zero-copy requests, released once the TimelineSemaphore reaches m_timelineValue
+   struct ImportedSource
+   {
+      Ptr<Buffer> m_buffer;
+      uint64_t m_timelineValue = 0u;
    };
 
  public:
    static constexpr uint32_t StagingSizeInBytes = 64u * 1024u * 1024u;
+   static constexpr uint32_t StagingAlignment = 16u;
+   // Uploads are split in chunks of this size, allowing multiple chunks to be in flight while the next one is being staged
+   static constexpr uint32_t StagingChunkSizeInBytes = StagingSizeInBytes / 4u;
+   static_assert(CompressedUploadBlock::MaxDecompressedSizeInBytes == StagingChunkSizeInBytes,
+                 "Compressed blocks are limited to a single chunk");
+   // Pending uploads are flushed before the end of the frame once they exceed this size
+   static constexpr uint64_t FlushThresholdInBytes = StagingChunkSizeInBytes;
+   static constexpr uint64_t InfiniteTimeout = static_cast<uint64_t>(-1);
+   static constexpr uint64_t UnlimitedBudget = static_cast<uint64_t>(-1);
+   // Background streaming can use half of the staging memory per frame by default, the rest is left for the other classes
+   static constexpr uint64_t DefaultBackgroundBudgetInBytes = StagingSizeInBytes / 2u;
+   // Source data of zero-copy requests is widened to the import alignment. Up to the smallest page size of the supported
+   // platforms, the widened range only spans pages of the source data itself
+   static constexpr uint64_t MaxZeroCopyImportAlignment = 4u * 1024u;
+   // Every flush signals a TimelineSemaphore value per UploadPriority
+   static constexpr uint32_t PriorityCount = static_cast<uint32_t>(UploadPriority::Count);
 
  public:
    AsyncUploadQueue() = delete;
@@ -94,17 +128,143 @@ class AsyncUploadQueue final : public AsyncUploadQueueInterface
 
  public:
    // Queues an buffer resource copy request
-   Ptr<Fence> QueueUpload(Std::span<BufferUploadRequest> p_bufferUploadRequests) final;
+   UploadTicket QueueUpload(Std::span<BufferUploadRequest> p_bufferUploadRequests,
+                            UploadPriority p_priority = UploadPriority::Frame) final;
+
+   UploadResult TryQueueUpload(Std::span<BufferUploadRequest> p_bufferUploadRequests, uint64_t p_timeoutInNanoSeconds,
+                               UploadTicket& p_uploadTicket, UploadPriority p_priority = UploadPriority::Frame) final;
+
+   UploadTicket QueueUpload(Std::span<ImageUploadRequest> p_imageUploadRequests,
+                            UploadPriority p_priority = UploadPriority::Frame) final;
+
+   UploadResult TryQueueUpload(Std::span<ImageUploadRequest> p_imageUploadRequests, uint64_t p_timeoutInNanoSeconds,
+                               UploadTicket& p_uploadTicket, UploadPriority p_priority = UploadPriority::Frame) final;
+
+   UploadTicket QueueUpload(Std::span<CompressedBufferUploadRequest> p_compressedUploadRequests,
+                            UploadPriority p_priority = UploadPriority::Frame) final;
+
+   UploadResult TryQueueUpload(Std::span<CompressedBufferUploadRequest> p_compressedUploadRequests,
+                               uint64_t p_timeoutInNanoSeconds, UploadTicket& p_uploadTicket,
+                               UploadPriority p_priority = UploadPriority::Frame) final;
+
+   void SetFrameBudget(UploadPriority p_priority, uint64_t p_budgetInBytes) final;
+
+   void Flush() final;
+   void SubmitPendingUploads() final;
+
+   bool IsUploadComplete(const UploadTicket& p_uploadTicket) final;
+   void WaitForUpload(const UploadTicket& p_uploadTicket) final;
+   void FlushUpload(const UploadTicket& p_uploadTicket) final;
+
+   TimelineSemaphoreSubmitInfo GetUploadWaitInfo(const UploadTicket& p_uploadTicket, VkPipelineStageFlags2 p_waitStageMask) final;
 
  private:
+   // Takes the frame budget of the chunk, and reserves its region in the staging buffer. Waits for the next frame, and for in
+   // flight regions to retire, until p_timeoutInNanoSeconds expires
+   bool ReserveChunk(UploadPriority p_priority, uint64_t p_size, uint64_t p_timeoutInNanoSeconds,
+                     StagingRingAllocator::Reservation& p_reservation);
+
+   // Takes p_size bytes of the frame budget of p_priority, waits for the next frame until p_timeoutInNanoSeconds expires
+   bool AcquireFrameBudget(UploadPriority p_priority, uint64_t p_size, uint64_t p_timeoutInNanoSeconds);
+   void ReleaseFrameBudget(UploadPriority p_priority, uint64_t p_size);
+
+   // Reserves a region in the staging buffer, waits for in flight regions to retire until p_timeoutInNanoSeconds expires
+   bool ReserveStagingRegion(uint64_t p_size, uint64_t p_timeoutInNanoSeconds, StagingRingAllocator::Reservation& p_reservation);
+
+   // Reports the chunk as a staging allocation, and pushes it on the pending list of p_priority. Returns the UploadTicket of the
+   // chunk
+   UploadTicket PushPendingChunk(PendingChunk* p_pendingChunk, uint64_t p_chunkSize, UploadPriority p_priority);
+
+   // Submits the pending chunks of all the priorities, with a submit per priority in priority order. When p_forceSubmit is set,
+   // the TimelineSemaphore is signaled even when there is nothing pending
+   void FlushInternal(bool p_forceSubmit);
+
+   // Returns the Queue that records the copies of the chunks. Uploads are recorded on the transfer Queue, unless a destination is
+   // owned by the consumer QueueFamily already, or the transfer Queue can't release to the consumer QueueFamily
+   QueueFamilyType GetUploadQueueType(const PendingChunk* p_orderedChunks) const;
+
+   // Records the copies of the chunks of a single priority on p_queueType in the order they were queued, and deletes the chunks.
+   // The staged regions, imported sources and ownership releases complete at p_timelineValue. p_afterEarlierPriority orders the
+   // copies after the copies of the priorities that were submitted earlier in the same flush
+   Ptr<CommandBuffer> RecordChunks(PendingChunk* p_orderedChunks, QueueFamilyType p_queueType, uint64_t p_timelineValue,
+                                   bool p_afterEarlierPriority);
+
+   // Copies the ranges into the staging buffer, or mapped Buffers, split over the workers of the TaskScheduler
+   void CopyToStaging(Std::span<const StagingCopy::CopyRange> p_copyRanges);
+
+   // Runs p_work on m_dispatchThread, and waits until it's done
+   void RunOnDispatchThread(const eastl::function<void()>& p_work);
+
+   // Initializes the TaskScheduler, and runs the dispatched work until the AsyncUploadQueue is destroyed
+   void DispatchThreadMain();
+
+   // Writes the requests with a host-visible destination straight into the mapping of the destination
+   void WriteHostVisible(Std::span<BufferUploadRequest> p_bufferUploadRequests);
+
+   // Imports the pages of the source data of a zero-copy request as a Buffer, and fills in the copy from it. Returns false if the
+   // source data can't be imported
+   bool ImportSourceData(const BufferUploadRequest& p_uploadRequest, PendingCopy& p_pendingCopy);
+
+   // Decompresses the blocks into the staging buffer, split over the workers of the TaskScheduler
+   void DecompressToStaging(Std::span<const DecompressionJob> p_decompressionJobs);
+
+   // Flushes until p_value is submitted to the transfer queue
+   void EnsureSubmitted(uint64_t p_value);
+
+   // Retires the staged regions that have completed on the GPU, in reservation order. Queries the TimelineSemaphore once, it's
+   // called once per frame by Flush, and when the staging buffer is exhausted
    void FreeRegions();
 
  private:
    AsyncUploadQueueDescriptor m_descriptor;
    Ptr<Buffer> m_stagingBuffer;
+   uint8_t* m_stagingMappedData = nullptr;
+   // Alignment of the staging offset of buffer to image copies
+   uint64_t m_optimalBufferCopyOffsetAlignment = 1u;
+
+   StagingRingAllocator m_allocator;
+
+   // Workers that copy the data into the staging buffer. The TaskScheduler identifies the thread that adds a task by a
+   // thread_local thread number, which is shared by all the TaskSchedulers. Threads of another TaskScheduler, or unregistered
+   // threads, would alias the thread numbers of the workers. Tasks are only added by m_dispatchThread, which initializes the
+   // TaskScheduler, and runs the work of the other threads one at a time
+   enki::TaskScheduler m_taskScheduler;
+   std::thread m_dispatchThread;
+   std::mutex m_copyMutex;
+   std::mutex m_dispatchMutex;
+   std::condition_variable m_dispatchCondition;
+   // Work that is handed to m_dispatchThread, cleared once it's done. Guarded by m_dispatchMutex
+   const eastl::function<void()>* m_dispatchWork = nullptr;
+   bool m_stopDispatchThread = false;
+   // Blocks are decompressed into a scratch buffer per worker first. Matches read back the decompressed data, which is slow from
+   // write-combined staging memory. Indexed by the thread number of the TaskScheduler
+   Std::vector<Std::vector<uint8_t>> m_decompressionScratch;
+
+   // Signaled with an incrementing value by every submit
+   Ptr<TimelineSemaphore> m_timelineSemaphore;
+   // Value of the latest flush, and of the latest submit. The latest flush is incremented by PriorityCount before the pending
+   // chunks are consumed, the chunks of a priority are signaled by the flushed value + the priority + 1
+   std::atomic_uint64_t m_flushedValue = 0u;
+   std::atomic_uint64_t m_submittedValue = 0u;
+   std::mutex m_flushMutex;
+   // Queue of the latest submit, a submit on another Queue waits for it to keep the signals in order
+   QueueFamilyType m_lastSubmitQueueType = QueueFamilyType::TransferQueue;
+
+   // Chunks that are staged, but not submitted yet, per UploadPriority
+   Std::array<std::atomic<PendingChunk*>, static_cast<uint32_t>(UploadPriority::Count)> m_pendingChunks = {};
+   std::atomic_uint64_t m_pendingBytes = 0u;
+
+   // Regions that are in flight, only touched briefly to register and retire regions
+   Std::vector<StagedRegion> m_stagingRegions;
+   // Guarded by m_stagingRegionsMutex as well
+   Std::vector<ImportedSource> m_importedSources;
+   std::mutex m_stagingRegionsMutex;
 
-   Std::list<StagedRegion> m_stagingRegions;
-   SimpleTlsfAlloctor m_allocator;
+   // Bytes that each UploadPriority can stage per frame, and the bytes that are staged in the current frame
+   Std::array<uint64_t, static_cast<uint32_t>(UploadPriority::Count)> m_frameBudgets = {};
+   Std::array<uint64_t, static_cast<uint32_t>(UploadPriority::Count)> m_frameBudgetsUsed = {};
+   std::mutex m_frameBudgetMutex;
+   std::condition_variable m_frameBudgetCondition;
 };
 
 } // namespace Render
@@ -3,7 +3,10 @@
 #include <inttypes.h>
 #include <stdbool.h>
 
+#include <vulkan/vulkan.h>
+
 #include <Std/span.h>
+#include <Std/vector.h>
 
 #include <Util/ManagerInterface.h>
 
@@ -12,9 +15,11 @@
 namespace Render
 {
 
-class Fence;
 class Buffer;
-class Fence;
+class Image;
+class TimelineSemaphore;
+class UploadCodecInterface;
+struct TimelineSemaphoreSubmitInfo;
 
 struct BufferUploadRequest
 {
@@ -23,6 +28,120 @@ struct BufferUploadRequest
 
    Ptr<Buffer> m_destBuffer = nullptr;
    uint64_t m_destOffsetInBytes = static_cast<uint64_t>(-1);
+
+   // Copy from the source data directly instead of staging it, meant for large read-only data like mapped files. The pages of
+   // the source data are imported as a Buffer with VK_EXT_external_memory_host, the source data has to stay valid and unchanged
+   // until the UploadTicket completes. Requests that can't be imported are staged as usual. Zero-copy requests don't use the
+   // staging memory, and aren't limited by the frame budgets. Ranges that are written by both a zero-copy and a staged request
+   // of the same flush are written in the order they were queued
+   bool m_zeroCopy = false;
+};
+
+// Block of a compressed payload, every block is compressed independently. The decompressed blocks of a request are laid out after
+// one another
+struct CompressedUploadBlock
+{
+   // Blocks are decompressed straight into the staging memory, and are never split over chunks. A decompressed block can't be
+   // larger than a single chunk of the staging memory
+   static constexpr uint64_t MaxDecompressedSizeInBytes = 16u * 1024u * 1024u;
+
+   const void* m_compressedData = nullptr;
+   uint64_t m_compressedSizeInBytes = 0u;
+   uint64_t m_decompressedSizeInBytes = 0u;
+};
+
+struct CompressedBufferUploadRequest
+{
+   // Codec of all the blocks, needs to outlive the call to QueueUpload
+   const UploadCodecInterface* m_codec = nullptr;
+   Std::vector<CompressedUploadBlock> m_blocks;
+
+   Ptr<Buffer> m_destBuffer = nullptr;
+   uint64_t m_destOffsetInBytes = static_cast<uint64_t>(-1);
+};
+
+// Region of a single mip level that is uploaded, the source data of the region starts at m_sourceOffsetInBytes
+struct ImageUploadRegion
+{
+   uint64_t m_sourceOffsetInBytes = 0u;
+   // Row pitch of the source data, 0 means the rows are tightly packed
+   uint64_t m_sourceRowPitchInBytes = 0u;
+
+   uint32_t m_mipLevel = 0u;
+   uint32_t m_baseArrayLayer = 0u;
+   uint32_t m_layerCount = 1u;
+   VkOffset3D m_imageOffset = {};
+   VkExtent3D m_imageExtent = {};
+};
+
+struct ImageUploadRequest
+{
+   const void* m_sourceData = nullptr;
+   Ptr<Image> m_destImage = nullptr;
+   // Usually a region for every mip level of the chain
+   Std::vector<ImageUploadRegion> m_regions;
+   VkImageAspectFlags m_aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+
+   // Size and dimensions of a texel block, block compressed formats use blocks larger than a single texel
+   uint32_t m_texelBlockSizeInBytes = 0u;
+   uint32_t m_texelBlockWidth = 1u;
+   uint32_t m_texelBlockHeight = 1u;
+
+   // The Image is transitioned from m_oldLayout before the upload, and to m_newLayout after the upload
+   VkImageLayout m_oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+   VkImageLayout m_newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+};
+
+// Lightweight handle of a queued upload, the upload is complete once m_timelineSemaphore reaches m_value. Can be waited on from
+// the host through the AsyncUploadQueue, or on the GPU by adding it to the wait semaphores of a submit
+struct UploadTicket
+{
+   Ptr<TimelineSemaphore> m_timelineSemaphore;
+   uint64_t m_value = 0u;
+};
+
+// Acquire of a resource that was released by another QueueFamily, which needs to be recorded before the resource is used. The
+// layouts and the aspect mask are only used by Images, and must match the ones of the release.
+struct QueueFamilyOwnershipAcquire
+{
+   uint32_t m_srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+   uint32_t m_dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+   VkImageLayout m_oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+   VkImageLayout m_newLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+   // Subresources that were released, the acquire has to match the release
+   VkImageSubresourceRange m_subresourceRange = {};
+   // Completes once the submit that recorded the release is done, the acquire has to wait for it
+   UploadTicket m_releaseUploadTicket;
+};
+
+// Returns the ticket that completes last. All UploadTickets are signaled by the same TimelineSemaphore, invalid tickets (value 0)
+// are ignored
+inline UploadTicket MergeUploadTickets(const UploadTicket& p_lhs, const UploadTicket& p_rhs)
+{
+   return p_lhs.m_value >= p_rhs.m_value ? p_lhs : p_rhs;
+}
+
+// Priority class of an upload. Every class has its own pending queue, and the classes are submitted in this order within a flush.
+// An upload only waits for the classes that are submitted before it
+enum class UploadPriority : uint32_t
+{
+   // Submitted as soon as it's queued, for data that the next submit can't do without
+   Immediate = 0u,
+   // Submitted with the next Flush
+   Frame,
+   // Streaming traffic, limited by the frame budget of the class
+   Background,
+
+   Count
+};
+
+enum class UploadResult : uint32_t
+{
+   // All the requests are queued
+   Queued = 0u,
+   // The staging memory, or the frame budget of the UploadPriority, was exhausted before the timeout expired, none of the
+   // requests are queued
+   RetryLater,
 };
 
 class AsyncUploadQueueInterface : public Foundation::Util::ManagerInterface<AsyncUploadQueueInterface>
@@ -31,8 +150,59 @@ class AsyncUploadQueueInterface : public Foundation::Util::ManagerInterface<Asyn
    AsyncUploadQueueInterface() = default;
    virtual ~AsyncUploadQueueInterface() = default;
 
-   // Queues a buffer resource copy request
-   virtual Ptr<Fence> QueueUpload(Std::span<BufferUploadRequest> p_bufferUploadRequests) = 0u;
+   // Queues a buffer resource copy request, blocks until there is enough staging memory available. Requests larger than the
+   // staging memory are streamed in chunks. Uploads are coalesced, and submitted when the queue is flushed. Returns the
+   // UploadTicket of the upload. Requests with a HostVisible destination are written straight into the mapped destination
+   // before returning, the caller has to make sure the device doesn't use the range at that time.
+   virtual UploadTicket QueueUpload(Std::span<BufferUploadRequest> p_bufferUploadRequests,
+                                    UploadPriority p_priority = UploadPriority::Frame) = 0u;
+
+   // Same as QueueUpload, but only waits p_timeoutInNanoSeconds for staging memory to become available. A timeout of 0 doesn't
+   // block at all. Once the first chunk is queued, the remaining chunks always block until they're queued.
+   virtual UploadResult TryQueueUpload(Std::span<BufferUploadRequest> p_bufferUploadRequests, uint64_t p_timeoutInNanoSeconds,
+                                       UploadTicket& p_uploadTicket, UploadPriority p_priority = UploadPriority::Frame) = 0u;
+
+   // Same as the buffer variants, but uploads the regions of each request to an Image. All the regions of a request are packed
+   // in the staging memory, and the Image is transitioned to the TransferDst layout for the duration of the upload
+   virtual UploadTicket QueueUpload(Std::span<ImageUploadRequest> p_imageUploadRequests,
+                                    UploadPriority p_priority = UploadPriority::Frame) = 0u;
+   virtual UploadResult TryQueueUpload(Std::span<ImageUploadRequest> p_imageUploadRequests, uint64_t p_timeoutInNanoSeconds,
+                                       UploadTicket& p_uploadTicket, UploadPriority p_priority = UploadPriority::Frame) = 0u;
+
+   // Same as the buffer variants, but the payloads are compressed. The blocks are decompressed in parallel into the staging
+   // memory, and the copies of a chunk are submitted once all its blocks are decompressed. Blocks are never split over chunks
+   virtual UploadTicket QueueUpload(Std::span<CompressedBufferUploadRequest> p_compressedUploadRequests,
+                                    UploadPriority p_priority = UploadPriority::Frame) = 0u;
+   virtual UploadResult TryQueueUpload(Std::span<CompressedBufferUploadRequest> p_compressedUploadRequests,
+                                       uint64_t p_timeoutInNanoSeconds, UploadTicket& p_uploadTicket,
+                                       UploadPriority p_priority = UploadPriority::Frame) = 0u;
+
+   // Limits the bytes of p_priority that are staged per frame, Flush starts a new frame. Chunks that exceed the budget wait for
+   // the next frame, blocking uploads of a budgeted class shouldn't be queued from the thread that calls Flush. A chunk larger
+   // than the budget is admitted on its own. Immediate uploads can't be budgeted.
+   virtual void SetFrameBudget(UploadPriority p_priority, uint64_t p_budgetInBytes) = 0u;
+
+   // Submits all the queued uploads to the transfer queue with a submit per class, and starts a new frame for the frame budgets.
+   // Should be called once per frame
+   virtual void Flush() = 0u;
+
+   // Submits all the queued uploads like Flush, without starting a new frame for the frame budgets. Can be called from any
+   // thread, e.g. to free staging memory while waiting for it
+   virtual void SubmitPendingUploads() = 0u;
+
+   // Checks or waits for the UploadTicket returned by QueueUpload on the host. Waiting flushes the queue if the upload isn't
+   // submitted yet
+   virtual bool IsUploadComplete(const UploadTicket& p_uploadTicket) = 0u;
+   virtual void WaitForUpload(const UploadTicket& p_uploadTicket) = 0u;
+
+   // Flushes the queue if the upload isn't submitted yet. CommandBuffers flush their UploadTicket when they're compiled, so the
+   // submit path never flushes
+   virtual void FlushUpload(const UploadTicket& p_uploadTicket) = 0u;
+
+   // Returns the wait info to chain the upload as a GPU wait in VulkanDevice::QueueSubmit, which avoids stalling the host. Waits
+   // can't be submitted before their signal, the upload must be flushed with FlushUpload first
+   virtual TimelineSemaphoreSubmitInfo GetUploadWaitInfo(const UploadTicket& p_uploadTicket,
+                                                         VkPipelineStageFlags2 p_waitStageMask) = 0u;
 };
 
 } // namespace Render
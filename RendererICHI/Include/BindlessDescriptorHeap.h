@@ -0,0 +1,97 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <mutex>
+
+#include <Std/vector.h>
+
+#include <Memory/AllocatorClass.h>
+
+#include <BindlessDescriptorHeapInterface.h>
+#include <RenderResource.h>
+
+namespace Render
+{
+
+class VulkanDevice;
+
+struct BindlessDescriptorHeapDescriptor
+{
+   Ptr<VulkanDevice> m_vulkanDevice;
+   // Sizes of the arrays, bounded by the update-after-bind descriptor limits of the device
+   uint32_t m_storageBufferCount = 16u * 1024u;
+   uint32_t m_sampledImageCount = 16u * 1024u;
+};
+
+// The DescriptorSetLayout allows updates after bind, and partially bound arrays. Registered descriptors are written while the
+// DescriptorSet might be bound, indices that are unregistered aren't written again until the frames that read them are complete.
+class BindlessDescriptorHeap final : public BindlessDescriptorHeapInterface
+{
+   // Hands out the indices of an array. Freed indices are retired for RendererDefines::MaxQueuedFrames frames before they're reused
+   class IndexAllocator
+   {
+      struct RetiredIndex
+      {
+         uint32_t m_index = 0u;
+         uint64_t m_frameIndex = 0u;
+      };
+
+    public:
+      IndexAllocator() = delete;
+      IndexAllocator(uint32_t p_capacity);
+
+      uint32_t Allocate();
+      void Free(uint32_t p_index, uint64_t p_frameIndex);
+
+      // Whether the index is allocated, and not freed yet. Freed indices are not allocated anymore while they're retired
+      bool IsAllocated(uint32_t p_index) const;
+
+      // Moves the retired indices that aren't read by the frames in flight anymore to the free list, and returns them
+      void Recycle(uint64_t p_frameIndex, Std::vector<uint32_t>& p_recycledIndices);
+
+    private:
+      uint32_t m_capacity = 0u;
+      // Indices below it were allocated at least once
+      uint32_t m_highWaterMark = 0u;
+      Std::vector<uint32_t> m_freeIndices;
+      Std::vector<RetiredIndex> m_retiredIndices;
+      Std::vector<bool> m_allocated;
+   };
+
+ public:
+   // Only need one instance
+   CLASS_ALLOCATOR_PAGECOUNT_PAGESIZE(BindlessDescriptorHeap, 1u);
+
+   BindlessDescriptorHeap() = delete;
+   BindlessDescriptorHeap(BindlessDescriptorHeapDescriptor&& p_desc);
+   ~BindlessDescriptorHeap();
+
+ public:
+   uint32_t RegisterBufferView(Ptr<BufferView> p_bufferView) final;
+   uint32_t RegisterImageView(Ptr<ImageView> p_imageView) final;
+   void UnregisterBufferView(uint32_t p_index) final;
+   void UnregisterImageView(uint32_t p_index) final;
+
+   Ptr<DescriptorSet> GetDescriptorSet() const final;
+   Ptr<DescriptorSetLayout> GetDescriptorSetLayout() const final;
+
+   void Update() final;
+
+ private:
+   BindlessDescriptorHeapDescriptor m_descriptor;
+
+   Ptr<DescriptorSetLayout> m_descriptorSetLayout;
+   Ptr<DescriptorSet> m_descriptorSet;
+
+   // Registered resources by index, kept alive until the index is recycled
+   Std::vector<Ptr<BufferView>> m_bufferViews;
+   Std::vector<Ptr<ImageView>> m_imageViews;
+   IndexAllocator m_bufferViewIndices;
+   IndexAllocator m_imageViewIndices;
+
+   // Guards the allocators, and the writes to the DescriptorSet
+   std::mutex m_mutex;
+};
+
+} // namespace Render
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include <Util/ManagerInterface.h>
+
+#include <RenderResource.h>
+
+namespace Render
+{
+
+class BufferView;
+class DescriptorSet;
+class DescriptorSetLayout;
+class ImageView;
+
+// Global DescriptorSet with large arrays of storage buffers and sampled images. Resources are registered once, and are
+// addressed in the shaders by their index in the array. The DescriptorSet is bound once per frame, draws select their resources
+// by an index that is passed with the instance index (firstInstance), or with push constants.
+class BindlessDescriptorHeapInterface : public Foundation::Util::ManagerInterface<BindlessDescriptorHeapInterface>
+{
+ public:
+   static constexpr uint32_t StorageBufferBinding = 0u;
+   static constexpr uint32_t SampledImageBinding = 1u;
+
+   BindlessDescriptorHeapInterface() = default;
+   virtual ~BindlessDescriptorHeapInterface() = default;
+
+   // Writes the BufferView to the storage buffer array, and returns its index. The index is stable until it's unregistered, and
+   // the BufferView is kept alive until then
+   virtual uint32_t RegisterBufferView(Ptr<BufferView> p_bufferView) = 0u;
+
+   // Writes the ImageView to the sampled image array, and returns its index. The Image is expected to be in the
+   // SHADER_READ_ONLY_OPTIMAL layout when it's sampled
+   virtual uint32_t RegisterImageView(Ptr<ImageView> p_imageView) = 0u;
+
+   // Releases the index, it's reused once the frames in flight that might still read it are complete
+   virtual void UnregisterBufferView(uint32_t p_index) = 0u;
+   virtual void UnregisterImageView(uint32_t p_index) = 0u;
+
+   // Returns the DescriptorSet to bind, and its DescriptorSetLayout to create the GraphicsPipelines and ComputePipelines with
+   virtual Ptr<DescriptorSet> GetDescriptorSet() const = 0u;
+   virtual Ptr<DescriptorSetLayout> GetDescriptorSetLayout() const = 0u;
+
+   // Recycles the indices that were unregistered RendererDefines::MaxQueuedFrames ago. Should be called once per frame
+   virtual void Update() = 0u;
+};
+
+} // namespace Render
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <mutex>
 #include <inttypes.h>
 #include <stdbool.h>
 
@@ -8,6 +10,7 @@
 #include <Memory/AllocatorClass.h>
 #include <RenderResource.h>
 #include <RendererTypes.h>
+#include <AsyncUploadQueueInterface.h>
 
 namespace Render
 {
@@ -17,17 +20,26 @@ struct BufferDescriptor
 {
    Ptr<VulkanDevice> m_vulkanDevice;
    uint64_t m_bufferSize = 0u;
-   BufferUsageFlags m_bufferUsageFlags;
-   QueueFamilyTypeFlags m_queueFamilyAccess;
-   MemoryPropertyFlags m_memoryProperties;
+   BufferUsageFlags m_bufferUsageFlags = {};
+   QueueFamilyTypeFlags m_queueFamilyAccess = {};
+   MemoryPropertyFlags m_memoryProperties = {};
 
    const void* m_initialData = nullptr;
    uint64_t m_initialDataSize = 0ul;
+   // Don't block on the upload of the initial data. CommandBuffers that read from the Buffer wait for the upload on the GPU
+   bool m_asyncInitialData = false;
+
+   // Host memory of m_bufferSize bytes that backs the Buffer, instead of allocated device memory. The data is only read by the
+   // device, and has to outlive the Buffer. If the device can't import it (VK_EXT_external_memory_host isn't enabled, the
+   // range isn't aligned to VulkanDevice::GetMinImportedHostPointerAlignment, or the import fails), the Buffer allocates memory
+   // with m_memoryProperties, and the data is uploaded as initial data instead
+   const void* m_importedHostData = nullptr;
 };
 
 class Buffer final : public RenderResource<Buffer>
 {
    friend RenderResource<Buffer>;
+   friend class ImmutableBufferCache;
 
  public:
    CLASS_ALLOCATOR_PAGECOUNT_PAGESIZE(Buffer, 12u);
@@ -55,10 +67,52 @@ class Buffer final : public RenderResource<Buffer>
    // Get the buffer size that was allocated on the device
    const uint64_t GetBufferSizeAllocated() const;
 
-   // Map/Unmap the buffer
+   // Returns whether the initial data is uploaded, always true if the Buffer wasn't created with asynchronous initial data
+   bool IsReady();
+
+   // Returns the UploadTicket of the initial data and of the copies to the Buffer, the value is 0 if nothing was uploaded. The
+   // ticket can be merged by another thread, it's returned by value
+   UploadTicket GetUploadTicket() const;
+
+   // The Buffer is the destination of a copy from a Buffer that can still be uploading, readers wait for that upload as well
+   void MergeUploadTicket(const UploadTicket& p_uploadTicket);
+
+   // The Buffer was released by another QueueFamily, the next CommandBuffer of the destination QueueFamily that uses the Buffer
+   // records the acquire
+   void SetPendingOwnershipAcquire(const QueueFamilyOwnershipAcquire& p_acquire);
+
+   // Returns true and takes the pending acquire if there is one for p_queueFamilyIndex, only the first caller gets it
+   bool ConsumePendingOwnershipAcquire(uint32_t p_queueFamilyIndex, QueueFamilyOwnershipAcquire& p_acquire);
+
+   // The Buffer was released to, or used by the consumer QueueFamily. The transfer QueueFamily doesn't own it anymore, uploads to
+   // the Buffer are recorded on the consumer QueueFamily
+   void MarkOwnedByConsumer();
+   bool IsOwnedByConsumer() const;
+
+   // Returns the device address of the Buffer, the Buffer must be created with the ShaderDeviceAddress usage. Accesses through
+   // the address aren't seen by the ResourceTracker, add the Buffer with CommandBufferBase::AddReferencedResource
+   VkDeviceAddress GetDeviceAddress() const;
+
+   // Whether the memory of the Buffer can be written by the host, uploads to these Buffers skip the staging memory
+   bool IsHostVisible() const;
+
+   // Whether the Buffer is backed by imported host memory
+   bool IsImportedHostMemory() const;
+
+   // Map/Unmap the buffer. The memory is mapped persistently on the first Map, and stays mapped until the Buffer is destroyed
    void* Map(uint64_t p_offset, uint64_t p_size = WholeSize);
    void Unmap();
 
+   // Makes host writes to the mapped range visible to the device, only does work if the memory isn't HostCoherent
+   void FlushMappedRange(uint64_t p_offset, uint64_t p_size);
+
+   // Returns whether the Buffer is shared by the ImmutableBufferCache, its contents can't be written after the initial data
+   bool IsShared() const;
+
+ private:
+   // Set by the ImmutableBufferCache once the Buffer is cached
+   void MarkShared();
+
  private:
    //
    Ptr<VulkanDevice> m_vulkanDevice;
@@ -72,7 +126,23 @@ class Buffer final : public RenderResource<Buffer>
 
    VkBuffer m_bufferNative = VK_NULL_HANDLE;
    VkDeviceMemory m_deviceMemory = VK_NULL_HANDLE;
+   VkDeviceAddress m_deviceAddress = 0u;
+   bool m_importedHostMemory = false;
 
+   std::mutex m_mapMutex;
    void* m_mappedData = nullptr;
+   uint32_t m_mapCount = 0u;
+
+   // Upload of the initial data, merged with the uploads of the Buffers that are copied to it
+   mutable std::mutex m_uploadTicketMutex;
+   UploadTicket m_uploadTicket;
+   std::atomic_bool m_isReady = true;
+
+   std::mutex m_ownershipMutex;
+   QueueFamilyOwnershipAcquire m_pendingOwnershipAcquire;
+   bool m_hasPendingOwnershipAcquire = false;
+   std::atomic_bool m_ownedByConsumer = false;
+
+   bool m_isShared = false;
 };
 } // namespace Render
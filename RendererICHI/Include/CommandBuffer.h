@@ -14,6 +14,7 @@
 #include <RenderResource.h>
 #include <RendererTypes.h>
 #include <RenderCommands.h>
+#include <AsyncUploadQueueInterface.h>
 
 namespace Render
 {
@@ -47,6 +48,23 @@ class CommandBufferBase : public RenderResource<CommandBufferBase>
 {
    friend class CommandPoolManager;
    friend class CommandPool;
+   friend class CommandBuffer;
+   friend class ScatterUploader;
+   friend class DynamicBuffer;
+   friend class AsyncUploadQueue;
+
+   // Resources that were released by another QueueFamily, the acquires are recorded at the start of the CommandBuffer
+   struct BufferOwnershipAcquire
+   {
+      Ptr<Buffer> m_buffer;
+      QueueFamilyOwnershipAcquire m_acquire;
+   };
+
+   struct ImageOwnershipAcquire
+   {
+      Ptr<Image> m_image;
+      QueueFamilyOwnershipAcquire m_acquire;
+   };
 
  protected:
    CommandBufferBase() = delete;
@@ -81,6 +99,9 @@ class CommandBufferBase : public RenderResource<CommandBufferBase>
    void BindDescriptorSets(PipelineBindPoint p_pipelineBindPoint, Ptr<GraphicsPipeline> p_graphicsPipeline, uint32_t p_firstSet,
                            Std::span<Ptr<DescriptorSet>> p_descriptorSets);
    void BindPipeline(PipelineBindPoint p_pipelineBindPoint, Ptr<GraphicsPipeline> p_graphicsPipeline);
+   void BindPipeline(Ptr<ComputePipeline> p_computePipeline);
+   void PushConstants(Ptr<ComputePipeline> p_computePipeline, uint32_t p_offset, const void* p_data, uint32_t p_dataSize);
+   void Dispatch(uint32_t p_groupCountX, uint32_t p_groupCountY, uint32_t p_groupCountZ);
    void SetDepthBounds(float p_minDepthBounds, float p_maxDepthBounds);
    void BindIndexBuffer(Ptr<BufferView> p_indexBuffer, IndexType p_indexType);
    void ExecuteCommands(Std::span<SubCommandBuffer*> p_subCommandBuffers);
@@ -89,6 +110,20 @@ class CommandBufferBase : public RenderResource<CommandBufferBase>
    void DrawIndexed(uint32_t p_indexCount, uint32_t p_instanceCount, uint32_t p_firstIndex, uint32_t p_vertexOffset,
                     uint32_t p_firstInstance);
    void CopyBuffer(Ptr<Buffer> p_srcBuffer, Ptr<Buffer> p_destBuffer, Std::span<BufferCopyRegion> p_copyRegions);
+   // Writes p_dataSize bytes to the Buffer from the command buffer itself, without staging memory. The payload is limited to
+   // UpdateBufferCommand::MaxDataSizeInBytes, the offset and size must be a multiple of 4. Barriers are recorded before and
+   // after the write, the range is available to all the commands that follow. Can't be recorded while rendering
+   void UpdateBuffer(Ptr<Buffer> p_destBuffer, uint64_t p_destOffset, const void* p_data, uint64_t p_dataSize);
+   // Fills the range with the repeated 4 byte p_data, p_size can be VK_WHOLE_SIZE. Recorded with the same barriers as UpdateBuffer
+   void FillBuffer(Ptr<Buffer> p_destBuffer, uint64_t p_destOffset, uint64_t p_size, uint32_t p_data);
+   void CopyBufferToImage(Ptr<Buffer> p_srcBuffer, Ptr<Image> p_destImage, VkImageLayout p_destImageLayout,
+                          Std::span<BufferImageCopyRegion> p_copyRegions);
+   void CopyImageToBuffer(Ptr<Image> p_srcImage, VkImageLayout p_srcImageLayout, Ptr<Buffer> p_destBuffer,
+                          Std::span<BufferImageCopyRegion> p_copyRegions);
+   void CopyImage(Ptr<Image> p_srcImage, VkImageLayout p_srcImageLayout, Ptr<Image> p_destImage, VkImageLayout p_destImageLayout,
+                  Std::span<ImageCopyRegion> p_copyRegions);
+   void BlitImage(Ptr<Image> p_srcImage, VkImageLayout p_srcImageLayout, Ptr<Image> p_destImage, VkImageLayout p_destImageLayout,
+                  Std::span<ImageBlitRegion> p_blitRegions, VkFilter p_filter);
    void BeginRendering(VkRect2D p_renderArea, Std::span<RenderingAttachmentInfo> p_colorAttachments,
                        RenderingAttachmentInfo& p_depthAttachment, RenderingAttachmentInfo& p_stencilAttachment);
 
@@ -99,12 +134,33 @@ class CommandBufferBase : public RenderResource<CommandBufferBase>
 
    VkCommandBuffer GetCommandBufferNative() const;
 
+   // Returns the latest UploadTicket of the resources that are read by the recorded commands. The submit of the CommandBuffer
+   // waits for it on the GPU
+   const UploadTicket& GetUploadTicket() const;
+
+   // Marks p_owner as referenced by the CommandBuffer, the marks are reported to the ResourceTracker at once when the
+   // CommandBuffer is recorded. Resources that are only accessed through their device address must be added by the caller
+   void AddReferencedResource(const void* p_owner);
+
  private:
    void SetCommandPool(Ptr<CommandPool> p_commandPool);
    void SetCommandBufferNative(VkCommandBuffer p_commandBuffer);
 
    void Record();
 
+   // Resources that are read can still be uploading, merge their UploadTicket
+   void AddUploadDependency(const UploadTicket& p_uploadTicket);
+
+   // Takes the pending QueueFamily ownership acquire of resources that are used by the recorded commands
+   void AddOwnershipAcquire(Ptr<Buffer> p_buffer);
+   void AddOwnershipAcquire(Ptr<Image> p_image);
+
+   // Transfer commands can't be recorded while rendering, nor in SubCommandBuffers, which are executed while rendering
+   bool CanRecordTransferCommands() const;
+
+   // Records UpdateBuffer without its barriers, for callers that order multiple writes with a single barrier pair
+   void UpdateBufferWithoutBarriers(Ptr<Buffer> p_destBuffer, uint64_t p_destOffset, const void* p_data, uint64_t p_dataSize);
+
  protected:
    Ptr<VulkanDevice> m_vulkanDevice;
    VkCommandBuffer m_commandBufferNative = VK_NULL_HANDLE;
@@ -112,6 +168,20 @@ class CommandBufferBase : public RenderResource<CommandBufferBase>
    Ptr<CommandPool> m_commandPool;
 
    CommandBufferBaseDescriptor m_descriptor;
+
+   UploadTicket m_uploadTicket;
+
+   Std::vector<BufferOwnershipAcquire> m_bufferOwnershipAcquires;
+   Std::vector<ImageOwnershipAcquire> m_imageOwnershipAcquires;
+
+   // Resources that are referenced by the recorded commands, reported to the ResourceTracker at the end of Record
+   Std::vector<const void*> m_referencedResources;
+
+   // Set between BeginRendering and EndRendering
+   bool m_isRendering = false;
+   bool m_isSubCommandBuffer = false;
+   // Set by the AsyncUploadQueue, its copies write the initial data of Buffers that are shared already
+   bool m_recordsUploads = false;
 };
 
 // ----------- SubCommandBuffer -----------
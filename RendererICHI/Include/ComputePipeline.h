@@ -0,0 +1,62 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include <vulkan/vulkan.h>
+
+#include <Std/vector.h>
+
+#include <Memory/AllocatorClass.h>
+
+#include <RenderResource.h>
+#include <ShaderStage.h>
+
+using namespace Foundation;
+
+namespace Render
+{
+
+class DescriptorSetLayout;
+class VulkanDevice;
+
+struct ComputePipelineDescriptor
+{
+   Ptr<VulkanDevice> m_vulkanDevice;
+   Ptr<ShaderStage> m_shaderStage;
+   Std::vector<Ptr<DescriptorSetLayout>> m_descriptorSetLayouts;
+   // Push constants that are used by the compute shader
+   uint32_t m_pushConstantSizeInBytes = 0u;
+};
+
+class ComputePipeline final : public RenderResource<ComputePipeline>
+{
+   friend RenderResource<ComputePipeline>;
+
+ public:
+   CLASS_ALLOCATOR_PAGECOUNT_PAGESIZE(ComputePipeline, 12u);
+
+ private:
+   ComputePipeline() = delete;
+   ComputePipeline(ComputePipelineDescriptor&& p_desc);
+
+ public:
+   ~ComputePipeline() final;
+
+   const VkPipelineLayout GetComputePipelineLayoutNative() const;
+   const VkPipeline GetComputePipelineNative() const;
+
+   uint32_t GetPushConstantSizeInBytes() const;
+
+ private:
+   Ptr<VulkanDevice> m_vulkanDevice;
+
+   Ptr<ShaderStage> m_shaderStage;
+   Std::vector<Ptr<DescriptorSetLayout>> m_descriptorSetLayouts;
+   uint32_t m_pushConstantSizeInBytes = 0u;
+
+   VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+   VkPipeline m_computePipeline = VK_NULL_HANDLE;
+};
+
+}; // namespace Render
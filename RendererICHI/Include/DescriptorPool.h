@@ -1,13 +1,12 @@
 #pragma once
 
+#include <atomic>
 #include <inttypes.h>
 #include <stdbool.h>
-#include <mutex>
 
 #include <vulkan/vulkan.h>
 
 #include <Std/vector.h>
-#include <Std/unordered_set.h>
 
 #include <RendererTypes.h>
 #include <Memory/AllocatorClass.h>
@@ -26,16 +25,24 @@ struct DescriptorPoolDescriptor
 {
    ConstPtr<DescriptorSetLayout> m_descriptorSetLayout;
    Ptr<VulkanDevice> m_vulkanDevice;
+   // Amount of DescriptorSets that can be allocated from the pool
+   uint32_t m_maxDescriptorSets = 0u;
 };
 
 // DescriptorPool Resource
 // Each DescriptorPool is specifically tied to a DescriptorSetLayout. This means that each DescriptorSetLayout that is created, will
 // eventually create a DescriptorPool that matches the types.
+// A DescriptorPool has a single owner at a time, a thread cache or the DescriptorPoolManager, which is the only one that allocates
+// and frees its DescriptorSets. DescriptorSets that are destroyed on other threads are returned through a lock-free queue, and
+// are freed by the owner on its next allocation.
 class DescriptorPool final : public RenderResource<DescriptorPool>
 {
    friend DescriptorSet;
    friend class DescriptorPoolManager;
 
+ public:
+   static constexpr uint32_t InvalidIndex = static_cast<uint32_t>(-1);
+
  public:
    CLASS_ALLOCATOR_PAGECOUNT_PAGESIZE(DescriptorPool, 12u);
 
@@ -49,37 +56,61 @@ class DescriptorPool final : public RenderResource<DescriptorPool>
    const VkDescriptorPool GetDescriptorPoolNative() const;
    const VkDescriptorSetLayout GetDescriptorSetLayoutNative() const;
 
-   // Checks if the DescriptorPool still has room for a DescriptorSet
+   // Checks if the DescriptorPool still has room for a DescriptorSet, only called by the owner
    bool IsDescriptorSetSlotAvailable() const;
 
    // Return the number of DescriptorSets allocated from this pool
    uint32_t GetAllocatedDescriptorSetCount() const;
 
+   // Returns the number of DescriptorSets that can be allocated from this pool
+   uint32_t GetMaxDescriptorSetCount() const;
+
    // Returns the DescriptorSetLayout Hash
    uint64_t GetDescriptorSetLayoutHash() const;
 
    ConstPtr<DescriptorSetLayout> GetDescriptorSetLayout() const;
 
  private:
-   void RegisterDescriptorSet(DescriptorSet* p_descriptorSet);
+   // Allocates the DescriptorSet from a free slot, after freeing the DescriptorSets that were returned. Only called by the owner
+   void AllocateDescriptorSet(DescriptorSet* p_descriptorSet);
+
+   // Frees the DescriptorSets that were returned, only called by the owner
+   void FreeReturnedDescriptorSets();
 
-   // Free the DesriptorSet From the DescriptorPool. This is explicitly called only by the Destructor of the DescriptorSet
-   void UnregisterDescriptorSet(DescriptorSet* p_descriptorSet);
+   // Returns the slot of the DesriptorSet to the owner of the DescriptorPool, can be called from any thread. This is explicitly
+   // called only by the Destructor of the DescriptorSet. If the pool is detached, it's handed back to the DescriptorPoolManager
+   void ReturnDescriptorSet(uint32_t p_slot);
+
+   // Gives up the ownership of a full pool, the first DescriptorSet that is returned hands it back to the DescriptorPoolManager.
+   // Returns false if a DescriptorSet was returned in the meantime, in which case the caller keeps the ownership
+   bool Detach();
 
  private:
    // Vulkan Resources
    Std::vector<VkDescriptorPoolSize> m_descriptorPoolSizes;
    VkDescriptorPool m_descriptorPoolNative = VK_NULL_HANDLE;
 
-   // References of the DesriptorSets allocated from this pool
-   Std::unordered_set<DescriptorSet*> m_descriptorSets;
+   // The DesriptorSets allocated from this pool, indexed by the slot of the DescriptorSet. Free slots are VK_NULL_HANDLE, and
+   // their indices are kept on a stack
+   Std::vector<VkDescriptorSet> m_descriptorSetsNative;
+   Std::vector<uint32_t> m_freeSlots;
+   uint32_t m_allocatedDescriptorSetCount = 0u;
+
+   // Lock-free stack of the returned slots, linked through m_returnedSlotLinks. Pushed by any thread, and taken as a whole by the
+   // owner
+   Std::vector<uint32_t> m_returnedSlotLinks;
+   std::atomic_uint32_t m_returnedSlotHead = InvalidIndex;
+   // Set while the pool is full and has no owner
+   std::atomic_bool m_detached = false;
+
+   // Index in the DescriptorPoolManager's list of pools that have free slots, InvalidIndex if the pool isn't in it. Only
+   // touched by the DescriptorPoolManager
+   uint32_t m_availableIndex = InvalidIndex;
 
    // Reference of the DescriptorSetLayout that is used for this pool
    ConstPtr<DescriptorSetLayout> m_descriptorSetLayout;
    // Reference To the VulkanDevice
    Ptr<VulkanDevice> m_vulkanDevice;
-
-   mutable std::mutex m_mutex;
 };
 
 } // namespace Render
@@ -4,10 +4,9 @@
 #include <stdbool.h>
 #include <mutex>
 
-#include <Std/list.h>
+#include <Std/unique_ptr.h>
 #include <Std/unordered_map.h>
 #include <Std/vector.h>
-#include <Std/unordered_set.h>
 
 #include <Memory/AllocatorClass.h>
 
@@ -16,6 +15,11 @@
 
 using namespace Foundation;
 
+namespace enki
+{
+class TaskScheduler;
+};
+
 namespace Render
 {
 
@@ -27,14 +31,33 @@ class DescriptorSetLayout;
 struct DescriptorPoolManagerDescriptor
 {
    Ptr<VulkanDevice> m_vulkanDevice;
+   // Task threads allocate from their own DescriptorPools without locking. Threads without a thread number of the TaskScheduler,
+   // or all threads if it's nullptr, allocate from the shared DescriptorPools
+   enki::TaskScheduler* m_taskScheduler = nullptr;
 };
 
-// TODO: multi thread this at some point
-// Manages the allocation of DescriptorSets in DescriptorPools. Bookkeep a list of DescriptorPools, and tries to allocate the
-// DescriptorSet. It'll iterate through the list till it is able to allocate one. If none is available, it will create one.
+// Manages the allocation of DescriptorSets in DescriptorPools. Per DescriptorSetLayout, it bookkeeps the DescriptorPools that have
+// free slots. If none is available, it creates a pool that is twice as large as the previous one.
+// Each task thread owns a DescriptorPool per DescriptorSetLayout, and allocates from it without locking. When it's full, the
+// thread refills by taking a whole pool from the shared list. The pools are cached per thread, not per thread number: the thread
+// numbers of enki are shared by all the TaskSchedulers, the workers of different TaskSchedulers have the same numbers. Other
+// threads allocate from the last pool of the shared list under a lock. Pools that are full are only referenced by their
+// DescriptorSets, the first DescriptorSet that is destroyed afterwards queues the pool, and it's added back to the shared list.
 class DescriptorPoolManager final : public DescriptorPoolManagerInterface
 {
-   using DescriptorPoolList = Std::list<Ptr<DescriptorPool>>;
+   struct DescriptorPoolList
+   {
+      // Pools with free slots that aren't owned by a thread, each pool stores its index in the list
+      Std::vector<Ptr<DescriptorPool>> m_availablePools;
+      // Amount of DescriptorSets of the next pool that is created
+      uint32_t m_nextMaxDescriptorSets = MinDescriptorSetsPerPool;
+   };
+
+   // Only touched by its thread
+   struct ThreadCache
+   {
+      Std::unordered_map<uint64_t, Ptr<DescriptorPool>> m_descriptorPools;
+   };
 
  public:
    // Only need one instance
@@ -46,17 +69,33 @@ class DescriptorPoolManager final : public DescriptorPoolManagerInterface
 
  public:
    void AllocateDescriptorSet(DescriptorSet* p_descriptorSet) final;
-   void QueueEmptyDescriptorPool(DescriptorPool* m_descriptorPool) final;
+   void QueueAvailableDescriptorPool(DescriptorPool* p_descriptorPool) final;
 
  private:
+   // Takes an available pool out of the shared list, or creates one. The caller becomes its owner, and holds the lock
+   Ptr<DescriptorPool> AcquireDescriptorPool(ConstPtr<DescriptorSetLayout> p_descriptorSetLayout);
+
+   // Returns the ThreadCache of the calling thread, it's created on the first allocation of the thread
+   ThreadCache* GetThreadCache();
+
+   // Adds the queued pools back to their list, and frees the pools that are empty
    void FreeDescriptorPool();
 
+   static void AddAvailablePool(DescriptorPoolList& p_descriptorPoolList, Ptr<DescriptorPool> p_descriptorPool);
+   static void RemoveAvailablePool(DescriptorPoolList& p_descriptorPoolList, DescriptorPool* p_descriptorPool);
+
  private:
    Std::unordered_map<uint64_t, DescriptorPoolList> m_descriptorPoolLists;
-   Std::vector<const DescriptorPool*> m_releaseQueue;
+   Std::vector<Ptr<DescriptorPool>> m_releaseQueue;
    std::mutex m_descriptorPoolManagerMutex;
    std::mutex m_emptyPoolMutex;
    Ptr<VulkanDevice> m_vulkanDevice;
+
+   enki::TaskScheduler* m_taskScheduler = nullptr;
+   // Caches of all the threads that allocated, guarded by m_descriptorPoolManagerMutex. The threads reference their cache by a
+   // thread_local pointer, which is tagged with m_instanceId in case a later instance is created at the same address
+   Std::vector<Std::unique_ptr<ThreadCache>> m_threadCaches;
+   uint64_t m_instanceId = 0u;
 };
 
 }; // namespace Render
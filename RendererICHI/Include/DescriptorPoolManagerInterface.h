@@ -17,11 +17,18 @@ class DescriptorPoolManagerInterface : public Foundation::Util::ManagerInterface
    friend DescriptorPool;
 
  public:
-   // Each DescriptorPool has enough types available to allocate 12 instances of that particular DescriptorSet
-   static constexpr uint32_t DescriptorSetInstanceCount = 12u;
+   // The first DescriptorPool of a DescriptorSetLayout has enough types available to allocate 12 instances of that particular
+   // DescriptorSet, every next DescriptorPool doubles the amount of instances, up to the maximum
+   static constexpr uint32_t MinDescriptorSetsPerPool = 12u;
+   static constexpr uint32_t MaxDescriptorSetsPerPool = 1536u;
+   // Pools of DescriptorSetLayouts with many descriptors allocate fewer DescriptorSets, but always at least one
+   static constexpr uint32_t MaxDescriptorsPerPool = 64u * 1024u;
 
    virtual void AllocateDescriptorSet(DescriptorSet* p_descriptorSet) = 0;
-   virtual void QueueEmptyDescriptorPool(DescriptorPool* m_descriptorPool) = 0;
+
+   // Called by a full DescriptorPool without owner when one of its DescriptorSets is returned, the DescriptorPoolManager takes
+   // the ownership and makes the pool available to the next allocations
+   virtual void QueueAvailableDescriptorPool(DescriptorPool* p_descriptorPool) = 0;
 };
 
 }; // namespace Render
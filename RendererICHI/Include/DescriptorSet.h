@@ -7,11 +7,13 @@
 
 #include <Std/unique_ptr.h>
 #include <Std/span.h>
+#include <Std/vector.h>
 
 #include <Std/unordered_map.h>
 
 #include <Memory/AllocatorClass.h>
 #include <RenderResource.h>
+#include <AsyncUploadQueueInterface.h>
 
 using namespace Foundation;
 
@@ -20,6 +22,7 @@ namespace Render
 
 class VulkanDevice;
 class DescriptorPool;
+class Buffer;
 class BufferView;
 class ImageView;
 class DescriptorSetLayout;
@@ -34,6 +37,7 @@ class DescriptorSet final : public RenderResource<DescriptorSet>
 {
    friend class DescriptorPool;
    friend class DescriptorPoolManager;
+   friend class DescriptorSetCache;
    friend RenderResource<DescriptorSet>;
 
  public:
@@ -58,19 +62,49 @@ class DescriptorSet final : public RenderResource<DescriptorSet>
 
    ConstPtr<DescriptorSetLayout> GetDescirptorSetLayout() const;
 
+   // Returns the latest UploadTicket of all the Buffers that were written to the DescriptorSet
+   const UploadTicket& GetUploadTicket() const;
+
+   // Returns the Buffers that were written to the DescriptorSet while they were uploaded, they can require a QueueFamily
+   // ownership acquire
+   Std::span<const Ptr<Buffer>> GetUploadedBuffers() const;
+
+   // Returns all the Buffers that are written to the DescriptorSet, without duplicates. CommandBuffers that bind the
+   // DescriptorSet mark them as referenced
+   Std::span<const Buffer* const> GetBoundBuffers() const;
+
+   // Returns whether the DescriptorSet is shared by the DescriptorSetCache, its resources and dynamic offsets are immutable
+   bool IsShared() const;
+
  private:
-   void SetDescriptorPool(Ptr<DescriptorPool> p_descriptorPool);
+   void SetDescriptorPool(Ptr<DescriptorPool> p_descriptorPool, uint32_t p_descriptorPoolSlot,
+                          VkDescriptorSet p_descriptorSetNative);
+
+   // Set by the DescriptorSetCache once the DescriptorSet is cached
+   void MarkShared();
 
  private:
    DescriptorSetDescriptor m_desc;
 
    // Set by DescriptorPool
    Ptr<DescriptorPool> m_descriptorPool;
+   uint32_t m_descriptorPoolSlot = 0u;
 
    // Vulkan Resource
    VkDescriptorSet m_descriptorSetNative = VK_NULL_HANDLE;
 
    // Used for Dynamic Storage/Uniform Buffers
    Std::unordered_map<uint32_t, Std::vector<uint32_t>> m_dynamicOffsets;
+
+   // Buffers that are written can still be uploading, CommandBuffers that bind the DescriptorSet wait for it
+   UploadTicket m_uploadTicket;
+   Std::vector<Ptr<Buffer>> m_uploadedBuffers;
+
+   // Buffers per binding and array element, and the flattened list of them. The list is rebuilt when the DescriptorSet is
+   // updated, which happens less often than it's bound. The Buffers aren't kept alive by the DescriptorSet
+   Std::unordered_map<uint32_t, Std::vector<const Buffer*>> m_bindingBuffers;
+   Std::vector<const Buffer*> m_boundBuffers;
+
+   bool m_isShared = false;
 };
 }; // namespace Render
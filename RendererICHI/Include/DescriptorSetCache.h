@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <mutex>
+
+#include <vulkan/vulkan.h>
+
+#include <Std/unordered_map.h>
+#include <Std/vector.h>
+
+#include <Memory/AllocatorClass.h>
+
+#include <DescriptorSetCacheInterface.h>
+#include <RenderResource.h>
+
+namespace Render
+{
+
+class VulkanDevice;
+
+struct DescriptorSetCacheDescriptor
+{
+   Ptr<VulkanDevice> m_vulkanDevice;
+};
+
+// Deduplicates DescriptorSets with identical content. The DescriptorSets are keyed by the hash of their DescriptorSetLayout,
+// and the native handles, ranges and usages of the BufferViews that are written to them. A cached DescriptorSet keeps its
+// BufferViews alive, so the native handles of a key can't be reused by other resources while it's cached.
+class DescriptorSetCache final : public DescriptorSetCacheInterface
+{
+   // A single descriptor that is written to the DescriptorSet, members are sized to avoid padding, the records are hashed as is
+   struct DescriptorRecord
+   {
+      VkBuffer m_buffer = VK_NULL_HANDLE;
+      VkBufferView m_bufferView = VK_NULL_HANDLE;
+      uint64_t m_offset = 0u;
+      uint64_t m_range = 0u;
+      uint64_t m_usage = 0u;
+      uint32_t m_bindingIndex = 0u;
+      uint32_t m_arrayElement = 0u;
+
+      bool operator==(const DescriptorRecord& p_other) const;
+   };
+
+   struct CachedDescriptorSet
+   {
+      uint64_t m_descriptorSetLayoutHash = 0u;
+      Std::vector<DescriptorRecord> m_descriptorRecords;
+
+      Ptr<DescriptorSet> m_descriptorSet;
+      Std::vector<Ptr<BufferView>> m_bufferViews;
+      // Latest frame the DescriptorSet was acquired, or referenced outside of the cache
+      uint64_t m_lastUsedFrameIndex = 0u;
+   };
+
+ public:
+   // Only need one instance
+   CLASS_ALLOCATOR_PAGECOUNT_PAGESIZE(DescriptorSetCache, 1u);
+
+   DescriptorSetCache() = delete;
+   DescriptorSetCache(DescriptorSetCacheDescriptor&& p_desc);
+   ~DescriptorSetCache();
+
+ public:
+   Ptr<DescriptorSet> AcquireDescriptorSet(Ptr<DescriptorSetLayout> p_descriptorSetLayout,
+                                           Std::span<const DescriptorSetBinding> p_bindings) final;
+   void Update() final;
+
+   // Returns the amount of cached DescriptorSets, and the amount of DescriptorSets that were shared instead of allocated
+   uint64_t GetCachedCount();
+   uint64_t GetSharedCount() const;
+
+ private:
+   // Returns the cached DescriptorSet with the same content, nullptr if there is none. Expects the lock to be held
+   CachedDescriptorSet* FindCachedDescriptorSet(uint64_t p_contentHash, uint64_t p_descriptorSetLayoutHash,
+                                                Std::span<const DescriptorRecord> p_descriptorRecords);
+
+ private:
+   DescriptorSetCacheDescriptor m_descriptor;
+
+   // Cached DescriptorSets per content hash, hash collisions are resolved by comparing the whole content
+   Std::unordered_map<uint64_t, Std::vector<CachedDescriptorSet>> m_cachedDescriptorSets;
+   std::mutex m_cachedDescriptorSetsMutex;
+
+   std::atomic_uint64_t m_sharedCount = 0u;
+};
+
+} // namespace Render
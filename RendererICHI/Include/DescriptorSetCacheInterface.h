@@ -0,0 +1,45 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include <Std/span.h>
+#include <Std/vector.h>
+
+#include <Util/ManagerInterface.h>
+
+#include <RenderResource.h>
+
+namespace Render
+{
+
+class BufferView;
+class DescriptorSet;
+class DescriptorSetLayout;
+
+// BufferViews that are written to a binding of a DescriptorSet, starting at m_arrayOffset
+struct DescriptorSetBinding
+{
+   uint32_t m_bindingIndex = 0u;
+   uint32_t m_arrayOffset = 0u;
+   Std::vector<Ptr<BufferView>> m_bufferViews;
+};
+
+class DescriptorSetCacheInterface : public Foundation::Util::ManagerInterface<DescriptorSetCacheInterface>
+{
+ public:
+   DescriptorSetCacheInterface() = default;
+   virtual ~DescriptorSetCacheInterface() = default;
+
+   // Returns a DescriptorSet of the DescriptorSetLayout with the bindings written to it. If a DescriptorSet of an identical
+   // DescriptorSetLayout with the same BufferViews, ranges and usages is cached, it's shared instead of allocating and writing a
+   // new one. The DescriptorSet is shared, its resources and dynamic offsets must never be updated
+   virtual Ptr<DescriptorSet> AcquireDescriptorSet(Ptr<DescriptorSetLayout> p_descriptorSetLayout,
+                                                   Std::span<const DescriptorSetBinding> p_bindings) = 0u;
+
+   // Evicts the DescriptorSets that weren't referenced outside of the cache for RendererDefines::MaxQueuedFrames frames. Should
+   // be called once per frame
+   virtual void Update() = 0u;
+};
+
+} // namespace Render
@@ -40,6 +40,10 @@ struct DescriptorSetLayoutDescriptor
    Std::vector<LayoutBinding> m_layoutBindings;
    Ptr<VulkanDevice> m_vulkanDevice;
 
+   // Allows the descriptors to be updated after the DescriptorSet is bound, while the CommandBuffer is still recording. Only
+   // used by long-lived DescriptorSets that are bound once, the per-binding update-after-bind limits are lower
+   bool m_updateAfterBind = false;
+
  private:
    // TODO: immutable samplers here
 };
@@ -68,6 +72,9 @@ class DescriptorSetLayout final : public RenderResource<DescriptorSetLayout>
    // Get the DescriptorSet's hash
    uint64_t GetDescriptorSetLayoutHash() const;
 
+   // Returns the sum of the descriptor counts of all the bindings
+   uint32_t GetDescriptorCount() const;
+
  private:
    void GenerateHash();
 
@@ -75,6 +82,7 @@ class DescriptorSetLayout final : public RenderResource<DescriptorSetLayout>
    // NOTE: These are sorted by their binding index
    Std::vector<LayoutBinding> m_layoutBindings;
    uint64_t m_descriptorSetLayoutHash = 0u;
+   bool m_updateAfterBind = false;
    Ptr<VulkanDevice> m_vulkanDeviceRef;
 
    VkDescriptorSetLayout m_descriptorSetLayout = VK_NULL_HANDLE;
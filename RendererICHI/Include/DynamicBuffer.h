@@ -0,0 +1,123 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include <Std/array.h>
+#include <Std/vector.h>
+
+#include <Renderer.h>
+#include <RenderResource.h>
+#include <RendererTypes.h>
+
+namespace Render
+{
+
+class Buffer;
+class CommandBufferBase;
+class VulkanDevice;
+
+struct DynamicBufferDescriptor
+{
+   Ptr<VulkanDevice> m_vulkanDevice;
+   // Must be a multiple of 4
+   uint64_t m_bufferSize = 0u;
+   BufferUsageFlags m_bufferUsageFlags;
+   // HostVisible memory is written directly on Flush, other memory is written by the device
+   MemoryPropertyFlags m_memoryProperties;
+
+   const void* m_initialData = nullptr;
+   uint64_t m_initialDataSize = 0u;
+
+   // Dirty bytes of a Flush up to this size are written with UpdateBuffer, larger updates are copied from staging memory. Can't
+   // be larger than UpdateBufferCommand::MaxDataSizeInBytes
+   uint64_t m_inlineUpdateThresholdInBytes = 4u * 1024u;
+};
+
+// Buffer that is partially rewritten by the CPU, usually every frame. Writes go to a CPU shadow copy of the Buffer, and the
+// dirty byte ranges are tracked in a set that merges overlapping and adjacent ranges. Flush only uploads the dirty ranges:
+// - HostVisible memory is written directly. The device may still read the Buffer of frames in flight, so there is a Buffer per
+//   queued frame, and a range stays dirty until it's written to all of them. GetBuffer returns the Buffer of the current frame.
+// - Other memory is written by the CommandBuffer that is passed to Flush, with UpdateBuffer for small updates, or a single
+//   CopyBuffer from staging memory of the current frame otherwise. The writes are ordered by the device, a single Buffer
+//   suffices.
+// A DynamicBuffer isn't thread safe.
+class DynamicBuffer
+{
+   // Half open byte range, aligned to 4 bytes
+   struct DirtyRange
+   {
+      uint64_t m_begin = 0u;
+      uint64_t m_end = 0u;
+   };
+
+   struct BufferSlot
+   {
+      Ptr<Buffer> m_buffer;
+      uint8_t* m_mappedData = nullptr;
+      // Sorted, and neither overlapping nor adjacent
+      Std::vector<DirtyRange> m_dirtyRanges;
+   };
+
+   // Staging memory of a queued frame, it's reused once the frame is complete
+   struct FrameStaging
+   {
+      Ptr<Buffer> m_stagingBuffer;
+      uint8_t* m_mappedData = nullptr;
+      uint64_t m_offset = 0u;
+      uint64_t m_frameIndex = static_cast<uint64_t>(-1);
+   };
+
+ public:
+   DynamicBuffer() = delete;
+   DynamicBuffer(DynamicBufferDescriptor&& p_desc);
+   ~DynamicBuffer();
+
+   // Writes p_size bytes to the shadow copy, and marks the range dirty
+   void Write(uint64_t p_offset, const void* p_data, uint64_t p_size);
+
+   // Returns the shadow copy, ranges that are written through it must be marked dirty with MarkDirty
+   uint8_t* GetShadowData();
+   const uint8_t* GetShadowData() const;
+   void MarkDirty(uint64_t p_offset, uint64_t p_size);
+
+   // Uploads the dirty ranges of the Buffer of the current frame. p_commandBuffer can be nullptr if the memory is HostVisible,
+   // otherwise the writes are recorded in it, and are visible to all the commands that are recorded after them
+   void Flush(CommandBufferBase* p_commandBuffer);
+
+   // Returns the Buffer to use in the current frame
+   Ptr<Buffer> GetBuffer() const;
+
+   uint64_t GetSize() const;
+
+   // Returns the amount of bytes that the next Flush uploads
+   uint64_t GetDirtySize() const;
+
+ private:
+   // Adds the range to the set, merging it with the ranges it overlaps or touches
+   static void AddDirtyRange(Std::vector<DirtyRange>& p_dirtyRanges, DirtyRange p_dirtyRange);
+
+   BufferSlot& GetCurrentBufferSlot();
+   const BufferSlot& GetCurrentBufferSlot() const;
+
+   void FlushHostVisible(BufferSlot& p_bufferSlot);
+   void FlushDeviceLocal(BufferSlot& p_bufferSlot, CommandBufferBase* p_commandBuffer);
+
+   // Reserves p_size bytes in the staging memory of the current frame, grows the staging Buffer if it doesn't fit. Returns the
+   // offset within the staging Buffer
+   uint64_t AllocateStaging(uint64_t p_size, FrameStaging*& p_frameStaging);
+
+ private:
+   DynamicBufferDescriptor m_descriptor;
+
+   Std::vector<uint8_t> m_shadowData;
+
+   // A Buffer per queued frame if the memory is HostVisible, a single Buffer otherwise
+   Std::array<BufferSlot, RendererDefines::MaxQueuedFrames> m_bufferSlots;
+   uint32_t m_bufferSlotCount = 1u;
+   bool m_hostVisible = false;
+
+   Std::array<FrameStaging, RendererDefines::MaxQueuedFrames> m_frameStagings;
+};
+
+} // namespace Render
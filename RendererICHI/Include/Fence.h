@@ -32,7 +32,8 @@ class Fence final : public RenderResource<Fence>
    ~Fence() final;
 
  public:
-   void WaitForSignal(uint64_t p_waitInNanoSeconds = static_cast<uint64_t>(-1));
+   // Waits until the fence is signaled, returns false if the wait timed out
+   bool WaitForSignal(uint64_t p_waitInNanoSeconds = static_cast<uint64_t>(-1));
 
    bool IsSignaled() const;
 
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <inttypes.h>
+#include <mutex>
 #include <stdbool.h>
 
 #include <vulkan/vulkan.h>
@@ -8,6 +10,7 @@
 #include <Memory/AllocatorClass.h>
 #include <RenderResource.h>
 #include <RendererTypes.h>
+#include <AsyncUploadQueueInterface.h>
 
 namespace Render
 {
@@ -96,6 +99,22 @@ class Image final : public RenderResource<Image>
    ImageUsageFlags GetImageUsageFlags() const;
    uint32_t GetMipLevels() const;
    uint32_t GetArrayLayers() const;
+   MemoryPropertyFlags GetMemoryProperties() const;
+
+   // Returns whether the Image is a transient attachment, meaning its contents don't outlive the render pass it's used in
+   bool IsTransient() const;
+
+   // The Image was released by another QueueFamily, the next CommandBuffer of the destination QueueFamily that uses the Image
+   // records the acquire
+   void SetPendingOwnershipAcquire(const QueueFamilyOwnershipAcquire& p_acquire);
+
+   // Returns true and takes the pending acquire if there is one for p_queueFamilyIndex, only the first caller gets it
+   bool ConsumePendingOwnershipAcquire(uint32_t p_queueFamilyIndex, QueueFamilyOwnershipAcquire& p_acquire);
+
+   // The Image was released to, or used by the consumer QueueFamily. The transfer QueueFamily doesn't own it anymore, uploads to
+   // the Image are recorded on the consumer QueueFamily
+   void MarkOwnedByConsumer();
+   bool IsOwnedByConsumer() const;
 
  private:
    // Converts ImageCreationFlags to native Vulkan flag bits
@@ -122,6 +141,11 @@ class Image final : public RenderResource<Image>
    uint64_t m_bufferSizeAllocatedMemory = 0u;
    VkImage m_imageNative = VK_NULL_HANDLE;
    VkDeviceMemory m_deviceMemory = VK_NULL_HANDLE;
+
+   std::mutex m_ownershipMutex;
+   QueueFamilyOwnershipAcquire m_pendingOwnershipAcquire;
+   bool m_hasPendingOwnershipAcquire = false;
+   std::atomic_bool m_ownedByConsumer = false;
 };
 
 } // namespace Render
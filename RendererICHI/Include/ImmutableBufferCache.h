@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <mutex>
+
+#include <Std/unordered_map.h>
+
+#include <Memory/AllocatorClass.h>
+
+#include <ImmutableBufferCacheInterface.h>
+#include <RenderResource.h>
+#include <RendererTypes.h>
+
+namespace Render
+{
+
+class Buffer;
+
+// Deduplicates Buffers with immutable content. The Buffers are keyed by a 128 bit hash of their initial data, together with the
+// properties of the Buffer. The cache holds a reference to every resident Buffer, Update releases the Buffers that are only
+// referenced by the cache, after which they're deleted by the ResourceDeleter once the device is done with them.
+class ImmutableBufferCache final : public ImmutableBufferCacheInterface
+{
+   struct ContentKey
+   {
+      uint64_t m_contentHash[2] = {};
+      uint64_t m_initialDataSize = 0u;
+      uint64_t m_bufferSize = 0u;
+      BufferUsageFlags m_bufferUsageFlags;
+      MemoryPropertyFlags m_memoryProperties;
+      QueueFamilyTypeFlags m_queueFamilyAccess;
+
+      bool operator==(const ContentKey& p_other) const;
+   };
+
+   struct ContentKeyHash
+   {
+      size_t operator()(const ContentKey& p_contentKey) const;
+   };
+
+ public:
+   // Only need one instance
+   CLASS_ALLOCATOR_PAGECOUNT_PAGESIZE(ImmutableBufferCache, 1u);
+
+   ImmutableBufferCache() = default;
+   ~ImmutableBufferCache();
+
+ public:
+   Ptr<Buffer> AcquireBuffer(BufferDescriptor&& p_desc) final;
+   void Update() final;
+
+   // Returns the amount of resident Buffers, and the amount of Buffers that were shared instead of created
+   uint64_t GetResidentCount();
+   uint64_t GetSharedCount() const;
+
+ private:
+   static ContentKey CreateContentKey(const BufferDescriptor& p_desc);
+
+ private:
+   Std::unordered_map<ContentKey, Ptr<Buffer>, ContentKeyHash> m_residentBuffers;
+   std::mutex m_residentBuffersMutex;
+
+   std::atomic_uint64_t m_sharedCount = 0u;
+};
+
+} // namespace Render
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include <Util/ManagerInterface.h>
+
+#include <RenderResource.h>
+
+namespace Render
+{
+
+class Buffer;
+struct BufferDescriptor;
+
+class ImmutableBufferCacheInterface : public Foundation::Util::ManagerInterface<ImmutableBufferCacheInterface>
+{
+ public:
+   ImmutableBufferCacheInterface() = default;
+   virtual ~ImmutableBufferCacheInterface() = default;
+
+   // Returns a Buffer that is initialized with the initial data of p_desc. If a Buffer with identical initial data, size, usage,
+   // memory properties and QueueFamily access is resident, it's shared instead of creating and uploading a new one. The Buffer
+   // is shared, it must never be written to after its creation, Buffer::IsShared is set and the writes assert
+   virtual Ptr<Buffer> AcquireBuffer(BufferDescriptor&& p_desc) = 0u;
+
+   // Releases the Buffers that aren't referenced outside of the cache anymore. Should be called once per frame
+   virtual void Update() = 0u;
+};
+
+} // namespace Render
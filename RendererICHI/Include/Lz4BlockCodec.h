@@ -0,0 +1,35 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include <UploadCodec.h>
+
+namespace Render
+{
+
+// Codec of the LZ4 block format. Every block is compressed independently, without a frame header or checksums. Blocks that are
+// compressed by the reference LZ4 implementation can be decompressed as well.
+class Lz4BlockCodec final : public UploadCodecInterface
+{
+ public:
+   // Matches are encoded as a 2 byte offset, and are at least MinMatchSize long
+   static constexpr uint32_t MinMatchSize = 4u;
+   static constexpr uint32_t MaxMatchOffset = 65535u;
+
+ public:
+   Lz4BlockCodec() = default;
+   ~Lz4BlockCodec() final = default;
+
+   bool DecompressBlock(const uint8_t* p_compressedData, uint64_t p_compressedSizeInBytes, uint8_t* p_destData,
+                        uint64_t p_decompressedSizeInBytes) const final;
+
+   // Compresses a single block, p_destData must be at least GetMaxCompressedSize large. Returns the compressed size. Used by
+   // the tools that produce the assets
+   static uint64_t CompressBlock(const uint8_t* p_sourceData, uint64_t p_sourceSizeInBytes, uint8_t* p_destData);
+
+   // Returns the worst case compressed size of a block, incompressible data grows slightly
+   static uint64_t GetMaxCompressedSize(uint64_t p_sourceSizeInBytes);
+};
+
+} // namespace Render
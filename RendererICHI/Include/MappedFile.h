@@ -0,0 +1,50 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+namespace Render
+{
+
+// Read-only memory mapping of a whole file. The pages are only read from disk once they're touched, which allows streaming the
+// file without reading it into host memory first
+class MappedFile
+{
+ public:
+   MappedFile() = default;
+   ~MappedFile();
+
+   MappedFile(const MappedFile&) = delete;
+   MappedFile& operator=(const MappedFile&) = delete;
+
+   // Maps the whole file, returns false if the file can't be opened or mapped
+   bool Open(const char* p_path);
+   void Close();
+
+   bool IsOpen() const;
+   const uint8_t* GetData() const;
+   uint64_t GetSize() const;
+
+   // Hints the OS to start reading the pages of the range from disk
+   void WillNeed(uint64_t p_offsetInBytes, uint64_t p_sizeInBytes) const;
+
+   // Hints the OS that the pages of the range won't be read again, they're dropped from the working set of the process
+   void DontNeed(uint64_t p_offsetInBytes, uint64_t p_sizeInBytes) const;
+
+ private:
+   // Returns the range rounded out to whole pages, clamped to the mapping
+   void GetPageRange(uint64_t p_offsetInBytes, uint64_t p_sizeInBytes, uint8_t*& p_pageStart, uint64_t& p_pageRangeSize) const;
+
+ private:
+   const uint8_t* m_data = nullptr;
+   uint64_t m_size = 0u;
+
+#if defined(_WIN32)
+   void* m_fileHandle = nullptr;
+   void* m_mappingHandle = nullptr;
+#else
+   int m_fileDescriptor = -1;
+#endif
+};
+
+} // namespace Render
@@ -20,6 +20,7 @@ class DescriptorSet;
 class BufferView;
 class ImageView;
 class GraphicsPipeline;
+class ComputePipeline;
 class CommandBufferBase;
 class SubCommandBuffer;
 class Buffer;
@@ -511,18 +512,17 @@ class BindPipelineCommand : public RenderCommand
  public:
    CLASS_ALLOCATOR_PAGECOUNT_PAGESIZE(BindPipelineCommand, 12u);
 
-   // TODO: ComputePipeline
-   // BindPipelineCommand(PipelineBindPoint p_pipelineBindPoint, Ptr<GraphicsPipeline> p_graphicsPipeline);
-
    ~BindPipelineCommand() final = default;
 
  private:
    BindPipelineCommand(PipelineBindPoint p_pipelineBindPoint, Ptr<GraphicsPipeline> p_graphicsPipeline);
+   BindPipelineCommand(Ptr<ComputePipeline> p_computePipeline);
 
    void ExecuteInternal(CommandBufferBase* p_commandBuffer) final;
 
    PipelineBindPoint m_pipelineBindPoint;
    Ptr<GraphicsPipeline> m_graphicsPipeline;
+   Ptr<ComputePipeline> m_computePipeline;
 
    VkPipelineBindPoint m_nativePipelineBindPoint = {};
    VkPipeline m_nativePipeline = {};
@@ -629,6 +629,10 @@ struct PipelineBufferBarrier
    uint32_t m_srcQueueFamilyIndex = 0u;
    uint32_t m_dstQueueFamilyIndex = 0u;
    Ptr<BufferView> m_bufferView;
+   // Used instead of the BufferView if no BufferView is provided
+   Ptr<Buffer> m_buffer;
+   uint64_t m_offset = 0u;
+   uint64_t m_size = 0u;
 };
 
 struct PipelineImageBarrier
@@ -642,6 +646,9 @@ struct PipelineImageBarrier
    uint32_t m_srcQueueFamilyIndex = 0u;
    uint32_t m_dstQueueFamilyIndex = 0u;
    Ptr<ImageView> m_imageView;
+   // Used instead of the ImageView if no ImageView is provided
+   Ptr<Image> m_image;
+   VkImageSubresourceRange m_subresourceRange = {};
 };
 
 class PipelineBarrierCommand : public RenderCommand
@@ -659,11 +666,22 @@ class PipelineBarrierCommand : public RenderCommand
                                             uint32_t p_srcQueueFamilyIndex, uint32_t p_dstQueueFamilyIndex,
                                             Ptr<BufferView> p_bufferView);
 
+   PipelineBarrierCommand* AddBufferBarrier(VkPipelineStageFlags2 p_srcStageMask, VkAccessFlags2 p_srcAccessMask,
+                                            VkPipelineStageFlags2 p_dstStageMask, VkAccessFlags2 p_dstAccessMask,
+                                            uint32_t p_srcQueueFamilyIndex, uint32_t p_dstQueueFamilyIndex, Ptr<Buffer> p_buffer,
+                                            uint64_t p_offset, uint64_t p_size);
+
    PipelineBarrierCommand* AddImageBarrier(VkPipelineStageFlags2 p_srcStageMask, VkAccessFlags2 p_srcAccessMask,
                                            VkPipelineStageFlags2 p_dstStageMask, VkAccessFlags2 p_dstAccessMask,
                                            VkImageLayout p_oldLayout, VkImageLayout p_newLayout, uint32_t p_srcQueueFamilyIndex,
                                            uint32_t p_dstQueueFamilyIndex, Ptr<ImageView> p_imageView);
 
+   PipelineBarrierCommand* AddImageBarrier(VkPipelineStageFlags2 p_srcStageMask, VkAccessFlags2 p_srcAccessMask,
+                                           VkPipelineStageFlags2 p_dstStageMask, VkAccessFlags2 p_dstAccessMask,
+                                           VkImageLayout p_oldLayout, VkImageLayout p_newLayout, uint32_t p_srcQueueFamilyIndex,
+                                           uint32_t p_dstQueueFamilyIndex, Ptr<Image> p_image,
+                                           const VkImageSubresourceRange& p_subresourceRange);
+
  private:
    PipelineBarrierCommand();
 
@@ -700,6 +718,50 @@ class DrawIndexedCommand : public RenderCommand
    uint32_t m_firstInstance = 0u;
 };
 
+// ----------- PushConstantsCommand -----------
+
+class PushConstantsCommand : public RenderCommand
+{
+   friend class CommandBufferBase;
+
+ public:
+   CLASS_ALLOCATOR_PAGECOUNT_PAGESIZE(PushConstantsCommand, 12u);
+
+   ~PushConstantsCommand() final = default;
+
+ private:
+   PushConstantsCommand(Ptr<ComputePipeline> p_computePipeline, uint32_t p_offset, const void* p_data, uint32_t p_dataSize);
+
+   void ExecuteInternal(CommandBufferBase* p_commandBuffer) final;
+
+ private:
+   Ptr<ComputePipeline> m_computePipeline;
+   uint32_t m_offset = 0u;
+   Std::vector<uint8_t> m_data;
+};
+
+// ----------- DispatchCommand -----------
+
+class DispatchCommand : public RenderCommand
+{
+   friend class CommandBufferBase;
+
+ public:
+   CLASS_ALLOCATOR_PAGECOUNT_PAGESIZE(DispatchCommand, 12u);
+
+   ~DispatchCommand() final = default;
+
+ private:
+   DispatchCommand(uint32_t p_groupCountX, uint32_t p_groupCountY, uint32_t p_groupCountZ);
+
+   void ExecuteInternal(CommandBufferBase* p_commandBuffer) final;
+
+ private:
+   uint32_t m_groupCountX = 0u;
+   uint32_t m_groupCountY = 0u;
+   uint32_t m_groupCountZ = 0u;
+};
+
 // ----------- CopyBufferCommand -----------
 
 struct BufferCopyRegion
@@ -729,6 +791,182 @@ class CopyBufferCommand : public RenderCommand
    Std::vector<VkBufferCopy> m_bufferCopyRegions;
 };
 
+// ----------- UpdateBufferCommand -----------
+
+// Writes a small payload to a Buffer. The payload is copied into the command, and recorded inline in the command buffer
+class UpdateBufferCommand : public RenderCommand
+{
+   friend class CommandBufferBase;
+
+ public:
+   CLASS_ALLOCATOR_PAGECOUNT_PAGESIZE(UpdateBufferCommand, 12u);
+
+   // Largest payload that vkCmdUpdateBuffer accepts
+   static constexpr uint64_t MaxDataSizeInBytes = 65536u;
+
+   ~UpdateBufferCommand() final = default;
+
+ private:
+   UpdateBufferCommand(Ptr<Buffer> p_destBuffer, uint64_t p_destOffset, const void* p_data, uint64_t p_dataSize);
+
+   void ExecuteInternal(CommandBufferBase* p_commandBuffer) final;
+
+ private:
+   Ptr<Buffer> m_destBuffer;
+   uint64_t m_destOffset = 0u;
+   Std::vector<uint8_t> m_data;
+};
+
+// ----------- FillBufferCommand -----------
+
+class FillBufferCommand : public RenderCommand
+{
+   friend class CommandBufferBase;
+
+ public:
+   CLASS_ALLOCATOR_PAGECOUNT_PAGESIZE(FillBufferCommand, 12u);
+
+   ~FillBufferCommand() final = default;
+
+ private:
+   FillBufferCommand(Ptr<Buffer> p_destBuffer, uint64_t p_destOffset, uint64_t p_size, uint32_t p_data);
+
+   void ExecuteInternal(CommandBufferBase* p_commandBuffer) final;
+
+ private:
+   Ptr<Buffer> m_destBuffer;
+   uint64_t m_destOffset = 0u;
+   uint64_t m_size = 0u;
+   uint32_t m_data = 0u;
+};
+
+// ----------- CopyBufferToImageCommand -----------
+
+struct BufferImageCopyRegion
+{
+   uint64_t m_bufferOffset = 0ul;
+   // Row length and height of the data in the Buffer in texels, 0 means the data is tightly packed
+   uint32_t m_bufferRowLength = 0u;
+   uint32_t m_bufferImageHeight = 0u;
+   VkImageSubresourceLayers m_imageSubresource = {};
+   VkOffset3D m_imageOffset = {};
+   VkExtent3D m_imageExtent = {};
+};
+
+class CopyBufferToImageCommand : public RenderCommand
+{
+   friend class CommandBufferBase;
+
+ public:
+   CLASS_ALLOCATOR_PAGECOUNT_PAGESIZE(CopyBufferToImageCommand, 12u);
+
+   ~CopyBufferToImageCommand() final = default;
+
+ private:
+   CopyBufferToImageCommand(Ptr<Buffer> p_srcBuffer, Ptr<Image> p_destImage, VkImageLayout p_destImageLayout,
+                            Std::span<BufferImageCopyRegion> p_copyRegions);
+
+   void ExecuteInternal(CommandBufferBase* p_commandBuffer) final;
+
+ private:
+   Ptr<Buffer> m_srcBuffer;
+   Ptr<Image> m_destImage;
+   VkImageLayout m_destImageLayout = {};
+   Std::vector<VkBufferImageCopy> m_copyRegions;
+};
+
+// ----------- CopyImageToBufferCommand -----------
+
+class CopyImageToBufferCommand : public RenderCommand
+{
+   friend class CommandBufferBase;
+
+ public:
+   CLASS_ALLOCATOR_PAGECOUNT_PAGESIZE(CopyImageToBufferCommand, 12u);
+
+   ~CopyImageToBufferCommand() final = default;
+
+ private:
+   CopyImageToBufferCommand(Ptr<Image> p_srcImage, VkImageLayout p_srcImageLayout, Ptr<Buffer> p_destBuffer,
+                            Std::span<BufferImageCopyRegion> p_copyRegions);
+
+   void ExecuteInternal(CommandBufferBase* p_commandBuffer) final;
+
+ private:
+   Ptr<Image> m_srcImage;
+   VkImageLayout m_srcImageLayout = {};
+   Ptr<Buffer> m_destBuffer;
+   Std::vector<VkBufferImageCopy> m_copyRegions;
+};
+
+// ----------- CopyImageCommand -----------
+
+struct ImageCopyRegion
+{
+   VkImageSubresourceLayers m_srcSubresource = {};
+   VkOffset3D m_srcOffset = {};
+   VkImageSubresourceLayers m_destSubresource = {};
+   VkOffset3D m_destOffset = {};
+   VkExtent3D m_extent = {};
+};
+
+class CopyImageCommand : public RenderCommand
+{
+   friend class CommandBufferBase;
+
+ public:
+   CLASS_ALLOCATOR_PAGECOUNT_PAGESIZE(CopyImageCommand, 12u);
+
+   ~CopyImageCommand() final = default;
+
+ private:
+   CopyImageCommand(Ptr<Image> p_srcImage, VkImageLayout p_srcImageLayout, Ptr<Image> p_destImage, VkImageLayout p_destImageLayout,
+                    Std::span<ImageCopyRegion> p_copyRegions);
+
+   void ExecuteInternal(CommandBufferBase* p_commandBuffer) final;
+
+ private:
+   Ptr<Image> m_srcImage;
+   VkImageLayout m_srcImageLayout = {};
+   Ptr<Image> m_destImage;
+   VkImageLayout m_destImageLayout = {};
+   Std::vector<VkImageCopy> m_copyRegions;
+};
+
+// ----------- BlitImageCommand -----------
+
+struct ImageBlitRegion
+{
+   VkImageSubresourceLayers m_srcSubresource = {};
+   Std::array<VkOffset3D, 2u> m_srcOffsets = {};
+   VkImageSubresourceLayers m_destSubresource = {};
+   Std::array<VkOffset3D, 2u> m_destOffsets = {};
+};
+
+class BlitImageCommand : public RenderCommand
+{
+   friend class CommandBufferBase;
+
+ public:
+   CLASS_ALLOCATOR_PAGECOUNT_PAGESIZE(BlitImageCommand, 12u);
+
+   ~BlitImageCommand() final = default;
+
+ private:
+   BlitImageCommand(Ptr<Image> p_srcImage, VkImageLayout p_srcImageLayout, Ptr<Image> p_destImage, VkImageLayout p_destImageLayout,
+                    Std::span<ImageBlitRegion> p_blitRegions, VkFilter p_filter);
+
+   void ExecuteInternal(CommandBufferBase* p_commandBuffer) final;
+
+ private:
+   Ptr<Image> m_srcImage;
+   VkImageLayout m_srcImageLayout = {};
+   Ptr<Image> m_destImage;
+   VkImageLayout m_destImageLayout = {};
+   Std::vector<VkImageBlit> m_blitRegions;
+   VkFilter m_filter = VK_FILTER_LINEAR;
+};
+
 // ----------- BeginRenderingCommand -----------
 
 struct RenderingAttachmentInfo
@@ -739,6 +977,7 @@ struct RenderingAttachmentInfo
    Ptr<ImageView> m_resolveImageView;
    VkImageLayout m_resolveImageLayout = {};
    AttachmentLoadOp m_loadOp = AttachmentLoadOp::Invalid;
+   // If left Invalid, transient attachments default to DontCare, and all others to Store
    AttachmentStoreOp m_storeOp = AttachmentStoreOp::Invalid;
    VkClearValue m_clearValue = {};
 };
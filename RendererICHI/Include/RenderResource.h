@@ -106,6 +106,12 @@ class RenderResource : public Resource
    RenderResource() = default;
    virtual ~RenderResource() override = default;
 
+   // Returns the amount of Ptrs that reference the resource
+   uint32_t GetRefCount() const
+   {
+      return m_refCount.load();
+   }
+
  protected:
    virtual void ReleaseInternal()
    {
@@ -61,6 +61,7 @@ enum class MemoryPropertyFlags : uint32_t
    HostVisible = (1 << 1),
    HostCoherent = (1 << 2),
    HostCached = (1 << 3),
+   LazilyAllocated = (1 << 4),
 };
 
 enum class DescriptorType : uint32_t
@@ -74,6 +75,8 @@ enum class DescriptorType : uint32_t
    UniformBuffer,
    StorageBuffer,
    InputAttachment,
+   // Storage buffer without a dynamic offset, can be used in large arrays, and with update-after-bind bindings
+   StaticStorageBuffer,
    // TODO: Add support for Inline uniform block?
    // TODO: Add support for acceleration structures if I ever get hold of a RTX card :')
 
@@ -101,6 +104,8 @@ enum class BufferUsageFlags : uint32_t
    IndexBuffer = (1 << 6),
    VertexBuffer = (1 << 7),
    IndirectBuffer = (1 << 8),
+   // The device address of the Buffer can be queried, and used by shaders
+   ShaderDeviceAddress = (1 << 9),
 };
 
 enum class BufferUsage : uint32_t
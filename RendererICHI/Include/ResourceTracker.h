@@ -2,6 +2,8 @@
 
 #include <mutex>
 
+#include <Std/array.h>
+#include <Std/unordered_map.h>
 #include <Std/unordered_set.h>
 
 #include <Memory/AllocatorClass.h>
@@ -15,6 +17,8 @@ class Resource;
 
 class ResourceTracker final : public ResourceTrackerInterface
 {
+   static constexpr uint32_t FrameDeltaHistoryCount = 16u;
+
  public:
    CLASS_ALLOCATOR_PAGECOUNT_PAGESIZE(ResourceTracker, 1u);
 
@@ -27,10 +31,34 @@ class ResourceTracker final : public ResourceTrackerInterface
    void Untrack(Resource* p_resource) final;
    bool IsTracked(Resource* p_resource) final;
 
+   // ----------- Memory Telemetry -----------
+
+   void ReportAllocation(const void* p_owner, MemoryTelemetryRecord&& p_record) final;
+   void ReportDeallocation(const void* p_owner) final;
+   void MarkReferenced(const void* p_owner) final;
+   void MarkReferenced(Std::span<const void* const> p_owners) final;
+
+   Std::vector<MemoryTelemetryRecord> GetLargestAllocations(uint32_t p_count) final;
+   Std::vector<MemoryTelemetryRecord> GetStaleAllocations(uint64_t p_frameCount) final;
+   MemoryTelemetryFrameDelta GetFrameDelta(uint64_t p_frameIndex) final;
+
+   Std::string DumpMemoryTelemetryJson() final;
+   Std::string DumpMemoryTelemetryCsv() final;
+
+ private:
+   // Returns a copy of all the records, with the names resolved from their Resource
+   Std::vector<MemoryTelemetryRecord> GetRecordsSnapshot();
+
+   // Returns the delta entry of the current frame, resets it if the entry belongs to an older frame
+   MemoryTelemetryFrameDelta& GetCurrentFrameDelta();
+
  private:
    std::recursive_mutex m_mutex;
 
    Std::unordered_set<Resource*> m_trackedResources;
+
+   Std::unordered_map<const void*, MemoryTelemetryRecord> m_memoryRecords;
+   Std::array<MemoryTelemetryFrameDelta, FrameDeltaHistoryCount> m_frameDeltas;
 };
 
 } // namespace Render
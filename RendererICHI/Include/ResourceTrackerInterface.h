@@ -3,6 +3,10 @@
 #include <inttypes.h>
 #include <stdbool.h>
 
+#include <Std/span.h>
+#include <Std/string.h>
+#include <Std/vector.h>
+
 #include <Util/ManagerInterface.h>
 
 namespace Render
@@ -10,6 +14,54 @@ namespace Render
 
 class Resource;
 
+// ----------- Memory Telemetry -----------
+
+enum class MemoryTelemetryCategory : uint32_t
+{
+   Buffer = 0u,
+   Image,
+   DescriptorPool,
+   CommandPool,
+   // Sub-allocations made within the AsyncUploadQueue's staging Buffer
+   Staging,
+
+   Count,
+};
+
+// Describes a single memory allocation that is reported to the ResourceTracker
+struct MemoryTelemetryRecord
+{
+   MemoryTelemetryCategory m_category = MemoryTelemetryCategory::Count;
+   // Resource that owns the allocation, the name is resolved from it when queried. Can be nullptr for allocations that aren't a
+   // Resource (e.g. Staging regions)
+   const Resource* m_resource = nullptr;
+   Std::string m_name;
+
+   // Size in bytes. DescriptorPools and CommandPools are driver owned, and report 0
+   uint64_t m_sizeInBytes = 0u;
+   // Native VkMemoryPropertyFlags of the allocation
+   uint32_t m_memoryPropertyFlags = 0u;
+   // Native usage flags, dependent on the category (e.g. VkBufferUsageFlags, VkImageUsageFlags)
+   uint32_t m_usageFlags = 0u;
+   // Number of elements the allocation holds, for allocations that don't have a byte size (e.g. descriptors)
+   uint32_t m_elementCount = 0u;
+
+   uint64_t m_creationFrame = 0u;
+   uint64_t m_lastReferencedFrame = 0u;
+};
+
+// Memory that was allocated and freed within a single frame
+struct MemoryTelemetryFrameDelta
+{
+   uint64_t m_frameIndex = static_cast<uint64_t>(-1);
+   uint64_t m_allocatedBytes = 0u;
+   uint64_t m_freedBytes = 0u;
+   uint32_t m_allocationCount = 0u;
+   uint32_t m_freeCount = 0u;
+};
+
+// ----------- ResourceTrackerInterface -----------
+
 class ResourceTrackerInterface : public Foundation::Util::ManagerInterface<ResourceTrackerInterface>
 {
  public:
@@ -20,6 +72,28 @@ class ResourceTrackerInterface : public Foundation::Util::ManagerInterface<Resou
    virtual void Track(Resource* p_resource) = 0;
    virtual void Untrack(Resource* p_resource) = 0;
    virtual bool IsTracked(Resource* p_resource) = 0;
+
+   // Reports an allocation owned by p_owner. Each owner can only report a single allocation at a time
+   virtual void ReportAllocation(const void* p_owner, MemoryTelemetryRecord&& p_record) = 0;
+   virtual void ReportDeallocation(const void* p_owner) = 0;
+
+   // Marks the allocation of p_owner as referenced in the current frame. Owners that didn't report an allocation are ignored
+   virtual void MarkReferenced(const void* p_owner) = 0;
+   // Marks the allocations of all p_owners with a single lock, used to report everything a CommandBuffer references at once
+   virtual void MarkReferenced(Std::span<const void* const> p_owners) = 0;
+
+   // Returns the p_count largest allocations, sorted from largest to smallest
+   virtual Std::vector<MemoryTelemetryRecord> GetLargestAllocations(uint32_t p_count) = 0;
+
+   // Returns the allocations that haven't been referenced in the last p_frameCount frames
+   virtual Std::vector<MemoryTelemetryRecord> GetStaleAllocations(uint64_t p_frameCount) = 0;
+
+   // Returns the allocation delta of p_frameIndex. Only a limited amount of frames are kept in the history
+   virtual MemoryTelemetryFrameDelta GetFrameDelta(uint64_t p_frameIndex) = 0;
+
+   // Snapshot of all the reported allocations
+   virtual Std::string DumpMemoryTelemetryJson() = 0;
+   virtual Std::string DumpMemoryTelemetryCsv() = 0;
 };
 
 } // namespace Render
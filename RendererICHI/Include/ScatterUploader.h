@@ -0,0 +1,108 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <mutex>
+
+#include <vulkan/vulkan.h>
+
+#include <Std/array.h>
+#include <Std/span.h>
+
+#include <Renderer.h>
+#include <RenderResource.h>
+
+namespace Render
+{
+
+class Buffer;
+class CommandBufferBase;
+class ComputePipeline;
+class ShaderModule;
+class ShaderStage;
+class VulkanDevice;
+
+struct ScatterUploaderDescriptor
+{
+   Ptr<VulkanDevice> m_vulkanDevice;
+   // Staging memory that can be used per frame, there is a staging buffer for every queued frame
+   uint64_t m_stagingSizeInBytesPerFrame = 16u * 1024u * 1024u;
+};
+
+// Small update of a range of the destination Buffer. The offset and size must be a multiple of 4
+struct ScatterUploadRequest
+{
+   const void* m_sourceData = nullptr;
+   uint32_t m_sizeInBytes = 0u;
+   uint64_t m_destOffsetInBytes = 0u;
+};
+
+// Uploads many small, scattered updates to a single Buffer with a compute dispatch instead of copy regions. The updates and a
+// table of their destinations are packed in a single allocation of the staging memory of the frame, and a built-in compute
+// shader scatters them into the destination. The dispatch is recorded in a CommandBuffer of a queue that supports compute, the
+// update is visible to all the commands that are recorded after it. The destination Buffer must be created with the
+// ShaderDeviceAddress usage.
+class ScatterUploader
+{
+   // Must match the push constants of ScatterUpload.comp
+   struct PushConstants
+   {
+      VkDeviceAddress m_tableAddress = 0u;
+      VkDeviceAddress m_sourceAddress = 0u;
+      VkDeviceAddress m_destAddress = 0u;
+      uint32_t m_firstRecord = 0u;
+      uint32_t m_recordCount = 0u;
+   };
+
+   // Must match the ScatterRecord of ScatterUpload.comp, offsets and sizes are in words
+   struct ScatterRecord
+   {
+      uint32_t m_destOffset = 0u;
+      uint32_t m_sourceOffset = 0u;
+      uint32_t m_size = 0u;
+      uint32_t m_padding = 0u;
+   };
+
+   // Staging memory of a queued frame, it's reused once the frame is complete
+   struct FrameStaging
+   {
+      Ptr<Buffer> m_stagingBuffer;
+      uint8_t* m_mappedData = nullptr;
+      uint64_t m_offset = 0u;
+      uint64_t m_frameIndex = static_cast<uint64_t>(-1);
+   };
+
+ public:
+   // Must match the workgroup layout of ScatterUpload.comp
+   static constexpr uint32_t WorkgroupSize = 64u;
+   static constexpr uint32_t LanesPerRecord = 16u;
+
+   ScatterUploader() = delete;
+   ScatterUploader(ScatterUploaderDescriptor&& p_desc);
+   ~ScatterUploader();
+
+   // Packs the requests in the staging memory of the current frame, and records the scatter of the requests into
+   // p_destBuffer. The records are written in parallel, the ranges of the requests can't overlap. Can't be recorded while
+   // rendering, and p_commandBuffer must execute on a Queue that supports compute.
+   void ScatterUpload(CommandBufferBase* p_commandBuffer, Ptr<Buffer> p_destBuffer,
+                      Std::span<const ScatterUploadRequest> p_scatterUploadRequests);
+
+ private:
+   // Reserves p_size bytes in the staging memory of the current frame, returns the offset within the staging Buffer
+   uint64_t AllocateStaging(uint64_t p_size, FrameStaging*& p_frameStaging);
+
+ private:
+   ScatterUploaderDescriptor m_descriptor;
+
+   Ptr<ShaderModule> m_shaderModule;
+   Ptr<ShaderStage> m_shaderStage;
+   Ptr<ComputePipeline> m_computePipeline;
+
+   // Records of a single dispatch, bound by the maximum workgroup count of the device
+   uint32_t m_maxRecordsPerDispatch = 0u;
+
+   Std::array<FrameStaging, RendererDefines::MaxQueuedFrames> m_frameStagings;
+   std::mutex m_stagingMutex;
+};
+
+} // namespace Render
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include <Std/span.h>
+
+namespace enki
+{
+class TaskScheduler;
+};
+
+namespace Render
+{
+
+namespace StagingCopy
+{
+
+// Copies smaller than this are always done on the calling thread
+static constexpr uint64_t ParallelCopyThresholdInBytes = 1024u * 1024u;
+// Size of the byte ranges the copies are split in when they're done in parallel
+static constexpr uint64_t ParallelCopySliceSizeInBytes = 256u * 1024u;
+
+struct CopyRange
+{
+   void* m_dest = nullptr;
+   const void* m_source = nullptr;
+   uint64_t m_size = 0u;
+};
+
+// Copies p_size bytes with non-temporal stores where supported. Staging memory is write-combined and never read by the CPU,
+// streaming the stores avoids evicting the caches
+void StreamingCopy(void* p_dest, const void* p_source, uint64_t p_size);
+
+// Copies all the ranges with StreamingCopy. Large copies are split by byte ranges over the workers of p_taskScheduler, ranges
+// are split as well. p_taskScheduler can be nullptr, in which case everything is copied on the calling thread.
+void ParallelStreamingCopy(enki::TaskScheduler* p_taskScheduler, Std::span<const CopyRange> p_copyRanges);
+
+}; // namespace StagingCopy
+
+}; // namespace Render
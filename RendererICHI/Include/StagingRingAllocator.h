@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include <Util/Assert.h>
+
+namespace Render
+{
+
+// Lock-free ring allocator used for the staging buffers of the AsyncUploadQueue and AsyncReadbackQueue. Positions are
+// monotonically increasing byte counters, the offset in the buffer is the position modulo the capacity. Multiple threads can
+// reserve concurrently, while regions are retired in order by advancing the tail.
+class StagingRingAllocator
+{
+ public:
+   struct Reservation
+   {
+      // Head position before the reservation, including the padding that was added for alignment and wrapping. When the
+      // reservation restarted an empty ring, the padding is dropped, and this is the start position
+      uint64_t m_reservedFrom = 0u;
+      // Aligned start position of the reserved region
+      uint64_t m_start = 0u;
+      // End position of the reserved region
+      uint64_t m_end = 0u;
+   };
+
+ public:
+   StagingRingAllocator() = default;
+   ~StagingRingAllocator() = default;
+
+   void Init(uint64_t p_capacity)
+   {
+      ASSERT(m_capacity == 0u, "StagingRingAllocator was already initialized");
+      m_capacity = p_capacity;
+   }
+
+   // Reserves p_size bytes, returns false if there isn't enough space available. A reservation always fits an empty ring
+   bool Reserve(uint64_t p_size, uint64_t p_alignment, Reservation& p_reservation)
+   {
+      ASSERT(m_capacity != 0u, "StagingRingAllocator hasn't been initialized");
+      ASSERT(p_size <= m_capacity, "Reservation is larger than the capacity of the StagingRingAllocator");
+      ASSERT(m_capacity % p_alignment == 0u, "Alignment must be a divisor of the capacity");
+
+      uint64_t head = m_head.load(std::memory_order_acquire);
+      while (true)
+      {
+         uint64_t start = (head + p_alignment - 1u) / p_alignment * p_alignment;
+
+         // Regions can't wrap around the end of the buffer, skip to the start of the buffer instead
+         const uint64_t offset = start % m_capacity;
+         if (offset + p_size > m_capacity)
+         {
+            start += m_capacity - offset;
+         }
+
+         // Regions larger than half the capacity don't fit after the skip at some offsets, even when the ring is empty. An empty
+         // ring restarts at the start of the region instead, the skipped padding is never retired
+         const uint64_t tail = m_tail.load(std::memory_order_acquire);
+         const uint64_t end = start + p_size;
+         const bool restartsRing = end - tail > m_capacity;
+         if (restartsRing && head != tail)
+         {
+            return false;
+         }
+
+         if (m_head.compare_exchange_weak(head, end, std::memory_order_acq_rel, std::memory_order_acquire))
+         {
+            // Nothing is retired while the ring is empty, the tail only moves once the head does
+            if (restartsRing)
+            {
+               m_tail.store(start, std::memory_order_release);
+            }
+
+            p_reservation = Reservation{.m_reservedFrom = restartsRing ? start : head, .m_start = start, .m_end = end};
+            return true;
+         }
+      }
+   }
+
+   // Retires all the reservations up until p_position
+   void Retire(uint64_t p_position)
+   {
+      ASSERT(p_position >= m_tail.load(std::memory_order_relaxed), "Reservations must be retired in order");
+      m_tail.store(p_position, std::memory_order_release);
+   }
+
+   uint64_t GetTail() const
+   {
+      return m_tail.load(std::memory_order_acquire);
+   }
+
+   uint64_t GetOffset(uint64_t p_position) const
+   {
+      return p_position % m_capacity;
+   }
+
+ private:
+   uint64_t m_capacity = 0u;
+
+   std::atomic_uint64_t m_head = 0u;
+   std::atomic_uint64_t m_tail = 0u;
+};
+
+} // namespace Render
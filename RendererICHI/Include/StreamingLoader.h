@@ -0,0 +1,101 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include <Std/string.h>
+#include <Std/vector.h>
+
+#include <AsyncUploadQueueInterface.h>
+#include <RenderResource.h>
+
+namespace Render
+{
+
+class Buffer;
+
+struct StreamingLoaderDescriptor
+{
+   // Size of the chunks that are copied from the file mapping into the staging memory
+   uint64_t m_chunkSizeInBytes = 4u * 1024u * 1024u;
+   // Bytes that can be staged before the loader waits for the oldest chunk to be uploaded. Bounds the staging memory, and the
+   // resident pages of the file mappings, that are used by the loader
+   uint64_t m_maxBytesInFlight = 32u * 1024u * 1024u;
+   // Amount of chunks that are read ahead of the chunk that is being copied
+   uint32_t m_readaheadChunkCount = 2u;
+   // Streamed data isn't needed within the frame, it's limited by the background budget of the AsyncUploadQueue by default
+   UploadPriority m_priority = UploadPriority::Background;
+   // Time a chunk waits for the frame budget, or the staging memory, before the loader submits the pending uploads itself
+   uint64_t m_flushTimeoutInNanoSeconds = 2u * 1000u * 1000u;
+   // The loading thread is the thread that calls AsyncUploadQueueInterface::Flush. A chunk that times out flushes the queue,
+   // which starts the next budget frame early. Otherwise it only submits the pending uploads, and waits for the next frame
+   bool m_callsFlush = false;
+};
+
+// Streams a range of a file into a Buffer
+struct StreamingBufferLoadRequest
+{
+   Std::string m_path;
+   uint64_t m_fileOffsetInBytes = 0u;
+   // Loads until the end of the file by default
+   uint64_t m_sizeInBytes = static_cast<uint64_t>(-1);
+
+   Ptr<Buffer> m_destBuffer = nullptr;
+   uint64_t m_destOffsetInBytes = 0u;
+};
+
+// Streams the regions of an Image from a file. The source offsets of the regions are relative to m_fileOffsetInBytes, and the
+// source data of m_imageUploadRequest is ignored
+struct StreamingImageLoadRequest
+{
+   Std::string m_path;
+   uint64_t m_fileOffsetInBytes = 0u;
+
+   ImageUploadRequest m_imageUploadRequest;
+};
+
+// Loads asset data by memory mapping the files, and copying the pages straight from the mapping into the staging memory of the
+// AsyncUploadQueue. The file is never fully resident in host memory, the pages of a chunk are released once it's staged. A
+// StreamingLoader is meant to be used by a single loading thread. That thread may also be the one that calls Flush, see
+// StreamingLoaderDescriptor::m_callsFlush.
+class StreamingLoader
+{
+   struct InFlightChunk
+   {
+      UploadTicket m_uploadTicket;
+      uint64_t m_sizeInBytes = 0u;
+   };
+
+ public:
+   StreamingLoader() = delete;
+   StreamingLoader(StreamingLoaderDescriptor&& p_desc);
+   ~StreamingLoader() = default;
+
+   // Queues the upload of the file range, returns the UploadTicket of the last chunk
+   UploadTicket LoadBuffer(const StreamingBufferLoadRequest& p_request);
+
+   // Queues the upload of all the regions, the regions are staged with a single request to transition the Image once
+   UploadTicket LoadImage(const StreamingImageLoadRequest& p_request);
+
+   // Waits until all the chunks that were queued by the loader are uploaded
+   void WaitForAll();
+
+   uint64_t GetBytesInFlight() const;
+
+ private:
+   // Drops the completed chunks, and waits for the oldest chunks until p_sizeInBytes fits within the bytes in flight limit
+   void ReserveBytesInFlight(uint64_t p_sizeInBytes);
+
+   // Queues the requests, flushes the AsyncUploadQueue each time the wait for the frame budget or staging memory times out
+   template <typename T>
+   UploadTicket QueueUpload(Std::span<T> p_uploadRequests);
+
+ private:
+   StreamingLoaderDescriptor m_descriptor;
+
+   // Chunks in the order they were queued
+   Std::vector<InFlightChunk> m_inFlightChunks;
+   uint64_t m_bytesInFlight = 0u;
+};
+
+} // namespace Render
@@ -37,7 +37,11 @@ class TimelineSemaphore final : public RenderResource<TimelineSemaphore>
  public:
    VkSemaphore GetTimelineSemaphoreNative() const;
 
-   void WaitForValue(uint64_t p_value);
+   // Waits until the TimelineSemaphore reaches p_value, returns false if the wait timed out
+   bool WaitForValue(uint64_t p_value, uint64_t p_waitInNanoSeconds = static_cast<uint64_t>(-1));
+
+   // Returns the current value of the TimelineSemaphore
+   uint64_t GetCurrentValue() const;
 
  private:
    Render::Ptr<VulkanDevice> m_vulkanDevice;
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+namespace Render
+{
+
+// Codec of compressed upload payloads. Payloads are split in independent blocks, which allows the AsyncUploadQueue to decompress
+// the blocks of a request in parallel
+class UploadCodecInterface
+{
+ public:
+   UploadCodecInterface() = default;
+   virtual ~UploadCodecInterface() = default;
+
+   // Decompresses a single block into p_destData, the decompressed size is known up front. Returns false if the block is
+   // corrupt. Called concurrently from multiple workers, implementations can't have mutable state
+   virtual bool DecompressBlock(const uint8_t* p_compressedData, uint64_t p_compressedSizeInBytes, uint8_t* p_destData,
+                                uint64_t p_decompressedSizeInBytes) const = 0;
+};
+
+} // namespace Render
@@ -2,10 +2,12 @@
 
 #include <inttypes.h>
 #include <stdbool.h>
+#include <mutex>
 
 #include <vulkan/vulkan.h>
 
 #include <Std/span.h>
+#include <Std/unique_ptr.h>
 #include <Std/vector.h>
 #include <Std/unordered_map.h>
 
@@ -151,6 +153,9 @@ class VulkanDevice : public RenderResource<VulkanDevice>
    // Returns whether the Device is a discrete GPU
    bool IsDiscreteGpu() const;
 
+   // Returns the properties of the PhysicalDevice
+   const VkPhysicalDeviceProperties& GetPhysicalDeviceProperties() const;
+
    // Get the PhysicalDevice
    VkPhysicalDevice GetPhysicalDeviceNative() const;
 
@@ -173,14 +178,39 @@ class VulkanDevice : public RenderResource<VulkanDevice>
    uint32_t GetCompuateQueueFamilyIndex() const;
    uint32_t GetTransferQueueFamilyIndex() const;
 
+   // Returns the QueueFamily index of the Queue that executes p_queueType
+   uint32_t GetQueueFamilyIndex(QueueFamilyType p_queueType) const;
+
+   // Resources that are written by the Transfer Queue need a QueueFamily ownership transfer before the Graphics Queue uses them.
+   // False when the Compute Queue has its own QueueFamily as well, the Transfer Queue can only release to one of them
+   bool HasDedicatedTransferQueueFamily() const;
+
+   // Whether Buffers can be created with the ShaderDeviceAddress usage
+   bool IsBufferDeviceAddressSupported() const;
+
+   // Whether VK_EXT_external_memory_host is enabled, which allows Buffers to be backed by host allocations of the process
+   bool IsExternalMemoryHostEnabled() const;
+
+   // Host pointers and sizes that are imported must be a multiple of this alignment
+   uint64_t GetMinImportedHostPointerAlignment() const;
+
+   // Whether the host memory range can be imported, it has to be aligned, and be a host allocation the device can access
+   bool CanImportHostMemory(const void* p_hostPointer, uint64_t p_size) const;
+
    // Returns the SwapchainSupportDetail of this device
    const SurfaceProperties& GetSurfaceProperties() const;
 
    // TODO: Not sure if this is necessary
    const uint32_t GetPresentQueueFamilyIndex() const;
 
+   // Memory of Buffers with the ShaderDeviceAddress usage has to be allocated with p_deviceAddress set
    eastl::tuple<VkDeviceMemory, uint64_t> AllocateDeviceMemory(VkMemoryRequirements p_memoryRequirements,
-                                                               MemoryPropertyFlags p_memoryProperties);
+                                                               MemoryPropertyFlags p_memoryProperties,
+                                                               bool p_deviceAddress = false);
+
+   // Imports p_memoryRequirements.size bytes of host memory at p_hostPointer as device memory, the host memory needs to outlive
+   // the device memory. Returns VK_NULL_HANDLE if the host memory can't be imported
+   VkDeviceMemory ImportHostMemory(VkMemoryRequirements p_memoryRequirements, const void* p_hostPointer);
 
    void QueueSubmit(QueueFamilyType p_executingQueueType, Std::span<Ptr<CommandBuffer>> p_commandBuffers,
                     Std::span<SemaphoreSubmitInfo> p_waitSemaphores,
@@ -223,6 +253,11 @@ class VulkanDevice : public RenderResource<VulkanDevice>
    VkPhysicalDeviceVulkan12Features m_supportedVulkan12Features = {};
    VkPhysicalDeviceFeatures2 m_deviceFeatures = {};
 
+   // VK_EXT_external_memory_host
+   bool m_externalMemoryHostEnabled = false;
+   uint64_t m_minImportedHostPointerAlignment = 0u;
+   PFN_vkGetMemoryHostPointerPropertiesEXT m_getMemoryHostPointerProperties = nullptr;
+
    // The PhysicalDevice's QueueFamilyProperties
    Std::vector<QueueFamily> m_queueFamilyArray;
 
@@ -240,6 +275,9 @@ class VulkanDevice : public RenderResource<VulkanDevice>
 
    // QueueFamilyHandle -> Queues
    Std::unordered_map<QueueFamilyHandle, VkQueue, QueueFamilyHandle> m_queues;
+   // Submits and presents to a Queue have to be externally synchronized, the types of Queues can share the same Queue. Created
+   // with the Queues, the map isn't modified afterwards
+   Std::unordered_map<QueueFamilyHandle, Std::unique_ptr<std::mutex>, QueueFamilyHandle> m_queueMutexes;
 
    // Surface properties for the Device
    SurfaceProperties m_surfaceProperties;
@@ -0,0 +1,246 @@
+#include "AsyncReadbackQueue.h"
+
+#include <EASTL/algorithm.h>
+
+#include <Util/Util.h>
+
+#include <Buffer.h>
+#include <BufferView.h>
+#include <CommandBuffer.h>
+#include <TimelineSemaphore.h>
+#include <VulkanDevice.h>
+
+namespace Render
+{
+AsyncReadbackQueue::AsyncReadbackQueue(AsyncReadbackQueueDescriptor&& p_desc)
+{
+   m_descriptor = p_desc;
+
+   // Create the readback buffer, cached memory makes reading it back on the CPU fast
+   BufferDescriptor bufferDescriptor;
+   bufferDescriptor.m_vulkanDevice = m_descriptor.m_vulkanDevice;
+   bufferDescriptor.m_bufferSize = ReadbackSizeInBytes;
+   bufferDescriptor.m_memoryProperties = Foundation::Util::SetFlags<MemoryPropertyFlags>(
+       Foundation::Util::SetFlags<MemoryPropertyFlags>(MemoryPropertyFlags::HostVisible, MemoryPropertyFlags::HostCoherent),
+       MemoryPropertyFlags::HostCached);
+   bufferDescriptor.m_bufferUsageFlags = BufferUsageFlags::TransferDestination;
+   m_readbackBuffer = Buffer::CreateInstance(eastl::move(bufferDescriptor));
+   m_readbackBuffer->SetName("AsyncReadbackQueue Readback Buffer");
+
+   // Map data of the readback buffer, it stays mapped for the lifetime of the AsyncReadbackQueue
+   m_readbackMappedData = static_cast<const uint8_t*>(m_readbackBuffer->Map(0u));
+
+   m_allocator.Init(ReadbackSizeInBytes);
+
+   TimelineSemaphoreDescriptor timelineSemaphoreDesc;
+   timelineSemaphoreDesc.m_vulkanDevice = m_descriptor.m_vulkanDevice;
+   timelineSemaphoreDesc.m_initailValue = 0u;
+   m_timelineSemaphore = TimelineSemaphore::CreateInstance(eastl::move(timelineSemaphoreDesc));
+}
+
+AsyncReadbackQueue::~AsyncReadbackQueue()
+{
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      // Pending readbacks are still submitted, the callbacks might rely on them
+      FlushInternal();
+      m_timelineSemaphore->WaitForValue(m_submittedValue);
+      UpdateInternal();
+   }
+
+   m_readbackBuffer->Unmap();
+}
+
+ReadbackTicket AsyncReadbackQueue::QueueReadback(Ptr<BufferView> p_bufferView, uint64_t p_offsetInBytes, uint64_t p_sizeInBytes,
+                                                 ReadbackCallback p_callback /*= nullptr*/)
+{
+   ASSERT(p_sizeInBytes > 0u, "Nothing to read back");
+   ASSERT(p_sizeInBytes <= ReadbackSizeInBytes, "Readback doesn't fit in the readback buffer");
+   ASSERT(p_bufferView->IsWholeView() || p_offsetInBytes + p_sizeInBytes <= p_bufferView->GetViewRange(),
+          "Readback range is out of the bounds of the BufferView");
+
+   std::lock_guard<std::mutex> lock(m_mutex);
+
+   StagingRingAllocator::Reservation reservation;
+   while (!m_allocator.Reserve(p_sizeInBytes, ReadbackAlignment, reservation))
+   {
+      // The ring is full, wait for the oldest readback. Readbacks are retired in order, so it has to be released for the
+      // space to become available. An empty ring restarts, and fits any readback up to its size, so there is always a readback
+      // to wait for
+      ASSERT(!m_readbacks.empty(), "The readback buffer is empty, but the readback doesn't fit");
+      FlushInternal();
+
+      const Readback& oldestReadback = m_readbacks.front();
+      ASSERT(oldestReadback.m_released || oldestReadback.m_callback,
+             "The readback buffer is full, and the oldest readback isn't released");
+      m_timelineSemaphore->WaitForValue(oldestReadback.m_timelineValue);
+      UpdateInternal();
+   }
+
+   const uint64_t readbackId = m_nextReadbackId++;
+   m_readbacks.push_back(Readback{.m_readbackId = readbackId,
+                                  .m_reservation = reservation,
+                                  .m_sizeInBytes = p_sizeInBytes,
+                                  .m_callback = eastl::move(p_callback)});
+
+   m_pendingCopies.push_back(
+       PendingCopy{.m_srcBuffer = p_bufferView->GetBuffer(),
+                   .m_copyRegion = BufferCopyRegion{.m_srcOffset = p_bufferView->GetOffsetFromBase() + p_offsetInBytes,
+                                                    .m_destOffset = m_allocator.GetOffset(reservation.m_start),
+                                                    .m_size = p_sizeInBytes}});
+
+   // All the pending copies are part of the next submit
+   return ReadbackTicket{.m_timelineSemaphore = m_timelineSemaphore, .m_value = m_submittedValue + 1u, .m_readbackId = readbackId};
+}
+
+void AsyncReadbackQueue::Flush()
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   FlushInternal();
+}
+
+void AsyncReadbackQueue::Update()
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   UpdateInternal();
+}
+
+bool AsyncReadbackQueue::IsReadbackComplete(const ReadbackTicket& p_readbackTicket)
+{
+   ASSERT(p_readbackTicket.m_timelineSemaphore == m_timelineSemaphore, "ReadbackTicket wasn't created by this AsyncReadbackQueue");
+
+   std::lock_guard<std::mutex> lock(m_mutex);
+   return p_readbackTicket.m_value <= m_submittedValue && m_timelineSemaphore->GetCurrentValue() >= p_readbackTicket.m_value;
+}
+
+void AsyncReadbackQueue::WaitForReadback(const ReadbackTicket& p_readbackTicket)
+{
+   ASSERT(p_readbackTicket.m_timelineSemaphore == m_timelineSemaphore, "ReadbackTicket wasn't created by this AsyncReadbackQueue");
+
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (p_readbackTicket.m_value > m_submittedValue)
+      {
+         FlushInternal();
+      }
+   }
+
+   m_timelineSemaphore->WaitForValue(p_readbackTicket.m_value);
+}
+
+Std::span<const uint8_t> AsyncReadbackQueue::GetReadbackData(const ReadbackTicket& p_readbackTicket)
+{
+   ASSERT(IsReadbackComplete(p_readbackTicket), "Readback isn't complete yet");
+
+   std::lock_guard<std::mutex> lock(m_mutex);
+
+   const Readback& readback = FindReadback(p_readbackTicket.m_readbackId);
+   ASSERT(!readback.m_released, "Readback is already released");
+   return Std::span<const uint8_t>(m_readbackMappedData + m_allocator.GetOffset(readback.m_reservation.m_start),
+                                   readback.m_sizeInBytes);
+}
+
+void AsyncReadbackQueue::ReleaseReadback(const ReadbackTicket& p_readbackTicket)
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+
+   Readback& readback = FindReadback(p_readbackTicket.m_readbackId);
+   ASSERT(!readback.m_callback, "Readbacks with a callback are released automatically");
+   readback.m_released = true;
+}
+
+void AsyncReadbackQueue::FlushInternal()
+{
+   if (m_pendingCopies.empty())
+   {
+      return;
+   }
+
+   const uint64_t timelineValue = ++m_submittedValue;
+
+   CommandBufferDescriptor commandBufferDesc;
+   commandBufferDesc.m_vulkanDevice = m_descriptor.m_vulkanDevice;
+   commandBufferDesc.m_queueType = m_descriptor.m_queueType;
+   Ptr<CommandBuffer> commandBuffer = CommandBuffer::CreateInstance(eastl::move(commandBufferDesc));
+
+   // Make the writes of the work that was submitted before available to the copies
+   commandBuffer->PipelineBarrier()->AddMemoryBarrier(VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_WRITE_BIT,
+                                                      VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT);
+
+   for (PendingCopy& pendingCopy : m_pendingCopies)
+   {
+      Std::vector<BufferCopyRegion> copyBufferRegions{pendingCopy.m_copyRegion};
+      commandBuffer->CopyBuffer(pendingCopy.m_srcBuffer, m_readbackBuffer, copyBufferRegions);
+   }
+   m_pendingCopies.clear();
+
+   // Make the copies visible to the host
+   commandBuffer->PipelineBarrier()->AddMemoryBarrier(VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                                                      VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_READ_BIT);
+
+   commandBuffer->Compile();
+
+   for (Readback& readback : m_readbacks)
+   {
+      if (readback.m_timelineValue == 0u)
+      {
+         readback.m_timelineValue = timelineValue;
+      }
+   }
+
+   Std::vector<Ptr<CommandBuffer>> commandBuffers{commandBuffer};
+   TimelineSemaphoreSubmitInfo signalTimelineSemaphore{.m_timelineSemaphore = m_timelineSemaphore,
+                                                       .p_waitOrSignalValue = timelineValue,
+                                                       .m_stageMask = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT};
+   Std::vector<TimelineSemaphoreSubmitInfo> signalTimelineSemaphores{signalTimelineSemaphore};
+   m_descriptor.m_vulkanDevice->QueueSubmit(m_descriptor.m_queueType, commandBuffers, {}, {}, {}, signalTimelineSemaphores, {});
+}
+
+void AsyncReadbackQueue::UpdateInternal()
+{
+   // Query the TimelineSemaphore once, all the readbacks up until that value are complete
+   const uint64_t completedValue = m_timelineSemaphore->GetCurrentValue();
+
+   for (Readback& readback : m_readbacks)
+   {
+      if (readback.m_timelineValue == 0u || readback.m_timelineValue > completedValue)
+      {
+         break;
+      }
+
+      if (readback.m_callback && !readback.m_released)
+      {
+         readback.m_callback(Std::span<const uint8_t>(m_readbackMappedData + m_allocator.GetOffset(readback.m_reservation.m_start),
+                                                      readback.m_sizeInBytes));
+         readback.m_released = true;
+      }
+   }
+
+   // Retire the released readbacks in order, stop at the first one that is still in use. Readbacks can be released before they
+   // complete, the GPU might still write to them
+   uint32_t retiredCount = 0u;
+   for (const Readback& readback : m_readbacks)
+   {
+      if (!readback.m_released || readback.m_timelineValue == 0u || readback.m_timelineValue > completedValue)
+      {
+         break;
+      }
+
+      m_allocator.Retire(readback.m_reservation.m_end);
+      retiredCount++;
+   }
+
+   m_readbacks.erase(m_readbacks.begin(), m_readbacks.begin() + retiredCount);
+}
+
+AsyncReadbackQueue::Readback& AsyncReadbackQueue::FindReadback(uint64_t p_readbackId)
+{
+   // Readbacks are ordered by their id
+   auto readbackIt = eastl::lower_bound(m_readbacks.begin(), m_readbacks.end(), p_readbackId,
+                                        [](const Readback& p_readback, uint64_t p_id) { return p_readback.m_readbackId < p_id; });
+   ASSERT(readbackIt != m_readbacks.end() && readbackIt->m_readbackId == p_readbackId, "Readback is already retired");
+   return *readbackIt;
+}
+
+} // namespace Render
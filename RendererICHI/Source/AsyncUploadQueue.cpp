@@ -1,128 +1,1341 @@
 #include "AsyncUploadQueue.h"
 
+#include <chrono>
+#include <numeric>
+
+#include <EASTL/algorithm.h>
+#include <EASTL/sort.h>
+
 #include <Util/Util.h>
 
 #include <Buffer.h>
 #include <CommandBuffer.h>
-#include <Fence.h>
+#include <Image.h>
+#include <TimelineSemaphore.h>
+#include <UploadCodec.h>
 #include <VulkanDevice.h>
 
 namespace Render
 {
+
+namespace
+{
+namespace Internal
+{
+// Size of a single region when its rows are tightly packed
+uint64_t GetPackedRegionSize(const ImageUploadRequest& p_request, const ImageUploadRegion& p_region)
+{
+   const uint64_t blocksPerRow = (p_region.m_imageExtent.width + p_request.m_texelBlockWidth - 1u) / p_request.m_texelBlockWidth;
+   const uint64_t rowCount = (p_region.m_imageExtent.height + p_request.m_texelBlockHeight - 1u) / p_request.m_texelBlockHeight;
+   return blocksPerRow * p_request.m_texelBlockSizeInBytes * rowCount * p_region.m_imageExtent.depth * p_region.m_layerCount;
+}
+
+// Staging offsets of buffer to image copies must be a multiple of the texel block size and 4, and preferably of the optimal
+// alignment of the device
+uint64_t GetStagingAlignment(const ImageUploadRequest& p_request, uint64_t p_optimalAlignment)
+{
+   const uint64_t blockAlignment = std::lcm(static_cast<uint64_t>(p_request.m_texelBlockSizeInBytes), static_cast<uint64_t>(4u));
+   return std::lcm(p_optimalAlignment, blockAlignment);
+}
+
+// Adds the copies of the region to p_copyRanges, rows are repacked tightly if the source has a row pitch
+void PackRegion(const ImageUploadRequest& p_request, const ImageUploadRegion& p_region, uint8_t* p_destData,
+                Std::vector<StagingCopy::CopyRange>& p_copyRanges)
+{
+   const uint64_t blocksPerRow = (p_region.m_imageExtent.width + p_request.m_texelBlockWidth - 1u) / p_request.m_texelBlockWidth;
+   const uint64_t packedRowPitch = blocksPerRow * p_request.m_texelBlockSizeInBytes;
+   const uint64_t sourceRowPitch = p_region.m_sourceRowPitchInBytes == 0u ? packedRowPitch : p_region.m_sourceRowPitchInBytes;
+   ASSERT(sourceRowPitch >= packedRowPitch, "Row pitch of the source data is smaller than a row");
+
+   const uint8_t* sourceData = static_cast<const uint8_t*>(p_request.m_sourceData) + p_region.m_sourceOffsetInBytes;
+   const uint64_t packedSize = GetPackedRegionSize(p_request, p_region);
+   if (sourceRowPitch == packedRowPitch)
+   {
+      p_copyRanges.push_back(StagingCopy::CopyRange{.m_dest = p_destData, .m_source = sourceData, .m_size = packedSize});
+      return;
+   }
+
+   for (uint64_t packedOffset = 0u; packedOffset < packedSize; packedOffset += packedRowPitch)
+   {
+      p_copyRanges.push_back(
+          StagingCopy::CopyRange{.m_dest = p_destData + packedOffset, .m_source = sourceData, .m_size = packedRowPitch});
+      sourceData += sourceRowPitch;
+   }
+}
+
+// Range from the lowest to the highest mip level and array layer that the regions of the request copy to
+VkImageSubresourceRange GetUploadSubresourceRange(const ImageUploadRequest& p_request)
+{
+   uint32_t minMipLevel = UINT32_MAX;
+   uint32_t maxMipLevel = 0u;
+   uint32_t minArrayLayer = UINT32_MAX;
+   uint32_t maxArrayLayer = 0u;
+   for (const ImageUploadRegion& region : p_request.m_regions)
+   {
+      minMipLevel = eastl::min(minMipLevel, region.m_mipLevel);
+      maxMipLevel = eastl::max(maxMipLevel, region.m_mipLevel);
+      minArrayLayer = eastl::min(minArrayLayer, region.m_baseArrayLayer);
+      maxArrayLayer = eastl::max(maxArrayLayer, region.m_baseArrayLayer + region.m_layerCount - 1u);
+   }
+
+   return VkImageSubresourceRange{.aspectMask = p_request.m_aspectMask,
+                                  .baseMipLevel = minMipLevel,
+                                  .levelCount = maxMipLevel - minMipLevel + 1u,
+                                  .baseArrayLayer = minArrayLayer,
+                                  .layerCount = maxArrayLayer - minArrayLayer + 1u};
+}
+
+bool DestRangesOverlap(const BufferCopyRegion& p_lhs, const BufferCopyRegion& p_rhs)
+{
+   return p_lhs.m_destOffset < p_rhs.m_destOffset + p_rhs.m_size && p_rhs.m_destOffset < p_lhs.m_destOffset + p_lhs.m_size;
+}
+
+// Appends the region, or extends the last region if both its source and destination ranges continue the last region
+void AppendCopyRegion(Std::vector<BufferCopyRegion>& p_copyRegions, const BufferCopyRegion& p_copyRegion)
+{
+   if (!p_copyRegions.empty())
+   {
+      BufferCopyRegion& lastCopyRegion = p_copyRegions.back();
+      if (lastCopyRegion.m_srcOffset + lastCopyRegion.m_size == p_copyRegion.m_srcOffset &&
+          lastCopyRegion.m_destOffset + lastCopyRegion.m_size == p_copyRegion.m_destOffset)
+      {
+         lastCopyRegion.m_size += p_copyRegion.m_size;
+         return;
+      }
+   }
+   p_copyRegions.push_back(p_copyRegion);
+}
+
+// Records the copies to a single destination Buffer, in the order they were queued. The regions are sorted by destination, and
+// contiguous regions are merged, so they're copied with a single command. Destination regions of a single command can't overlap,
+// if a range is written more than once the copies are split in commands that are recorded in order, with a barrier in between
+void RecordBufferCopies(CommandBuffer* p_commandBuffer, Ptr<Buffer> p_srcBuffer, Ptr<Buffer> p_destBuffer,
+                        Std::span<const BufferCopyRegion> p_copyRegions)
+{
+   Std::vector<BufferCopyRegion> sortedCopyRegions(p_copyRegions.begin(), p_copyRegions.end());
+   eastl::stable_sort(sortedCopyRegions.begin(), sortedCopyRegions.end(),
+                      [](const BufferCopyRegion& p_lhs, const BufferCopyRegion& p_rhs) {
+                         return p_lhs.m_destOffset < p_rhs.m_destOffset;
+                      });
+
+   bool hasOverlap = false;
+   uint64_t destEnd = 0u;
+   for (const BufferCopyRegion& copyRegion : sortedCopyRegions)
+   {
+      hasOverlap |= copyRegion.m_destOffset < destEnd;
+      destEnd = eastl::max(destEnd, copyRegion.m_destOffset + copyRegion.m_size);
+   }
+
+   Std::vector<BufferCopyRegion> mergedCopyRegions;
+   if (!hasOverlap)
+   {
+      for (const BufferCopyRegion& copyRegion : sortedCopyRegions)
+      {
+         AppendCopyRegion(mergedCopyRegions, copyRegion);
+      }
+      p_commandBuffer->CopyBuffer(p_srcBuffer, p_destBuffer, mergedCopyRegions);
+      return;
+   }
+
+   // Ranges that are written more than once are rare, keep the queue order and split the copies where they overlap
+   for (const BufferCopyRegion& copyRegion : p_copyRegions)
+   {
+      const bool overlapsCommand =
+          eastl::any_of(mergedCopyRegions.begin(), mergedCopyRegions.end(),
+                        [&copyRegion](const BufferCopyRegion& p_mergedCopyRegion) {
+                           return DestRangesOverlap(p_mergedCopyRegion, copyRegion);
+                        });
+      if (overlapsCommand)
+      {
+         p_commandBuffer->CopyBuffer(p_srcBuffer, p_destBuffer, mergedCopyRegions);
+         p_commandBuffer->PipelineBarrier()->AddBufferBarrier(
+             VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+             VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, p_destBuffer, 0u, VK_WHOLE_SIZE);
+         mergedCopyRegions.clear();
+      }
+      AppendCopyRegion(mergedCopyRegions, copyRegion);
+   }
+   p_commandBuffer->CopyBuffer(p_srcBuffer, p_destBuffer, mergedCopyRegions);
+}
+}; // namespace Internal
+}; // namespace
+
 AsyncUploadQueue::AsyncUploadQueue(AsyncUploadQueueDescriptor&& p_desc)
 {
    m_descriptor = p_desc;
 
-   const uint64_t totalBufferSize = StagingSizeInBytes + m_allocator.GetOverHeadSize();
-
    // Create the Index staging buffer, and map the index data
    BufferDescriptor bufferDescriptor;
    bufferDescriptor.m_vulkanDevice = m_descriptor.m_vulkanDevice;
-   bufferDescriptor.m_bufferSize = totalBufferSize;
+   bufferDescriptor.m_bufferSize = StagingSizeInBytes;
    bufferDescriptor.m_memoryProperties =
        Foundation::Util::SetFlags<MemoryPropertyFlags>(MemoryPropertyFlags::HostVisible, MemoryPropertyFlags::HostCoherent);
    bufferDescriptor.m_bufferUsageFlags = BufferUsageFlags::TransferSource;
    m_stagingBuffer = Buffer::CreateInstance(eastl::move(bufferDescriptor));
+   m_stagingBuffer->SetName("AsyncUploadQueue Staging Buffer");
+
+   // Map data of the staging buffer, it stays mapped for the lifetime of the AsyncUploadQueue
+   m_stagingMappedData = static_cast<uint8_t*>(m_stagingBuffer->Map(0u));
+
+   m_allocator.Init(StagingSizeInBytes);
 
-   // Map data of the staging buffer, and copy to it
-   void* mappedData = m_stagingBuffer->Map(0u);
+   // The TaskScheduler is initialized by the dispatch thread
+   m_dispatchThread = std::thread(&AsyncUploadQueue::DispatchThreadMain, this);
 
-   m_allocator.Init(mappedData, totalBufferSize);
+   m_frameBudgets.fill(UnlimitedBudget);
+   m_frameBudgets[static_cast<uint32_t>(UploadPriority::Background)] = DefaultBackgroundBudgetInBytes;
+
+   m_optimalBufferCopyOffsetAlignment =
+       m_descriptor.m_vulkanDevice->GetPhysicalDeviceProperties().limits.optimalBufferCopyOffsetAlignment;
+
+   TimelineSemaphoreDescriptor timelineSemaphoreDesc;
+   timelineSemaphoreDesc.m_vulkanDevice = m_descriptor.m_vulkanDevice;
+   timelineSemaphoreDesc.m_initailValue = 0u;
+   m_timelineSemaphore = TimelineSemaphore::CreateInstance(eastl::move(timelineSemaphoreDesc));
 }
 
 AsyncUploadQueue::~AsyncUploadQueue()
 {
-   // Wait till all the staging requests are complete
-   for (StagedRegion& stagedRegion : m_stagingRegions)
+   // Submit the pending uploads, and wait till all the staging requests are complete
+   FlushInternal(false);
+   m_timelineSemaphore->WaitForValue(m_submittedValue.load());
+
+   FreeRegions();
+   ASSERT(m_stagingRegions.empty(), "Not all the staged regions were retired");
+   ASSERT(m_importedSources.empty(), "Not all the imported sources were released");
+
    {
-      stagedRegion.m_stagingFence->WaitForSignal();
+      std::lock_guard<std::mutex> lock(m_dispatchMutex);
+      m_stopDispatchThread = true;
    }
-   m_stagingRegions.clear();
-
-   m_allocator.Destroy();
+   m_dispatchCondition.notify_all();
+   m_dispatchThread.join();
 
    m_stagingBuffer->Unmap();
 }
 
-Ptr<Fence> AsyncUploadQueue::QueueUpload(Std::span<BufferUploadRequest> p_bufferUploadRequests)
+UploadTicket AsyncUploadQueue::QueueUpload(Std::span<BufferUploadRequest> p_bufferUploadRequests, UploadPriority p_priority)
 {
-   FreeRegions();
+   UploadTicket uploadTicket;
+   [[maybe_unused]] const UploadResult result = TryQueueUpload(p_bufferUploadRequests, InfiniteTimeout, uploadTicket, p_priority);
+   ASSERT(result == UploadResult::Queued, "Blocking uploads should always be queued");
 
-   // TODO: Filter out all the buffers that copy host -> host
-   // for (BufferUploadRequest& uploadRequest : p_bufferUploadRequests)
-   //{
-   //}
+   return uploadTicket;
+}
 
-   // Copy to flat source buffer first
-   uint8_t* flatBuffer = nullptr;
+UploadResult AsyncUploadQueue::TryQueueUpload(Std::span<BufferUploadRequest> p_bufferUploadRequests,
+                                              uint64_t p_timeoutInNanoSeconds, UploadTicket& p_uploadTicket,
+                                              UploadPriority p_priority)
+{
+   // Host-visible destinations are written straight into their mapping, and zero-copy requests are copied from their imported
+   // source data. Only the other requests go through the staging memory
+   Std::span<BufferUploadRequest> stagedUploadRequests = p_bufferUploadRequests;
+   Std::vector<BufferUploadRequest> deviceLocalUploadRequests;
+   bool hasHostVisibleRequests = false;
+   bool hasZeroCopyRequests = false;
+   for (BufferUploadRequest& uploadRequest : p_bufferUploadRequests)
+   {
+      ASSERT(!uploadRequest.m_destBuffer->IsShared(), "Buffer is shared by the ImmutableBufferCache, it can't be written");
+      hasHostVisibleRequests |= uploadRequest.m_destBuffer->IsHostVisible();
+      hasZeroCopyRequests |= uploadRequest.m_zeroCopy;
+   }
+
+   Std::unique_ptr<PendingChunk> importedChunk;
+   uint64_t importedSize = 0u;
+   if (hasHostVisibleRequests || hasZeroCopyRequests)
    {
-      uint64_t totalRequiredSize = 0ul;
       for (BufferUploadRequest& uploadRequest : p_bufferUploadRequests)
       {
-         totalRequiredSize += uploadRequest.m_copySizeInBytes;
+         if (uploadRequest.m_destBuffer->IsHostVisible())
+         {
+            continue;
+         }
+
+         PendingCopy importedCopy;
+         if (uploadRequest.m_zeroCopy && uploadRequest.m_copySizeInBytes > 0u && ImportSourceData(uploadRequest, importedCopy))
+         {
+            if (!importedChunk)
+            {
+               importedChunk = Std::unique_ptr<PendingChunk>(new PendingChunk());
+               importedChunk->m_staged = false;
+            }
+            importedChunk->m_copies.push_back(eastl::move(importedCopy));
+            importedSize += uploadRequest.m_copySizeInBytes;
+            continue;
+         }
+
+         deviceLocalUploadRequests.push_back(uploadRequest);
       }
+      stagedUploadRequests = deviceLocalUploadRequests;
+   }
+
+   uint64_t remainingSize = 0ul;
+   for (BufferUploadRequest& uploadRequest : stagedUploadRequests)
+   {
+      remainingSize += uploadRequest.m_copySizeInBytes;
+   }
+   ASSERT(remainingSize > 0u || hasHostVisibleRequests || importedChunk, "Nothing to upload");
 
-      flatBuffer = static_cast<uint8_t*>(m_allocator.Allocate(totalRequiredSize));
+   // Nothing needs to be waited on if all the requests are written by the host
+   p_uploadTicket = UploadTicket{};
 
-      uint64_t offset = 0ul;
-      for (BufferUploadRequest& uploadRequest : p_bufferUploadRequests)
+   // Position of the next byte that needs to be staged
+   uint32_t requestIndex = 0u;
+   uint64_t requestOffset = 0u;
+
+   bool isFirstChunk = true;
+   while (remainingSize > 0u)
+   {
+      const uint64_t chunkSize = eastl::min(remainingSize, static_cast<uint64_t>(StagingChunkSizeInBytes));
+
+      // Only the first chunk can time out, once a chunk is queued all the other chunks have to be queued as well
+      const uint64_t timeout = isFirstChunk ? p_timeoutInNanoSeconds : InfiniteTimeout;
+      PendingChunk* pendingChunk = new PendingChunk();
+      if (!ReserveChunk(p_priority, chunkSize, timeout, pendingChunk->m_reservation))
       {
-         memcpy(offset + flatBuffer, uploadRequest.m_sourceData, uploadRequest.m_copySizeInBytes);
+         delete pendingChunk;
+         return UploadResult::RetryLater;
+      }
+      isFirstChunk = false;
+
+      const uint64_t chunkStagingOffset = m_allocator.GetOffset(pendingChunk->m_reservation.m_start);
+      uint8_t* chunkData = m_stagingMappedData + chunkStagingOffset;
+
+      // Fill the chunk, requests can be split over multiple chunks
+      Std::vector<StagingCopy::CopyRange> copyRanges;
+      uint64_t chunkOffset = 0u;
+      while (chunkOffset < chunkSize)
+      {
+         BufferUploadRequest& uploadRequest = stagedUploadRequests[requestIndex];
+         const uint64_t copySize = eastl::min(uploadRequest.m_copySizeInBytes - requestOffset, chunkSize - chunkOffset);
+
+         if (copySize > 0u)
+         {
+            copyRanges.push_back(
+                StagingCopy::CopyRange{.m_dest = chunkData + chunkOffset,
+                                       .m_source = static_cast<const uint8_t*>(uploadRequest.m_sourceData) + requestOffset,
+                                       .m_size = copySize});
 
-         offset += uploadRequest.m_copySizeInBytes;
+            pendingChunk->m_copies.push_back(
+                PendingCopy{.m_srcBuffer = m_stagingBuffer,
+                            .m_destBuffer = uploadRequest.m_destBuffer,
+                            .m_copyRegion = BufferCopyRegion{.m_srcOffset = chunkStagingOffset + chunkOffset,
+                                                             .m_destOffset = uploadRequest.m_destOffsetInBytes + requestOffset,
+                                                             .m_size = copySize}});
+         }
+
+         chunkOffset += copySize;
+         requestOffset += copySize;
+         if (requestOffset == uploadRequest.m_copySizeInBytes)
+         {
+            requestIndex++;
+            requestOffset = 0u;
+         }
       }
+      remainingSize -= chunkSize;
+      CopyToStaging(copyRanges);
+
+      p_uploadTicket = PushPendingChunk(pendingChunk, chunkSize, p_priority);
+   }
+
+   // The imported copies are queued once the staged requests can't be retried anymore
+   if (importedChunk)
+   {
+      p_uploadTicket = MergeUploadTickets(p_uploadTicket, PushPendingChunk(importedChunk.release(), importedSize, p_priority));
+   }
+
+   // Written after the staged requests are queued, a request that has to be retried doesn't write anything
+   if (hasHostVisibleRequests)
+   {
+      WriteHostVisible(p_bufferUploadRequests);
+   }
+
+   if (p_priority == UploadPriority::Immediate)
+   {
+      FlushInternal(false);
+   }
+
+   return UploadResult::Queued;
+}
+
+UploadTicket AsyncUploadQueue::QueueUpload(Std::span<ImageUploadRequest> p_imageUploadRequests, UploadPriority p_priority)
+{
+   UploadTicket uploadTicket;
+   [[maybe_unused]] const UploadResult result = TryQueueUpload(p_imageUploadRequests, InfiniteTimeout, uploadTicket, p_priority);
+   ASSERT(result == UploadResult::Queued, "Blocking uploads should always be queued");
+
+   return uploadTicket;
+}
+
+UploadResult AsyncUploadQueue::TryQueueUpload(Std::span<ImageUploadRequest> p_imageUploadRequests,
+                                              uint64_t p_timeoutInNanoSeconds, UploadTicket& p_uploadTicket,
+                                              UploadPriority p_priority)
+{
+   bool isFirstChunk = true;
+   uint32_t requestIndex = 0u;
+   uint32_t regionIndex = 0u;
+   while (requestIndex < p_imageUploadRequests.size())
+   {
+      // Gather the regions that fit in the chunk, regions are never split. A single region larger than a chunk gets a chunk of
+      // its own. Every region is aligned individually, reserve the worst case padding.
+      uint64_t reservationSize = 0u;
+      uint32_t endRequestIndex = requestIndex;
+      uint32_t endRegionIndex = regionIndex;
+      while (endRequestIndex < p_imageUploadRequests.size())
+      {
+         const ImageUploadRequest& uploadRequest = p_imageUploadRequests[endRequestIndex];
+         ASSERT(uploadRequest.m_texelBlockSizeInBytes > 0u, "Texel block size must be provided");
+         ASSERT(!uploadRequest.m_regions.empty(), "Nothing to upload");
+
+         const uint64_t alignment = Internal::GetStagingAlignment(uploadRequest, m_optimalBufferCopyOffsetAlignment);
+         const uint64_t regionSize =
+             Internal::GetPackedRegionSize(uploadRequest, uploadRequest.m_regions[endRegionIndex]) + alignment - 1u;
+         ASSERT(regionSize <= StagingSizeInBytes, "A single region can't be larger than the staging buffer");
+         if (reservationSize > 0u && reservationSize + regionSize > StagingChunkSizeInBytes)
+         {
+            break;
+         }
+         reservationSize += regionSize;
+
+         if (++endRegionIndex == uploadRequest.m_regions.size())
+         {
+            endRequestIndex++;
+            endRegionIndex = 0u;
+         }
+      }
+
+      // Only the first chunk can time out, once a chunk is queued all the other chunks have to be queued as well
+      const uint64_t timeout = isFirstChunk ? p_timeoutInNanoSeconds : InfiniteTimeout;
+      PendingChunk* pendingChunk = new PendingChunk();
+      if (!ReserveChunk(p_priority, reservationSize, timeout, pendingChunk->m_reservation))
+      {
+         delete pendingChunk;
+         return UploadResult::RetryLater;
+      }
+      isFirstChunk = false;
+
+      // Pack the regions in the chunk, staging offsets are aligned within the buffer
+      uint64_t stagingOffset = m_allocator.GetOffset(pendingChunk->m_reservation.m_start);
+      Std::vector<StagingCopy::CopyRange> copyRanges;
+      while (requestIndex != endRequestIndex || regionIndex != endRegionIndex)
+      {
+         const ImageUploadRequest& uploadRequest = p_imageUploadRequests[requestIndex];
+         const ImageUploadRegion& uploadRegion = uploadRequest.m_regions[regionIndex];
+
+         // Copies of the same request within a chunk are recorded with a single command
+         if (pendingChunk->m_imageCopies.empty() || regionIndex == 0u)
+         {
+            pendingChunk->m_imageCopies.push_back(PendingImageCopy{.m_destImage = uploadRequest.m_destImage,
+                                                                   .m_subresourceRange =
+                                                                       Internal::GetUploadSubresourceRange(uploadRequest),
+                                                                   .m_oldLayout = uploadRequest.m_oldLayout,
+                                                                   .m_newLayout = uploadRequest.m_newLayout,
+                                                                   .m_transitionBefore = regionIndex == 0u});
+         }
+         PendingImageCopy& pendingImageCopy = pendingChunk->m_imageCopies.back();
+
+         const uint64_t alignment = Internal::GetStagingAlignment(uploadRequest, m_optimalBufferCopyOffsetAlignment);
+         stagingOffset = (stagingOffset + alignment - 1u) / alignment * alignment;
+
+         Internal::PackRegion(uploadRequest, uploadRegion, m_stagingMappedData + stagingOffset, copyRanges);
+         pendingImageCopy.m_copyRegions.push_back(BufferImageCopyRegion{
+             .m_bufferOffset = stagingOffset,
+             .m_imageSubresource = VkImageSubresourceLayers{.aspectMask = uploadRequest.m_aspectMask,
+                                                            .mipLevel = uploadRegion.m_mipLevel,
+                                                            .baseArrayLayer = uploadRegion.m_baseArrayLayer,
+                                                            .layerCount = uploadRegion.m_layerCount},
+             .m_imageOffset = uploadRegion.m_imageOffset,
+             .m_imageExtent = uploadRegion.m_imageExtent});
+         stagingOffset += Internal::GetPackedRegionSize(uploadRequest, uploadRegion);
+
+         if (++regionIndex == uploadRequest.m_regions.size())
+         {
+            pendingImageCopy.m_transitionAfter = true;
+            requestIndex++;
+            regionIndex = 0u;
+         }
+      }
+
+      CopyToStaging(copyRanges);
+
+      p_uploadTicket = PushPendingChunk(pendingChunk, reservationSize, p_priority);
+   }
+
+   if (p_priority == UploadPriority::Immediate)
+   {
+      FlushInternal(false);
+   }
+
+   return UploadResult::Queued;
+}
+
+UploadTicket AsyncUploadQueue::QueueUpload(Std::span<CompressedBufferUploadRequest> p_compressedUploadRequests,
+                                           UploadPriority p_priority)
+{
+   UploadTicket uploadTicket;
+   [[maybe_unused]] const UploadResult result =
+       TryQueueUpload(p_compressedUploadRequests, InfiniteTimeout, uploadTicket, p_priority);
+   ASSERT(result == UploadResult::Queued, "Blocking uploads should always be queued");
+
+   return uploadTicket;
+}
+
+UploadResult AsyncUploadQueue::TryQueueUpload(Std::span<CompressedBufferUploadRequest> p_compressedUploadRequests,
+                                              uint64_t p_timeoutInNanoSeconds, UploadTicket& p_uploadTicket,
+                                              UploadPriority p_priority)
+{
+   bool isFirstChunk = true;
+   uint32_t requestIndex = 0u;
+   uint32_t blockIndex = 0u;
+   // Offset of the next block within the decompressed data of the request
+   uint64_t requestOffset = 0u;
+   while (requestIndex < p_compressedUploadRequests.size())
+   {
+      // Gather the blocks that fit in the chunk, blocks are never split. A single block larger than a chunk gets a chunk of its
+      // own
+      uint64_t reservationSize = 0u;
+      uint32_t endRequestIndex = requestIndex;
+      uint32_t endBlockIndex = blockIndex;
+      while (endRequestIndex < p_compressedUploadRequests.size())
+      {
+         const CompressedBufferUploadRequest& uploadRequest = p_compressedUploadRequests[endRequestIndex];
+         ASSERT(uploadRequest.m_codec, "No codec is provided");
+         ASSERT(!uploadRequest.m_blocks.empty(), "Nothing to upload");
+         ASSERT(!uploadRequest.m_destBuffer->IsShared(), "Buffer is shared by the ImmutableBufferCache, it can't be written");
+
+         const uint64_t blockSize = uploadRequest.m_blocks[endBlockIndex].m_decompressedSizeInBytes;
+         ASSERT(blockSize > 0u, "Blocks can't be empty");
+         ASSERT(blockSize <= CompressedUploadBlock::MaxDecompressedSizeInBytes,
+                "A single block can't be larger than CompressedUploadBlock::MaxDecompressedSizeInBytes");
+         if (reservationSize > 0u && reservationSize + blockSize > StagingChunkSizeInBytes)
+         {
+            break;
+         }
+         reservationSize += blockSize;
+
+         if (++endBlockIndex == uploadRequest.m_blocks.size())
+         {
+            endRequestIndex++;
+            endBlockIndex = 0u;
+         }
+      }
+
+      // Only the first chunk can time out, once a chunk is queued all the other chunks have to be queued as well
+      const uint64_t timeout = isFirstChunk ? p_timeoutInNanoSeconds : InfiniteTimeout;
+      PendingChunk* pendingChunk = new PendingChunk();
+      if (!ReserveChunk(p_priority, reservationSize, timeout, pendingChunk->m_reservation))
+      {
+         delete pendingChunk;
+         return UploadResult::RetryLater;
+      }
+      isFirstChunk = false;
+
+      // Assign the staging memory of every block, the decompressed blocks are laid out after one another
+      const uint64_t chunkStagingOffset = m_allocator.GetOffset(pendingChunk->m_reservation.m_start);
+      uint64_t chunkOffset = 0u;
+      Std::vector<DecompressionJob> decompressionJobs;
+      while (requestIndex != endRequestIndex || blockIndex != endBlockIndex)
+      {
+         const CompressedBufferUploadRequest& uploadRequest = p_compressedUploadRequests[requestIndex];
+         const CompressedUploadBlock& block = uploadRequest.m_blocks[blockIndex];
+
+         decompressionJobs.push_back(DecompressionJob{.m_codec = uploadRequest.m_codec,
+                                                      .m_block = &block,
+                                                      .m_destData = m_stagingMappedData + chunkStagingOffset + chunkOffset});
+
+         // The blocks of a request within a chunk are copied with a single region
+         if (pendingChunk->m_copies.empty() || blockIndex == 0u)
+         {
+            pendingChunk->m_copies.push_back(
+                PendingCopy{.m_srcBuffer = m_stagingBuffer,
+                            .m_destBuffer = uploadRequest.m_destBuffer,
+                            .m_copyRegion = BufferCopyRegion{.m_srcOffset = chunkStagingOffset + chunkOffset,
+                                                             .m_destOffset = uploadRequest.m_destOffsetInBytes + requestOffset,
+                                                             .m_size = 0u}});
+         }
+         pendingChunk->m_copies.back().m_copyRegion.m_size += block.m_decompressedSizeInBytes;
+
+         chunkOffset += block.m_decompressedSizeInBytes;
+         requestOffset += block.m_decompressedSizeInBytes;
+         if (++blockIndex == uploadRequest.m_blocks.size())
+         {
+            requestIndex++;
+            blockIndex = 0u;
+            requestOffset = 0u;
+         }
+      }
+
+      // The copies of the chunk are only submitted once all its blocks are decompressed
+      DecompressToStaging(decompressionJobs);
+
+      p_uploadTicket = PushPendingChunk(pendingChunk, reservationSize, p_priority);
+   }
+
+   if (p_priority == UploadPriority::Immediate)
+   {
+      FlushInternal(false);
+   }
+
+   return UploadResult::Queued;
+}
+
+void AsyncUploadQueue::SetFrameBudget(UploadPriority p_priority, uint64_t p_budgetInBytes)
+{
+   ASSERT(p_priority != UploadPriority::Immediate, "Immediate uploads can't be budgeted");
+   ASSERT(p_priority < UploadPriority::Count, "Invalid UploadPriority");
+
+   {
+      std::lock_guard<std::mutex> lock(m_frameBudgetMutex);
+      m_frameBudgets[static_cast<uint32_t>(p_priority)] = p_budgetInBytes;
+   }
+   m_frameBudgetCondition.notify_all();
+}
+
+void AsyncUploadQueue::Flush()
+{
+   SubmitPendingUploads();
+
+   // Start a new frame, uploads that are waiting for budget can continue
+   {
+      std::lock_guard<std::mutex> lock(m_frameBudgetMutex);
+      m_frameBudgetsUsed.fill(0u);
+   }
+   m_frameBudgetCondition.notify_all();
+}
+
+void AsyncUploadQueue::SubmitPendingUploads()
+{
+   FlushInternal(false);
+   FreeRegions();
+}
+
+bool AsyncUploadQueue::IsUploadComplete(const UploadTicket& p_uploadTicket)
+{
+   // Uploads that were written by the host don't have a ticket
+   if (p_uploadTicket.m_value == 0u)
+   {
+      return true;
+   }
+
+   ASSERT(p_uploadTicket.m_timelineSemaphore == m_timelineSemaphore, "UploadTicket wasn't created by this AsyncUploadQueue");
+
+   return p_uploadTicket.m_value <= m_submittedValue.load(std::memory_order_acquire) &&
+          m_timelineSemaphore->GetCurrentValue() >= p_uploadTicket.m_value;
+}
+
+void AsyncUploadQueue::WaitForUpload(const UploadTicket& p_uploadTicket)
+{
+   if (p_uploadTicket.m_value == 0u)
+   {
+      return;
+   }
+
+   ASSERT(p_uploadTicket.m_timelineSemaphore == m_timelineSemaphore, "UploadTicket wasn't created by this AsyncUploadQueue");
+
+   EnsureSubmitted(p_uploadTicket.m_value);
+   m_timelineSemaphore->WaitForValue(p_uploadTicket.m_value);
+}
+
+void AsyncUploadQueue::FlushUpload(const UploadTicket& p_uploadTicket)
+{
+   if (p_uploadTicket.m_value == 0u)
+   {
+      return;
+   }
+
+   ASSERT(p_uploadTicket.m_timelineSemaphore == m_timelineSemaphore, "UploadTicket wasn't created by this AsyncUploadQueue");
+
+   EnsureSubmitted(p_uploadTicket.m_value);
+}
+
+TimelineSemaphoreSubmitInfo AsyncUploadQueue::GetUploadWaitInfo(const UploadTicket& p_uploadTicket,
+                                                                VkPipelineStageFlags2 p_waitStageMask)
+{
+   ASSERT(p_uploadTicket.m_timelineSemaphore == m_timelineSemaphore, "UploadTicket wasn't created by this AsyncUploadQueue");
+
+   // Flushing here would re-enter FlushInternal from the submit of the upload CommandBuffers
+   ASSERT(p_uploadTicket.m_value <= m_submittedValue.load(std::memory_order_acquire),
+          "The upload isn't submitted, flush it with FlushUpload before the submit");
+   return TimelineSemaphoreSubmitInfo{.m_timelineSemaphore = p_uploadTicket.m_timelineSemaphore,
+                                      .p_waitOrSignalValue = p_uploadTicket.m_value,
+                                      .m_stageMask = p_waitStageMask};
+}
+
+void AsyncUploadQueue::CopyToStaging(Std::span<const StagingCopy::CopyRange> p_copyRanges)
+{
+   uint64_t totalSize = 0u;
+   for (const StagingCopy::CopyRange& copyRange : p_copyRanges)
+   {
+      totalSize += copyRange.m_size;
+   }
+
+   // Small copies don't need the workers, copy them on the calling thread without contending for the TaskScheduler
+   if (totalSize < StagingCopy::ParallelCopyThresholdInBytes)
+   {
+      StagingCopy::ParallelStreamingCopy(nullptr, p_copyRanges);
+      return;
    }
 
+   RunOnDispatchThread([this, p_copyRanges]() { StagingCopy::ParallelStreamingCopy(&m_taskScheduler, p_copyRanges); });
+}
+
+void AsyncUploadQueue::RunOnDispatchThread(const eastl::function<void()>& p_work)
+{
+   // The dispatch thread runs one piece of work at a time
+   std::lock_guard<std::mutex> lock(m_copyMutex);
+
+   std::unique_lock<std::mutex> dispatchLock(m_dispatchMutex);
+   m_dispatchWork = &p_work;
+   m_dispatchCondition.notify_all();
+   m_dispatchCondition.wait(dispatchLock, [this]() { return m_dispatchWork == nullptr; });
+}
+
+void AsyncUploadQueue::DispatchThreadMain()
+{
+   // The thread that initializes the TaskScheduler is its thread 0, the workers are numbered after it
+   m_taskScheduler.Initialize(m_descriptor.m_workerThreadCount + 1u);
+   m_decompressionScratch.resize(m_taskScheduler.GetNumTaskThreads());
+
+   std::unique_lock<std::mutex> lock(m_dispatchMutex);
+   while (true)
+   {
+      m_dispatchCondition.wait(lock, [this]() { return m_dispatchWork != nullptr || m_stopDispatchThread; });
+      if (!m_dispatchWork)
+      {
+         break;
+      }
+
+      (*m_dispatchWork)();
+      m_dispatchWork = nullptr;
+      m_dispatchCondition.notify_all();
+   }
+   lock.unlock();
+
+   m_taskScheduler.WaitforAllAndShutdown();
+}
+
+void AsyncUploadQueue::WriteHostVisible(Std::span<BufferUploadRequest> p_bufferUploadRequests)
+{
+   Std::vector<StagingCopy::CopyRange> copyRanges;
+   for (BufferUploadRequest& uploadRequest : p_bufferUploadRequests)
+   {
+      if (uploadRequest.m_destBuffer->IsHostVisible() && uploadRequest.m_copySizeInBytes > 0u)
+      {
+         void* destData = uploadRequest.m_destBuffer->Map(uploadRequest.m_destOffsetInBytes, uploadRequest.m_copySizeInBytes);
+         copyRanges.push_back(StagingCopy::CopyRange{
+             .m_dest = destData, .m_source = uploadRequest.m_sourceData, .m_size = uploadRequest.m_copySizeInBytes});
+      }
+   }
+
+   CopyToStaging(copyRanges);
+
+   for (BufferUploadRequest& uploadRequest : p_bufferUploadRequests)
+   {
+      if (uploadRequest.m_destBuffer->IsHostVisible() && uploadRequest.m_copySizeInBytes > 0u)
+      {
+         uploadRequest.m_destBuffer->FlushMappedRange(uploadRequest.m_destOffsetInBytes, uploadRequest.m_copySizeInBytes);
+         uploadRequest.m_destBuffer->Unmap();
+      }
+   }
+}
+
+bool AsyncUploadQueue::ImportSourceData(const BufferUploadRequest& p_uploadRequest, PendingCopy& p_pendingCopy)
+{
+   Ptr<VulkanDevice> vulkanDevice = m_descriptor.m_vulkanDevice;
+   const uint64_t alignment = vulkanDevice->GetMinImportedHostPointerAlignment();
+   if (!vulkanDevice->IsExternalMemoryHostEnabled() || alignment > MaxZeroCopyImportAlignment)
+   {
+      return false;
+   }
+
+   // Import the pages that contain the source data, the copy starts at the offset of the source data within the first page
+   const uintptr_t sourceAddress = reinterpret_cast<uintptr_t>(p_uploadRequest.m_sourceData);
+   const uintptr_t importAddress = sourceAddress / alignment * alignment;
+   const uint64_t importSize =
+       (sourceAddress - importAddress + p_uploadRequest.m_copySizeInBytes + alignment - 1u) / alignment * alignment;
+   if (!vulkanDevice->CanImportHostMemory(reinterpret_cast<const void*>(importAddress), importSize))
+   {
+      return false;
+   }
+
+   BufferDescriptor bufferDescriptor;
+   bufferDescriptor.m_vulkanDevice = vulkanDevice;
+   bufferDescriptor.m_bufferSize = importSize;
+   bufferDescriptor.m_bufferUsageFlags = BufferUsageFlags::TransferSource;
+   bufferDescriptor.m_queueFamilyAccess = QueueFamilyTypeFlags::TransferQueue;
+   // If the import fails, the Buffer falls back to host visible memory. Its initial data is written through the mapping, the
+   // fallback doesn't stage or flush while this upload is being queued
+   bufferDescriptor.m_memoryProperties =
+       Foundation::Util::SetFlags<MemoryPropertyFlags>(MemoryPropertyFlags::HostVisible, MemoryPropertyFlags::HostCoherent);
+   bufferDescriptor.m_importedHostData = reinterpret_cast<const void*>(importAddress);
+   Ptr<Buffer> importedBuffer = Buffer::CreateInstance(eastl::move(bufferDescriptor));
+
+   // The fallback copied the whole imported range for nothing, stage the request instead
+   if (!importedBuffer->IsImportedHostMemory())
+   {
+      return false;
+   }
+   importedBuffer->SetName("AsyncUploadQueue Imported Source Buffer");
+
+   // The copy keeps the Buffer alive until the flush that records it is complete
+   p_pendingCopy = PendingCopy{.m_srcBuffer = importedBuffer,
+                               .m_destBuffer = p_uploadRequest.m_destBuffer,
+                               .m_copyRegion = BufferCopyRegion{.m_srcOffset = sourceAddress - importAddress,
+                                                                .m_destOffset = p_uploadRequest.m_destOffsetInBytes,
+                                                                .m_size = p_uploadRequest.m_copySizeInBytes}};
+   return true;
+}
+
+void AsyncUploadQueue::DecompressToStaging(Std::span<const DecompressionJob> p_decompressionJobs)
+{
+   enki::TaskSet decompressionTask(
+       static_cast<uint32_t>(p_decompressionJobs.size()), [&](enki::TaskSetPartition p_range, uint32_t p_threadNum) {
+          // Tasks are only added by the dispatch thread, p_threadNum is always a thread that is owned by the TaskScheduler
+          ASSERT(p_threadNum < m_decompressionScratch.size(), "Thread isn't owned by the TaskScheduler");
+          Std::vector<uint8_t>& scratch = m_decompressionScratch[p_threadNum];
+          for (uint32_t i = p_range.start; i < p_range.end; i++)
+          {
+             const DecompressionJob& decompressionJob = p_decompressionJobs[i];
+             const CompressedUploadBlock& block = *decompressionJob.m_block;
+             if (scratch.size() < block.m_decompressedSizeInBytes)
+             {
+                scratch.resize(block.m_decompressedSizeInBytes);
+             }
+
+             [[maybe_unused]] const bool decompressed = decompressionJob.m_codec->DecompressBlock(
+                 static_cast<const uint8_t*>(block.m_compressedData), block.m_compressedSizeInBytes, scratch.data(),
+                 block.m_decompressedSizeInBytes);
+             ASSERT(decompressed, "Failed to decompress a block, the block is corrupt");
+
+             StagingCopy::StreamingCopy(decompressionJob.m_destData, scratch.data(), block.m_decompressedSizeInBytes);
+          }
+       });
+
+   RunOnDispatchThread([this, &decompressionTask]() {
+      m_taskScheduler.AddTaskSetToPipe(&decompressionTask);
+      m_taskScheduler.WaitforTask(&decompressionTask);
+   });
+}
+
+void AsyncUploadQueue::EnsureSubmitted(uint64_t p_value)
+{
+   // The value might belong to a flush that hasn't consumed the chunk yet, force flushes until it's submitted
+   while (p_value > m_submittedValue.load(std::memory_order_acquire))
+   {
+      FlushInternal(true);
+   }
+}
+
+bool AsyncUploadQueue::ReserveChunk(UploadPriority p_priority, uint64_t p_size, uint64_t p_timeoutInNanoSeconds,
+                                    StagingRingAllocator::Reservation& p_reservation)
+{
+   const auto startTime = std::chrono::steady_clock::now();
+
+   if (!AcquireFrameBudget(p_priority, p_size, p_timeoutInNanoSeconds))
+   {
+      return false;
+   }
+
+   // The staging memory gets what is left of the timeout
+   uint64_t remainingTimeout = InfiniteTimeout;
+   if (p_timeoutInNanoSeconds != InfiniteTimeout)
+   {
+      const uint64_t elapsed = static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count());
+      remainingTimeout = p_timeoutInNanoSeconds - eastl::min(elapsed, p_timeoutInNanoSeconds);
+   }
+
+   if (!ReserveStagingRegion(p_size, remainingTimeout, p_reservation))
+   {
+      ReleaseFrameBudget(p_priority, p_size);
+      return false;
+   }
+
+   return true;
+}
+
+bool AsyncUploadQueue::AcquireFrameBudget(UploadPriority p_priority, uint64_t p_size, uint64_t p_timeoutInNanoSeconds)
+{
+   ASSERT(p_priority < UploadPriority::Count, "Invalid UploadPriority");
+   const uint32_t priorityIndex = static_cast<uint32_t>(p_priority);
+
+   std::unique_lock<std::mutex> lock(m_frameBudgetMutex);
+
+   // A chunk that is larger than the budget is admitted when nothing else was staged this frame, otherwise it never fits
+   const auto fitsInBudget = [this, priorityIndex, p_size]() {
+      const uint64_t budget = m_frameBudgets[priorityIndex];
+      const uint64_t used = m_frameBudgetsUsed[priorityIndex];
+      return budget == UnlimitedBudget || used == 0u || (used <= budget && p_size <= budget - used);
+   };
+
+   if (p_timeoutInNanoSeconds == InfiniteTimeout)
+   {
+      m_frameBudgetCondition.wait(lock, fitsInBudget);
+   }
+   else if (!m_frameBudgetCondition.wait_for(lock, std::chrono::nanoseconds(p_timeoutInNanoSeconds), fitsInBudget))
+   {
+      return false;
+   }
+
+   m_frameBudgetsUsed[priorityIndex] += p_size;
+   return true;
+}
+
+void AsyncUploadQueue::ReleaseFrameBudget(UploadPriority p_priority, uint64_t p_size)
+{
+   {
+      std::lock_guard<std::mutex> lock(m_frameBudgetMutex);
+      uint64_t& used = m_frameBudgetsUsed[static_cast<uint32_t>(p_priority)];
+      used -= eastl::min(used, p_size);
+   }
+   m_frameBudgetCondition.notify_all();
+}
+
+bool AsyncUploadQueue::ReserveStagingRegion(uint64_t p_size, uint64_t p_timeoutInNanoSeconds,
+                                            StagingRingAllocator::Reservation& p_reservation)
+{
+   const auto startTime = std::chrono::steady_clock::now();
+
+   bool polledCompletedRegions = false;
+   while (!m_allocator.Reserve(p_size, StagingAlignment, p_reservation))
+   {
+      // Regions whose uploads completed since the last Flush can be reclaimed without waiting, poll the TimelineSemaphore once
+      // before the timeout is checked, so a timeout of 0 doesn't fail while space is reclaimable
+      if (!polledCompletedRegions)
+      {
+         polledCompletedRegions = true;
+         FreeRegions();
+         continue;
+      }
+
+      uint64_t remainingTimeout = InfiniteTimeout;
+      if (p_timeoutInNanoSeconds != InfiniteTimeout)
+      {
+         const uint64_t elapsed = static_cast<uint64_t>(
+             std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count());
+         if (elapsed >= p_timeoutInNanoSeconds)
+         {
+            return false;
+         }
+         remainingTimeout = p_timeoutInNanoSeconds - elapsed;
+      }
+
+      // The oldest region might still be pending, submit them so they can be retired
+      FlushInternal(false);
+
+      // The staging buffer is full, wait for the oldest region to complete
+      uint64_t oldestTimelineValue = 0u;
+      {
+         std::lock_guard<std::mutex> lock(m_stagingRegionsMutex);
+         const auto oldestIt =
+             eastl::find_if(m_stagingRegions.begin(), m_stagingRegions.end(), [this](const StagedRegion& p_region) {
+                return p_region.m_reservation.m_reservedFrom == m_allocator.GetTail();
+             });
+         if (oldestIt != m_stagingRegions.end())
+         {
+            oldestTimelineValue = oldestIt->m_timelineValue;
+         }
+      }
+
+      // The oldest region might not be submitted yet by another thread, in which case it's retried
+      if (oldestTimelineValue != 0u)
+      {
+         m_timelineSemaphore->WaitForValue(oldestTimelineValue, remainingTimeout);
+      }
+      FreeRegions();
+   }
+
+   return true;
+}
+
+UploadTicket AsyncUploadQueue::PushPendingChunk(PendingChunk* p_pendingChunk, uint64_t p_chunkSize, UploadPriority p_priority)
+{
+   if (p_pendingChunk->m_staged)
+   {
+      ResourceTrackerInterface::Get()->ReportAllocation(
+          m_stagingMappedData + m_allocator.GetOffset(p_pendingChunk->m_reservation.m_start),
+          MemoryTelemetryRecord{.m_category = MemoryTelemetryCategory::Staging,
+                                .m_name = "AsyncUploadQueue Staging Region",
+                                .m_sizeInBytes = p_chunkSize,
+                                .m_memoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                .m_usageFlags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT});
+   }
+
+   // Push the chunk on the pending list of its priority
+   std::atomic<PendingChunk*>& pendingChunks = m_pendingChunks[static_cast<uint32_t>(p_priority)];
+   p_pendingChunk->m_next = pendingChunks.load(std::memory_order_relaxed);
+   while (!pendingChunks.compare_exchange_weak(p_pendingChunk->m_next, p_pendingChunk, std::memory_order_seq_cst,
+                                               std::memory_order_relaxed))
+   {
+   }
+
+   // The chunk is part of the next flush, or a later one if the next flush already consumed the pending chunks. This makes the
+   // ticket conservative, but never too early. The push and this load, and the increment and the exchange of the flush, are
+   // sequentially consistent: a flush that doesn't consume the chunk has incremented the flushed value before this load
+   const UploadTicket uploadTicket{.m_timelineSemaphore = m_timelineSemaphore,
+                                   .m_value = m_flushedValue.load(std::memory_order_seq_cst) + static_cast<uint32_t>(p_priority) +
+                                              1u};
+
+   // Large uploads are submitted early to keep the transfer queue busy
+   if (m_pendingBytes.fetch_add(p_chunkSize, std::memory_order_relaxed) + p_chunkSize >= FlushThresholdInBytes)
+   {
+      FlushInternal(false);
+   }
+
+   return uploadTicket;
+}
+
+void AsyncUploadQueue::FlushInternal(bool p_forceSubmit)
+{
+   std::lock_guard<std::mutex> lock(m_flushMutex);
+
+   const bool hasPendingChunks =
+       eastl::any_of(m_pendingChunks.begin(), m_pendingChunks.end(), [](const std::atomic<PendingChunk*>& p_pendingChunks) {
+          return p_pendingChunks.load(std::memory_order_acquire) != nullptr;
+       });
+   if (!p_forceSubmit && !hasPendingChunks)
+   {
+      return;
+   }
+
+   // Every flush takes a value per UploadPriority. Increment the flushed value before consuming the chunks, chunks that are
+   // pushed afterwards are part of the next flush
+   const uint64_t flushBaseValue = m_flushedValue.fetch_add(PriorityCount, std::memory_order_seq_cst);
+   m_pendingBytes.store(0u, std::memory_order_relaxed);
+
+   // Every priority is submitted on its own, and signals its own value. The signal of a priority only waits for the copies that
+   // are submitted before it, so an Immediate upload doesn't wait for the Background uploads of the same flush
+   bool hasRecordedPriority = false;
+   for (uint32_t priorityIndex = 0u; priorityIndex < PriorityCount; priorityIndex++)
+   {
+      const uint64_t timelineValue = flushBaseValue + priorityIndex + 1u;
+
+      // The list is in LIFO order, reverse it to record the copies in the order they were queued
+      PendingChunk* pendingChunks = m_pendingChunks[priorityIndex].exchange(nullptr, std::memory_order_seq_cst);
+      PendingChunk* orderedChunks = nullptr;
+      while (pendingChunks)
+      {
+         PendingChunk* next = pendingChunks->m_next;
+         pendingChunks->m_next = orderedChunks;
+         orderedChunks = pendingChunks;
+         pendingChunks = next;
+      }
+
+      // The last priority always signals, it completes all the values of the flush. Submit without CommandBuffers if there is
+      // nothing pending, it still signals the TimelineSemaphore in order
+      const bool isLastPriority = priorityIndex == PriorityCount - 1u;
+      if (!orderedChunks && !isLastPriority)
+      {
+         continue;
+      }
+
+      // A priority without chunks signals on the Queue of the latest submit
+      const QueueFamilyType queueType = orderedChunks ? GetUploadQueueType(orderedChunks) : m_lastSubmitQueueType;
+
+      Std::vector<Ptr<CommandBuffer>> commandBuffers;
+      if (orderedChunks)
+      {
+         commandBuffers.push_back(RecordChunks(orderedChunks, queueType, timelineValue, hasRecordedPriority));
+         hasRecordedPriority = true;
+      }
+
+      // Submits on different Queues aren't ordered, wait for the latest submit of the other Queue. The TimelineSemaphore is
+      // signaled in order, and the copies are written after the copies of the earlier submits
+      Std::vector<TimelineSemaphoreSubmitInfo> waitTimelineSemaphores;
+      const uint64_t submittedValue = m_submittedValue.load(std::memory_order_relaxed);
+      if (queueType != m_lastSubmitQueueType && submittedValue != 0u)
+      {
+         waitTimelineSemaphores.push_back(TimelineSemaphoreSubmitInfo{.m_timelineSemaphore = m_timelineSemaphore,
+                                                                      .p_waitOrSignalValue = submittedValue,
+                                                                      .m_stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT});
+      }
+
+      TimelineSemaphoreSubmitInfo signalTimelineSemaphore{.m_timelineSemaphore = m_timelineSemaphore,
+                                                          .p_waitOrSignalValue = timelineValue,
+                                                          .m_stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT};
+      Std::vector<TimelineSemaphoreSubmitInfo> signalTimelineSemaphores{signalTimelineSemaphore};
+      m_descriptor.m_vulkanDevice->QueueSubmit(queueType, commandBuffers, {}, waitTimelineSemaphores, {},
+                                               signalTimelineSemaphores, {});
+
+      m_lastSubmitQueueType = queueType;
+      m_submittedValue.store(timelineValue, std::memory_order_release);
+   }
+}
+
+QueueFamilyType AsyncUploadQueue::GetUploadQueueType(const PendingChunk* p_orderedChunks) const
+{
+   // Without a dedicated transfer QueueFamily, the transfer Queue can only be used when it's part of the graphics QueueFamily
+   Ptr<VulkanDevice> vulkanDevice = m_descriptor.m_vulkanDevice;
+   if (!vulkanDevice->HasDedicatedTransferQueueFamily())
+   {
+      return vulkanDevice->GetTransferQueueFamilyIndex() == vulkanDevice->GetGraphicsQueueFamilyIndex()
+                 ? QueueFamilyType::TransferQueue
+                 : QueueFamilyType::GraphicsQueue;
+   }
+
+   // The transfer QueueFamily can't write resources that are owned by the graphics QueueFamily, and releasing them to the
+   // transfer QueueFamily first would stall the graphics Queue. Images with contents are used by the graphics QueueFamily
+   for (const PendingChunk* chunk = p_orderedChunks; chunk; chunk = chunk->m_next)
+   {
+      const bool hasConsumerOwnedBuffer =
+          eastl::any_of(chunk->m_copies.begin(), chunk->m_copies.end(),
+                        [](const PendingCopy& p_pendingCopy) { return p_pendingCopy.m_destBuffer->IsOwnedByConsumer(); });
+      const bool hasConsumerOwnedImage =
+          eastl::any_of(chunk->m_imageCopies.begin(), chunk->m_imageCopies.end(), [](const PendingImageCopy& p_imageCopy) {
+             return p_imageCopy.m_oldLayout != VK_IMAGE_LAYOUT_UNDEFINED || p_imageCopy.m_destImage->IsOwnedByConsumer();
+          });
+      if (hasConsumerOwnedBuffer || hasConsumerOwnedImage)
+      {
+         return QueueFamilyType::GraphicsQueue;
+      }
+   }
+
+   return QueueFamilyType::TransferQueue;
+}
+
+Ptr<CommandBuffer> AsyncUploadQueue::RecordChunks(PendingChunk* p_orderedChunks, QueueFamilyType p_queueType,
+                                                  uint64_t p_timelineValue, bool p_afterEarlierPriority)
+{
+   // Uploads that are recorded on a dedicated transfer QueueFamily release the resources to the graphics QueueFamily after they
+   // are written. On the graphics QueueFamily, the CommandBuffer acquires the resources that are still pending
+   Ptr<VulkanDevice> vulkanDevice = m_descriptor.m_vulkanDevice;
+   const bool transferOwnership =
+       vulkanDevice->HasDedicatedTransferQueueFamily() && p_queueType == QueueFamilyType::TransferQueue;
+   const uint32_t srcQueueFamilyIndex = transferOwnership ? vulkanDevice->GetTransferQueueFamilyIndex() : VK_QUEUE_FAMILY_IGNORED;
+   const uint32_t dstQueueFamilyIndex = transferOwnership ? vulkanDevice->GetGraphicsQueueFamilyIndex() : VK_QUEUE_FAMILY_IGNORED;
+   // The releases are part of this submit, the acquires wait until it's complete
+   const UploadTicket releaseUploadTicket{.m_timelineSemaphore = m_timelineSemaphore, .m_value = p_timelineValue};
+
+   // The buffer copies of all the chunks are grouped by source and destination Buffer, and recorded after the chunks are
+   // consumed
+   Std::vector<PendingBufferCopies> pendingBufferCopies;
+   uint32_t lastBufferCopiesIndex = 0u;
+
    CommandBufferDescriptor commandBufferDesc;
    commandBufferDesc.m_vulkanDevice = m_descriptor.m_vulkanDevice;
-   commandBufferDesc.m_queueType = QueueFamilyType::TransferQueue;
+   commandBufferDesc.m_queueType = p_queueType;
    Ptr<CommandBuffer> commandBuffer = CommandBuffer::CreateInstance(eastl::move(commandBufferDesc));
+   commandBuffer->m_recordsUploads = true;
 
-   uint64_t offsetSourceBuffer = reinterpret_cast<uintptr_t>(flatBuffer) - m_allocator.GetPoolAddress();
-   for (BufferUploadRequest& uploadRequest : p_bufferUploadRequests)
+   // On the graphics Queue, the destinations can still be read or written by the commands that were submitted earlier
+   if (p_queueType == QueueFamilyType::GraphicsQueue)
    {
-      BufferCopyRegion bufferCopyRegion{.m_srcOffset = offsetSourceBuffer,
-                                        .m_destOffset = uploadRequest.m_destOffsetInBytes,
-                                        .m_size = uploadRequest.m_copySizeInBytes};
-      Std::vector<BufferCopyRegion> copyBufferRegions{bufferCopyRegion};
+      commandBuffer->PipelineBarrier()->AddMemoryBarrier(
+          VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
+          VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT);
+   }
+   // The same range can be written by multiple priorities, the copies of an earlier submit are written first
+   else if (p_afterEarlierPriority)
+   {
+      commandBuffer->PipelineBarrier()->AddMemoryBarrier(VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                                                         VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+                                                         VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT);
+   }
 
-      commandBuffer->CopyBuffer(m_stagingBuffer, uploadRequest.m_destBuffer, copyBufferRegions);
+   std::lock_guard<std::mutex> regionsLock(m_stagingRegionsMutex);
+   while (p_orderedChunks)
+   {
+      for (PendingCopy& pendingCopy : p_orderedChunks->m_copies)
+      {
+         const auto isSameGroup = [&pendingCopy](const PendingBufferCopies& p_pendingBufferCopies) {
+            return p_pendingBufferCopies.m_srcBuffer == pendingCopy.m_srcBuffer &&
+                   p_pendingBufferCopies.m_destBuffer == pendingCopy.m_destBuffer;
+         };
 
-      // Increment the source offset
-      offsetSourceBuffer += uploadRequest.m_copySizeInBytes;
-   }
+         // Groups are recorded in the order they're created. The copy was queued after the regions of the later groups, it
+         // can't join a group that is recorded before a group that writes the same range of the destination Buffer
+         const auto overlapsLaterGroups = [&pendingCopy, &pendingBufferCopies](uint32_t p_groupIndex) {
+            return eastl::any_of(
+                pendingBufferCopies.begin() + p_groupIndex + 1u, pendingBufferCopies.end(),
+                [&pendingCopy](const PendingBufferCopies& p_pendingBufferCopies) {
+                   return p_pendingBufferCopies.m_destBuffer == pendingCopy.m_destBuffer &&
+                          eastl::any_of(p_pendingBufferCopies.m_copyRegions.begin(), p_pendingBufferCopies.m_copyRegions.end(),
+                                        [&pendingCopy](const BufferCopyRegion& p_copyRegion) {
+                                           return Internal::DestRangesOverlap(p_copyRegion, pendingCopy.m_copyRegion);
+                                        });
+                });
+         };
 
-   commandBuffer->Compile();
+         // Consecutive copies usually target the same Buffer, check the last group before searching
+         if (pendingBufferCopies.empty() || !isSameGroup(pendingBufferCopies[lastBufferCopiesIndex]) ||
+             overlapsLaterGroups(lastBufferCopiesIndex))
+         {
+            // Search for the last group of the source and destination Buffer, the earlier ones are followed by it
+            const auto bufferCopiesIt = eastl::find_if(pendingBufferCopies.rbegin(), pendingBufferCopies.rend(), isSameGroup);
+            const uint32_t groupIndex = static_cast<uint32_t>(pendingBufferCopies.rend() - bufferCopiesIt) - 1u;
+            if (bufferCopiesIt == pendingBufferCopies.rend() || overlapsLaterGroups(groupIndex))
+            {
+               pendingBufferCopies.push_back(
+                   PendingBufferCopies{.m_srcBuffer = pendingCopy.m_srcBuffer, .m_destBuffer = pendingCopy.m_destBuffer});
+               lastBufferCopiesIndex = static_cast<uint32_t>(pendingBufferCopies.size() - 1u);
+            }
+            else
+            {
+               lastBufferCopiesIndex = groupIndex;
+            }
+         }
+         pendingBufferCopies[lastBufferCopiesIndex].m_copyRegions.push_back(pendingCopy.m_copyRegion);
+      }
+
+      for (PendingImageCopy& pendingImageCopy : p_orderedChunks->m_imageCopies)
+      {
+         // Only the subresources that are copied are transitioned, and released
+         const VkImageSubresourceRange& subresourceRange = pendingImageCopy.m_subresourceRange;
+         if (pendingImageCopy.m_transitionBefore)
+         {
+            // An Image that is re-uploaded has contents, the copy has to wait for the earlier reads and writes of it
+            const bool isReupload = pendingImageCopy.m_oldLayout != VK_IMAGE_LAYOUT_UNDEFINED;
+            const VkPipelineStageFlags2 srcStageMask = isReupload ? VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT : VK_PIPELINE_STAGE_2_NONE;
+            const VkAccessFlags2 srcAccessMask =
+                isReupload ? VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT : VK_ACCESS_2_NONE;
+            commandBuffer->PipelineBarrier()->AddImageBarrier(
+                srcStageMask, srcAccessMask, VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                pendingImageCopy.m_oldLayout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_QUEUE_FAMILY_IGNORED,
+                VK_QUEUE_FAMILY_IGNORED, pendingImageCopy.m_destImage, subresourceRange);
+         }
+
+         commandBuffer->CopyBufferToImage(m_stagingBuffer, pendingImageCopy.m_destImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                          pendingImageCopy.m_copyRegions);
+
+         // The transition after the last copy releases the Image as well, the acquire repeats the layout transition. Without a
+         // release, the commands after the upload wait for the transition
+         if (pendingImageCopy.m_transitionAfter)
+         {
+            const VkPipelineStageFlags2 dstStageMask =
+                transferOwnership ? VK_PIPELINE_STAGE_2_NONE : VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+            const VkAccessFlags2 dstAccessMask =
+                transferOwnership ? VK_ACCESS_2_NONE : VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+            commandBuffer->PipelineBarrier()->AddImageBarrier(
+                VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, dstStageMask, dstAccessMask,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, pendingImageCopy.m_newLayout, srcQueueFamilyIndex, dstQueueFamilyIndex,
+                pendingImageCopy.m_destImage, subresourceRange);
+
+            if (transferOwnership)
+            {
+               pendingImageCopy.m_destImage->SetPendingOwnershipAcquire(
+                   QueueFamilyOwnershipAcquire{.m_srcQueueFamilyIndex = srcQueueFamilyIndex,
+                                               .m_dstQueueFamilyIndex = dstQueueFamilyIndex,
+                                               .m_oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                               .m_newLayout = pendingImageCopy.m_newLayout,
+                                               .m_subresourceRange = subresourceRange,
+                                               .m_releaseUploadTicket = releaseUploadTicket});
+            }
+         }
+      }
+
+      if (p_orderedChunks->m_staged)
+      {
+         m_stagingRegions.push_back(
+             StagedRegion{.m_reservation = p_orderedChunks->m_reservation, .m_timelineValue = p_timelineValue});
+      }
+
+      PendingChunk* next = p_orderedChunks->m_next;
+      delete p_orderedChunks;
+      p_orderedChunks = next;
+   }
 
-   Ptr<Fence> stagingFence;
+   // The CommandBuffer doesn't reference the Buffers, imported sources are kept alive until the submit is complete
+   Std::vector<Ptr<Buffer>> destBuffers;
+   for (uint32_t groupIndex = 0u; groupIndex < static_cast<uint32_t>(pendingBufferCopies.size()); groupIndex++)
    {
-      FenceDescriptor fenceDescriptor;
-      fenceDescriptor.m_vulkanDevice = m_descriptor.m_vulkanDevice;
-      stagingFence = Fence::CreateInstance(eastl::move(fenceDescriptor));
+      const PendingBufferCopies& bufferCopies = pendingBufferCopies[groupIndex];
+
+      // Copies of different sources to the same range of a destination Buffer are written in the order they were queued
+      const bool overlapsEarlierGroups = eastl::any_of(
+          pendingBufferCopies.begin(), pendingBufferCopies.begin() + groupIndex,
+          [&bufferCopies](const PendingBufferCopies& p_earlierBufferCopies) {
+             return p_earlierBufferCopies.m_destBuffer == bufferCopies.m_destBuffer &&
+                    eastl::any_of(p_earlierBufferCopies.m_copyRegions.begin(), p_earlierBufferCopies.m_copyRegions.end(),
+                                  [&bufferCopies](const BufferCopyRegion& p_earlierCopyRegion) {
+                                     return eastl::any_of(bufferCopies.m_copyRegions.begin(), bufferCopies.m_copyRegions.end(),
+                                                          [&p_earlierCopyRegion](const BufferCopyRegion& p_copyRegion) {
+                                                             return Internal::DestRangesOverlap(p_earlierCopyRegion,
+                                                                                                p_copyRegion);
+                                                          });
+                                  });
+          });
+      if (overlapsEarlierGroups)
+      {
+         commandBuffer->PipelineBarrier()->AddBufferBarrier(
+             VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+             VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, bufferCopies.m_destBuffer, 0u,
+             VK_WHOLE_SIZE);
+      }
+
+      Internal::RecordBufferCopies(commandBuffer.get(), bufferCopies.m_srcBuffer, bufferCopies.m_destBuffer,
+                                   bufferCopies.m_copyRegions);
+
+      if (bufferCopies.m_srcBuffer != m_stagingBuffer)
+      {
+         m_importedSources.push_back(ImportedSource{.m_buffer = bufferCopies.m_srcBuffer, .m_timelineValue = p_timelineValue});
+      }
+
+      // A destination Buffer can be copied from multiple sources
+      if (eastl::find(destBuffers.begin(), destBuffers.end(), bufferCopies.m_destBuffer) == destBuffers.end())
+      {
+         destBuffers.push_back(bufferCopies.m_destBuffer);
+      }
    }
 
-   m_stagingRegions.emplace_back(stagingFence, flatBuffer);
+   // Release the whole Buffers once, after all the copies of the priority
+   if (transferOwnership && !destBuffers.empty())
+   {
+      PipelineBarrierCommand* releaseBarrier = commandBuffer->PipelineBarrier();
+      for (const Ptr<Buffer>& destBuffer : destBuffers)
+      {
+         releaseBarrier->AddBufferBarrier(VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                                          VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, srcQueueFamilyIndex, dstQueueFamilyIndex,
+                                          destBuffer, 0u, VK_WHOLE_SIZE);
+         destBuffer->SetPendingOwnershipAcquire(
+             QueueFamilyOwnershipAcquire{.m_srcQueueFamilyIndex = srcQueueFamilyIndex,
+                                         .m_dstQueueFamilyIndex = dstQueueFamilyIndex,
+                                         .m_releaseUploadTicket = releaseUploadTicket});
+      }
+   }
 
-   Std::vector<Ptr<CommandBuffer>> commandBuffers;
-   commandBuffers.push_back(commandBuffer);
-   m_descriptor.m_vulkanDevice->QueueSubmit(QueueFamilyType::TransferQueue, commandBuffers, {}, {}, {}, {}, stagingFence);
+   // The uploads are ordered by their submits, and the waits between the Queues. The copies don't wait for the UploadTickets of
+   // their destinations, which can belong to this very flush. The releases that are acquired by this CommandBuffer are
+   // signaled before it for the same reason
+   commandBuffer->m_uploadTicket = UploadTicket{};
 
-   return stagingFence;
+   commandBuffer->Compile();
+   return commandBuffer;
 }
 
 void AsyncUploadQueue::FreeRegions()
 {
-   for (auto it = m_stagingRegions.begin(); it != m_stagingRegions.end();)
+   // Query the TimelineSemaphore once, all the regions up until that value are complete
+   const uint64_t completedValue = m_timelineSemaphore->GetCurrentValue();
+
+   std::lock_guard<std::mutex> lock(m_stagingRegionsMutex);
+
+   // Regions can be registered out of order when reserved from multiple threads, sort them by their position in the ring
+   eastl::sort(m_stagingRegions.begin(), m_stagingRegions.end(), [](const StagedRegion& p_lhs, const StagedRegion& p_rhs) {
+      return p_lhs.m_reservation.m_reservedFrom < p_rhs.m_reservation.m_reservedFrom;
+   });
+
+   // Retire the regions in order, stop at the first region that is still in flight, or that isn't registered yet
+   uint32_t retiredCount = 0u;
+   for (const StagedRegion& stagedRegion : m_stagingRegions)
    {
-      if (it->m_stagingFence->IsSignaled())
+      if (stagedRegion.m_reservation.m_reservedFrom != m_allocator.GetTail() || stagedRegion.m_timelineValue > completedValue)
       {
-         m_allocator.Free(it->m_stagingAddress);
-
-         m_stagingRegions.erase(it);
+         break;
       }
 
-      it++;
+      ResourceTrackerInterface::Get()->ReportDeallocation(m_stagingMappedData +
+                                                          m_allocator.GetOffset(stagedRegion.m_reservation.m_start));
+      m_allocator.Retire(stagedRegion.m_reservation.m_end);
+      retiredCount++;
    }
+
+   m_stagingRegions.erase(m_stagingRegions.begin(), m_stagingRegions.begin() + retiredCount);
+
+   m_importedSources.erase(eastl::remove_if(m_importedSources.begin(), m_importedSources.end(),
+                                            [completedValue](const ImportedSource& p_importedSource) {
+                                               return p_importedSource.m_timelineValue <= completedValue;
+                                            }),
+                           m_importedSources.end());
 }
 
-} // namespace Render
\ No newline at end of file
+} // namespace Render
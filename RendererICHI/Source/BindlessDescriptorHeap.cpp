@@ -0,0 +1,241 @@
+#include <BindlessDescriptorHeap.h>
+
+#include <Util/Assert.h>
+
+#include <Buffer.h>
+#include <BufferView.h>
+#include <DescriptorSet.h>
+#include <DescriptorSetLayout.h>
+#include <Image.h>
+#include <ImageView.h>
+#include <Renderer.h>
+#include <RendererStateInterface.h>
+#include <RendererTypes.h>
+#include <VulkanDevice.h>
+
+namespace Render
+{
+
+BindlessDescriptorHeap::IndexAllocator::IndexAllocator(uint32_t p_capacity)
+{
+   m_capacity = p_capacity;
+   m_allocated.resize(p_capacity, false);
+}
+
+uint32_t BindlessDescriptorHeap::IndexAllocator::Allocate()
+{
+   if (!m_freeIndices.empty())
+   {
+      const uint32_t index = m_freeIndices.back();
+      m_freeIndices.pop_back();
+      m_allocated[index] = true;
+      return index;
+   }
+
+   ASSERT(m_highWaterMark < m_capacity, "The BindlessDescriptorHeap array is full");
+   m_allocated[m_highWaterMark] = true;
+   return m_highWaterMark++;
+}
+
+void BindlessDescriptorHeap::IndexAllocator::Free(uint32_t p_index, uint64_t p_frameIndex)
+{
+   ASSERT(p_index < m_highWaterMark, "Index was never allocated");
+   ASSERT(m_allocated[p_index], "Index is already freed");
+   m_allocated[p_index] = false;
+   m_retiredIndices.push_back(RetiredIndex{.m_index = p_index, .m_frameIndex = p_frameIndex});
+}
+
+bool BindlessDescriptorHeap::IndexAllocator::IsAllocated(uint32_t p_index) const
+{
+   return p_index < m_capacity && m_allocated[p_index];
+}
+
+void BindlessDescriptorHeap::IndexAllocator::Recycle(uint64_t p_frameIndex, Std::vector<uint32_t>& p_recycledIndices)
+{
+   // Indices are retired in frame order
+   uint32_t recycledCount = 0u;
+   for (const RetiredIndex& retiredIndex : m_retiredIndices)
+   {
+      if ((p_frameIndex - retiredIndex.m_frameIndex) < RendererDefines::MaxQueuedFrames)
+      {
+         break;
+      }
+
+      m_freeIndices.push_back(retiredIndex.m_index);
+      p_recycledIndices.push_back(retiredIndex.m_index);
+      recycledCount++;
+   }
+
+   m_retiredIndices.erase(m_retiredIndices.begin(), m_retiredIndices.begin() + recycledCount);
+}
+
+BindlessDescriptorHeap::BindlessDescriptorHeap(BindlessDescriptorHeapDescriptor&& p_desc)
+    : m_bufferViewIndices(p_desc.m_storageBufferCount), m_imageViewIndices(p_desc.m_sampledImageCount)
+{
+   m_descriptor = p_desc;
+
+   // Create the DescriptorSetLayout, the arrays are partially bound, and can be written while the DescriptorSet is bound
+   {
+      DescriptorSetLayoutDescriptor desc;
+      desc.m_vulkanDevice = m_descriptor.m_vulkanDevice;
+      desc.m_updateAfterBind = true;
+      desc.AddResourceLayoutBinding(StorageBufferBinding, DescriptorType::StaticStorageBuffer, m_descriptor.m_storageBufferCount);
+      desc.AddResourceLayoutBinding(SampledImageBinding, DescriptorType::SampledImage, m_descriptor.m_sampledImageCount);
+      m_descriptorSetLayout = DescriptorSetLayout::CreateInstance(eastl::move(desc));
+   }
+
+   // Create the DescriptorSet, it lives as long as the heap
+   {
+      DescriptorSetDescriptor desc;
+      desc.m_vulkanDevice = m_descriptor.m_vulkanDevice;
+      desc.m_descriptorSetLayout = m_descriptorSetLayout;
+      m_descriptorSet = DescriptorSet::CreateInstance(eastl::move(desc));
+   }
+
+   m_bufferViews.resize(m_descriptor.m_storageBufferCount);
+   m_imageViews.resize(m_descriptor.m_sampledImageCount);
+}
+
+BindlessDescriptorHeap::~BindlessDescriptorHeap()
+{
+   m_descriptorSet = nullptr;
+   m_descriptorSetLayout = nullptr;
+
+   m_bufferViews.clear();
+   m_imageViews.clear();
+}
+
+uint32_t BindlessDescriptorHeap::RegisterBufferView(Ptr<BufferView> p_bufferView)
+{
+   ASSERT(p_bufferView->GetUsage() == BufferUsage::Storage, "Only storage BufferViews can be registered");
+
+   // The Buffer can be read by any shader from now on, uploads to it are recorded on the consumer QueueFamily
+   p_bufferView->GetBuffer()->MarkOwnedByConsumer();
+
+   VkDescriptorBufferInfo bufferInfo = {};
+   bufferInfo.buffer = p_bufferView->GetBuffer()->GetBufferNative();
+   bufferInfo.offset = p_bufferView->GetOffsetFromBase();
+   bufferInfo.range = p_bufferView->GetViewRange();
+
+   std::lock_guard<std::mutex> lock(m_mutex);
+
+   const uint32_t index = m_bufferViewIndices.Allocate();
+   m_bufferViews[index] = p_bufferView;
+
+   VkWriteDescriptorSet writeDescriptorSet = {};
+   writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+   writeDescriptorSet.dstSet = m_descriptorSet->GetDescriptorSetNative();
+   writeDescriptorSet.dstBinding = StorageBufferBinding;
+   writeDescriptorSet.dstArrayElement = index;
+   writeDescriptorSet.descriptorCount = 1u;
+   writeDescriptorSet.descriptorType = RenderTypeToNative::DescriptorTypeToNative(DescriptorType::StaticStorageBuffer);
+   writeDescriptorSet.pBufferInfo = &bufferInfo;
+
+   // Writes to the same DescriptorSet must be externally synchronized, the lock is held
+   vkUpdateDescriptorSets(m_descriptor.m_vulkanDevice->GetLogicalDeviceNative(), 1u, &writeDescriptorSet, 0u, nullptr);
+
+   return index;
+}
+
+uint32_t BindlessDescriptorHeap::RegisterImageView(Ptr<ImageView> p_imageView)
+{
+   p_imageView->GetImage()->MarkOwnedByConsumer();
+
+   VkDescriptorImageInfo imageInfo = {};
+   imageInfo.sampler = VK_NULL_HANDLE;
+   imageInfo.imageView = p_imageView->GetImageViewNative();
+   imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+   std::lock_guard<std::mutex> lock(m_mutex);
+
+   const uint32_t index = m_imageViewIndices.Allocate();
+   m_imageViews[index] = p_imageView;
+
+   VkWriteDescriptorSet writeDescriptorSet = {};
+   writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+   writeDescriptorSet.dstSet = m_descriptorSet->GetDescriptorSetNative();
+   writeDescriptorSet.dstBinding = SampledImageBinding;
+   writeDescriptorSet.dstArrayElement = index;
+   writeDescriptorSet.descriptorCount = 1u;
+   writeDescriptorSet.descriptorType = RenderTypeToNative::DescriptorTypeToNative(DescriptorType::SampledImage);
+   writeDescriptorSet.pImageInfo = &imageInfo;
+
+   vkUpdateDescriptorSets(m_descriptor.m_vulkanDevice->GetLogicalDeviceNative(), 1u, &writeDescriptorSet, 0u, nullptr);
+
+   return index;
+}
+
+void BindlessDescriptorHeap::UnregisterBufferView(uint32_t p_index)
+{
+   const uint64_t frameIndex = RenderStateInterface::Get()->GetFrameIndex();
+
+   std::lock_guard<std::mutex> lock(m_mutex);
+
+   // The descriptor isn't overwritten, frames in flight might still read it. The BufferView is released once it's recycled, the
+   // index is unregistered right away
+   ASSERT(m_bufferViewIndices.IsAllocated(p_index), "BufferView isn't registered");
+   m_bufferViewIndices.Free(p_index, frameIndex);
+}
+
+void BindlessDescriptorHeap::UnregisterImageView(uint32_t p_index)
+{
+   const uint64_t frameIndex = RenderStateInterface::Get()->GetFrameIndex();
+
+   std::lock_guard<std::mutex> lock(m_mutex);
+
+   ASSERT(m_imageViewIndices.IsAllocated(p_index), "ImageView isn't registered");
+   m_imageViewIndices.Free(p_index, frameIndex);
+}
+
+Ptr<DescriptorSet> BindlessDescriptorHeap::GetDescriptorSet() const
+{
+   return m_descriptorSet;
+}
+
+Ptr<DescriptorSetLayout> BindlessDescriptorHeap::GetDescriptorSetLayout() const
+{
+   return m_descriptorSetLayout;
+}
+
+void BindlessDescriptorHeap::Update()
+{
+   const uint64_t frameIndex = RenderStateInterface::Get()->GetFrameIndex();
+
+   Std::vector<uint32_t> recycledIndices;
+
+   std::lock_guard<std::mutex> lock(m_mutex);
+
+   // Release the resources of the recycled indices, the partially bound descriptors aren't read by the shaders anymore
+   m_bufferViewIndices.Recycle(frameIndex, recycledIndices);
+   for (uint32_t index : recycledIndices)
+   {
+      m_bufferViews[index] = nullptr;
+   }
+
+   recycledIndices.clear();
+   m_imageViewIndices.Recycle(frameIndex, recycledIndices);
+   for (uint32_t index : recycledIndices)
+   {
+      m_imageViews[index] = nullptr;
+   }
+
+   // Shaders can index any registered resource, so they're all referenced by the frame. Report them with a single call
+   Std::vector<const void*> referencedResources;
+   for (const Ptr<BufferView>& bufferView : m_bufferViews)
+   {
+      if (bufferView)
+      {
+         referencedResources.push_back(bufferView->GetBuffer().get());
+      }
+   }
+   for (const Ptr<ImageView>& imageView : m_imageViews)
+   {
+      if (imageView)
+      {
+         referencedResources.push_back(imageView->GetImage().get());
+      }
+   }
+   ResourceTrackerInterface::Get()->MarkReferenced(referencedResources);
+}
+
+} // namespace Render
@@ -5,7 +5,6 @@
 #include <DescriptorPoolManagerInterface.h>
 #include <RendererTypes.h>
 #include <AsyncUploadQueueInterface.h>
-#include <Fence.h>
 
 namespace Render
 {
@@ -18,9 +17,38 @@ Buffer::Buffer(BufferDescriptor&& p_desc)
    m_queueFamilyAccess = p_desc.m_queueFamilyAccess;
    m_memoryProperties = p_desc.m_memoryProperties;
 
+   const bool hasDeviceAddress =
+       static_cast<uint32_t>(m_bufferUsageFlags) & static_cast<uint32_t>(BufferUsageFlags::ShaderDeviceAddress);
+
+   // Host memory that can't be imported is uploaded as initial data
+   const auto uploadImportedHostData = [this, &p_desc]() {
+      m_importedHostMemory = false;
+      p_desc.m_initialData = p_desc.m_importedHostData;
+      p_desc.m_initialDataSize = m_bufferSizeRequested;
+      m_bufferUsageFlags = static_cast<BufferUsageFlags>(static_cast<uint32_t>(m_bufferUsageFlags) |
+                                                         static_cast<uint32_t>(BufferUsageFlags::TransferDestination));
+   };
+
+   m_importedHostMemory =
+       p_desc.m_importedHostData && m_vulkanDevice->CanImportHostMemory(p_desc.m_importedHostData, m_bufferSizeRequested);
+   if (p_desc.m_importedHostData)
+   {
+      ASSERT(!p_desc.m_initialData, "Buffers that import host memory can't have initial data");
+      ASSERT(!hasDeviceAddress, "Buffers that import host memory can't have a device address");
+      if (!m_importedHostMemory)
+      {
+         uploadImportedHostData();
+      }
+   }
+
+   const VkExternalMemoryBufferCreateInfo externalMemoryBufferCreateInfo{
+       .sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO,
+       .pNext = nullptr,
+       .handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT};
+
    VkBufferCreateInfo bufferCreateInfo = {};
    bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-   bufferCreateInfo.pNext = nullptr;
+   bufferCreateInfo.pNext = m_importedHostMemory ? &externalMemoryBufferCreateInfo : nullptr;
    bufferCreateInfo.flags = 0u;
    bufferCreateInfo.size = m_bufferSizeRequested;
    bufferCreateInfo.usage = RenderTypeToNative::BufferUsageFlagsToNative(m_bufferUsageFlags);
@@ -34,14 +62,60 @@ Buffer::Buffer(BufferDescriptor&& p_desc)
    // Create the memory
    VkMemoryRequirements memoryRequirements;
    vkGetBufferMemoryRequirements(m_vulkanDevice->GetLogicalDeviceNative(), m_bufferNative, &memoryRequirements);
-   auto [deviceMemory, allocatedMemory] = m_vulkanDevice->AllocateDeviceMemory(memoryRequirements, m_memoryProperties);
-   m_deviceMemory = deviceMemory;
-   m_bufferSizeAllocatedMemory = allocatedMemory;
+   ASSERT(!hasDeviceAddress || m_vulkanDevice->IsBufferDeviceAddressSupported(), "Buffer device addresses aren't supported");
+   if (m_importedHostMemory)
+   {
+      // The whole imported range backs the Buffer, it has to cover the memory requirements. The import can still fail, e.g. when
+      // none of the memory types of the host allocation can back the Buffer
+      if (memoryRequirements.size <= m_bufferSizeRequested)
+      {
+         VkMemoryRequirements importedMemoryRequirements = memoryRequirements;
+         importedMemoryRequirements.size = m_bufferSizeRequested;
+         m_deviceMemory = m_vulkanDevice->ImportHostMemory(importedMemoryRequirements, p_desc.m_importedHostData);
+         m_bufferSizeAllocatedMemory = m_bufferSizeRequested;
+      }
+
+      if (m_deviceMemory == VK_NULL_HANDLE)
+      {
+         // The Buffer was created for external memory, recreate it as a regular Buffer that the host memory is uploaded to
+         vkDestroyBuffer(m_vulkanDevice->GetLogicalDeviceNative(), m_bufferNative, nullptr);
+         uploadImportedHostData();
+
+         bufferCreateInfo.pNext = nullptr;
+         bufferCreateInfo.usage = RenderTypeToNative::BufferUsageFlagsToNative(m_bufferUsageFlags);
+         res = vkCreateBuffer(m_vulkanDevice->GetLogicalDeviceNative(), &bufferCreateInfo, nullptr, &m_bufferNative);
+         ASSERT(res == VK_SUCCESS, "Failed to create a Buffer resource");
+
+         vkGetBufferMemoryRequirements(m_vulkanDevice->GetLogicalDeviceNative(), m_bufferNative, &memoryRequirements);
+      }
+   }
+
+   if (!m_importedHostMemory)
+   {
+      auto [deviceMemory, allocatedMemory] =
+          m_vulkanDevice->AllocateDeviceMemory(memoryRequirements, m_memoryProperties, hasDeviceAddress);
+      m_deviceMemory = deviceMemory;
+      m_bufferSizeAllocatedMemory = allocatedMemory;
+   }
 
    // Bind the Buffer resource to the Memory resource
    res = vkBindBufferMemory(m_vulkanDevice->GetLogicalDeviceNative(), GetBufferNative(), GetDeviceMemoryNative(), 0u);
    ASSERT(res == VK_SUCCESS, "Failed to bind the Buffer resource to the Memory resource");
 
+   if (hasDeviceAddress)
+   {
+      const VkBufferDeviceAddressInfo bufferDeviceAddressInfo{
+          .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO, .pNext = nullptr, .buffer = m_bufferNative};
+      m_deviceAddress = vkGetBufferDeviceAddress(m_vulkanDevice->GetLogicalDeviceNative(), &bufferDeviceAddressInfo);
+   }
+
+   ResourceTrackerInterface::Get()->ReportAllocation(
+       this, MemoryTelemetryRecord{.m_category = MemoryTelemetryCategory::Buffer,
+                                   .m_resource = this,
+                                   .m_sizeInBytes = m_bufferSizeAllocatedMemory,
+                                   .m_memoryPropertyFlags = RenderTypeToNative::MemoryPropertyFlagsToNative(m_memoryProperties),
+                                   .m_usageFlags = RenderTypeToNative::BufferUsageFlagsToNative(m_bufferUsageFlags)});
+
    if (p_desc.m_initialData)
    {
       BufferUploadRequest uploadRequest{.m_sourceData = p_desc.m_initialData,
@@ -50,13 +124,28 @@ Buffer::Buffer(BufferDescriptor&& p_desc)
                                         .m_destOffsetInBytes = 0u};
 
       Std::vector<BufferUploadRequest> uploadRequests{uploadRequest};
-      Ptr<Fence> fence = AsyncUploadQueueInterface::Get()->QueueUpload(uploadRequests);
-      fence->WaitForSignal();
+      m_uploadTicket = AsyncUploadQueueInterface::Get()->QueueUpload(uploadRequests);
+      if (p_desc.m_asyncInitialData)
+      {
+         m_isReady = false;
+      }
+      else
+      {
+         AsyncUploadQueueInterface::Get()->WaitForUpload(m_uploadTicket);
+      }
    }
 }
 
 Buffer::~Buffer()
 {
+   ResourceTrackerInterface::Get()->ReportDeallocation(this);
+
+   ASSERT(m_mapCount == 0u, "Buffer is still mapped");
+   if (m_mappedData)
+   {
+      vkUnmapMemory(m_vulkanDevice->GetLogicalDeviceNative(), GetDeviceMemoryNative());
+   }
+
    ASSERT(m_deviceMemory != VK_NULL_HANDLE, "Memory not valid. Trying to cleanup a buffer that was never initialized");
    vkFreeMemory(m_vulkanDevice->GetLogicalDeviceNative(), m_deviceMemory, nullptr);
 
@@ -89,26 +178,145 @@ const uint64_t Buffer::GetBufferSizeAllocated() const
    return m_bufferSizeAllocatedMemory;
 }
 
+bool Buffer::IsReady()
+{
+   if (m_isReady.load(std::memory_order_acquire))
+   {
+      return true;
+   }
+
+   if (AsyncUploadQueueInterface::Get()->IsUploadComplete(GetUploadTicket()))
+   {
+      m_isReady.store(true, std::memory_order_release);
+      return true;
+   }
+
+   return false;
+}
+
+UploadTicket Buffer::GetUploadTicket() const
+{
+   std::lock_guard<std::mutex> lock(m_uploadTicketMutex);
+   return m_uploadTicket;
+}
+
+void Buffer::MergeUploadTicket(const UploadTicket& p_uploadTicket)
+{
+   std::lock_guard<std::mutex> lock(m_uploadTicketMutex);
+   m_uploadTicket = MergeUploadTickets(m_uploadTicket, p_uploadTicket);
+}
+
+void Buffer::SetPendingOwnershipAcquire(const QueueFamilyOwnershipAcquire& p_acquire)
+{
+   std::lock_guard<std::mutex> lock(m_ownershipMutex);
+   ASSERT(!m_hasPendingOwnershipAcquire, "The Buffer is released while an earlier release isn't acquired yet");
+   m_pendingOwnershipAcquire = p_acquire;
+   m_hasPendingOwnershipAcquire = true;
+   m_ownedByConsumer = true;
+}
+
+bool Buffer::ConsumePendingOwnershipAcquire(uint32_t p_queueFamilyIndex, QueueFamilyOwnershipAcquire& p_acquire)
+{
+   std::lock_guard<std::mutex> lock(m_ownershipMutex);
+   if (!m_hasPendingOwnershipAcquire || m_pendingOwnershipAcquire.m_dstQueueFamilyIndex != p_queueFamilyIndex)
+   {
+      return false;
+   }
+
+   p_acquire = m_pendingOwnershipAcquire;
+   m_hasPendingOwnershipAcquire = false;
+   return true;
+}
+
+bool Buffer::IsShared() const
+{
+   return m_isShared;
+}
+
+void Buffer::MarkShared()
+{
+   m_isShared = true;
+}
+
+void Buffer::MarkOwnedByConsumer()
+{
+   m_ownedByConsumer = true;
+}
+
+bool Buffer::IsOwnedByConsumer() const
+{
+   return m_ownedByConsumer;
+}
+
+VkDeviceAddress Buffer::GetDeviceAddress() const
+{
+   ASSERT(m_deviceAddress != 0u, "Buffer wasn't created with the ShaderDeviceAddress usage");
+   return m_deviceAddress;
+}
+
+bool Buffer::IsHostVisible() const
+{
+   return static_cast<uint32_t>(m_memoryProperties) & static_cast<uint32_t>(MemoryPropertyFlags::HostVisible);
+}
+
+bool Buffer::IsImportedHostMemory() const
+{
+   return m_importedHostMemory;
+}
+
 void* Buffer::Map(uint64_t p_offset, uint64_t p_size /*= WholeSize*/)
 {
    if (p_size != WholeSize && p_size + p_offset > m_bufferSizeRequested)
    {
       ASSERT(false, "Mapped data range out of bounds");
    }
-   // TODO: Should we support multiple mapped regions?
-   ASSERT(m_mappedData == nullptr, "Buffer is already mapped");
+   ASSERT(IsHostVisible(), "Only HostVisible Buffers can be mapped");
+   ASSERT(!m_isShared, "Buffer is shared by the ImmutableBufferCache, it can't be mapped");
 
-   vkMapMemory(m_vulkanDevice->GetLogicalDeviceNative(), GetDeviceMemoryNative(), p_offset, GetBufferSizeAllocated(), {},
-               &m_mappedData);
+   std::lock_guard<std::mutex> lock(m_mapMutex);
 
-   return m_mappedData;
+   // Mapping is expensive, and a memory object can only be mapped once. Map the whole memory once, and hand out ranges of it
+   if (m_mappedData == nullptr)
+   {
+      [[maybe_unused]] const VkResult res =
+          vkMapMemory(m_vulkanDevice->GetLogicalDeviceNative(), GetDeviceMemoryNative(), 0u, VK_WHOLE_SIZE, {}, &m_mappedData);
+      ASSERT(res == VK_SUCCESS, "Failed to map the Buffer");
+   }
+   m_mapCount++;
+
+   return static_cast<uint8_t*>(m_mappedData) + p_offset;
 }
 
 void Buffer::Unmap()
 {
-   ASSERT(m_mappedData != nullptr, "Buffer isn't mapped");
+   std::lock_guard<std::mutex> lock(m_mapMutex);
+   ASSERT(m_mapCount > 0u, "Buffer isn't mapped");
+
+   // The memory stays mapped persistently, it's unmapped when the Buffer is destroyed
+   m_mapCount--;
+}
+
+void Buffer::FlushMappedRange(uint64_t p_offset, uint64_t p_size)
+{
+   if (static_cast<uint32_t>(m_memoryProperties) & static_cast<uint32_t>(MemoryPropertyFlags::HostCoherent))
+   {
+      return;
+   }
+
+   // Flushed ranges must be aligned to the atom size of the device, or reach the end of the memory
+   const uint64_t atomSize = m_vulkanDevice->GetPhysicalDeviceProperties().limits.nonCoherentAtomSize;
+   const uint64_t alignedOffset = p_offset / atomSize * atomSize;
+   const uint64_t alignedEnd = (p_offset + p_size + atomSize - 1u) / atomSize * atomSize;
 
-   vkUnmapMemory(m_vulkanDevice->GetLogicalDeviceNative(), GetDeviceMemoryNative());
+   const VkMappedMemoryRange mappedMemoryRange{
+       .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+       .pNext = nullptr,
+       .memory = GetDeviceMemoryNative(),
+       .offset = alignedOffset,
+       .size = alignedEnd >= GetBufferSizeAllocated() ? VK_WHOLE_SIZE : alignedEnd - alignedOffset};
+   [[maybe_unused]] const VkResult res =
+       vkFlushMappedMemoryRanges(m_vulkanDevice->GetLogicalDeviceNative(), 1u, &mappedMemoryRange);
+   ASSERT(res == VK_SUCCESS, "Failed to flush the mapped range of the Buffer");
 }
 
 } // namespace Render
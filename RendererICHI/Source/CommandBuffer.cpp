@@ -4,6 +4,8 @@
 #include <CommandPoolManagerInterface.h>
 #include <CommandPool.h>
 #include <VulkanDevice.h>
+#include <Buffer.h>
+#include <Image.h>
 
 namespace Render
 {
@@ -33,6 +35,11 @@ VkCommandBuffer CommandBufferBase::GetCommandBufferNative() const
    return m_commandBufferNative;
 }
 
+const UploadTicket& CommandBufferBase::GetUploadTicket() const
+{
+   return m_uploadTicket;
+}
+
 bool CommandBufferBase::IsCompiled() const
 {
    return m_commandBufferNative != VK_NULL_HANDLE;
@@ -48,6 +55,53 @@ void CommandBufferBase::SetCommandBufferNative(VkCommandBuffer p_commandBuffer)
    m_commandBufferNative = p_commandBuffer;
 }
 
+void CommandBufferBase::AddUploadDependency(const UploadTicket& p_uploadTicket)
+{
+   m_uploadTicket = MergeUploadTickets(m_uploadTicket, p_uploadTicket);
+}
+
+void CommandBufferBase::AddOwnershipAcquire(Ptr<Buffer> p_buffer)
+{
+   // Later uploads to the Buffer can't be recorded on the transfer QueueFamily anymore
+   if (GetQueueType() != QueueFamilyType::TransferQueue)
+   {
+      p_buffer->MarkOwnedByConsumer();
+   }
+
+   QueueFamilyOwnershipAcquire acquire;
+   if (p_buffer->ConsumePendingOwnershipAcquire(m_vulkanDevice->GetQueueFamilyIndex(GetQueueType()), acquire))
+   {
+      // The release is recorded by another submit, the acquire isn't ordered after it without waiting for that submit
+      AddUploadDependency(acquire.m_releaseUploadTicket);
+      m_bufferOwnershipAcquires.push_back(BufferOwnershipAcquire{.m_buffer = p_buffer, .m_acquire = acquire});
+   }
+}
+
+void CommandBufferBase::AddOwnershipAcquire(Ptr<Image> p_image)
+{
+   if (GetQueueType() != QueueFamilyType::TransferQueue)
+   {
+      p_image->MarkOwnedByConsumer();
+   }
+
+   QueueFamilyOwnershipAcquire acquire;
+   if (p_image->ConsumePendingOwnershipAcquire(m_vulkanDevice->GetQueueFamilyIndex(GetQueueType()), acquire))
+   {
+      AddUploadDependency(acquire.m_releaseUploadTicket);
+      m_imageOwnershipAcquires.push_back(ImageOwnershipAcquire{.m_image = p_image, .m_acquire = acquire});
+   }
+}
+
+void CommandBufferBase::AddReferencedResource(const void* p_owner)
+{
+   m_referencedResources.push_back(p_owner);
+}
+
+bool CommandBufferBase::CanRecordTransferCommands() const
+{
+   return !m_isRendering && !m_isSubCommandBuffer;
+}
+
 void CommandBufferBase::Record()
 {
    ASSERT(m_commandBufferNative != VK_NULL_HANDLE, "No Vulkan CommandBuffer is set");
@@ -64,6 +118,10 @@ void CommandBufferBase::Record()
 
    res = vkEndCommandBuffer(m_commandBufferNative);
    ASSERT(res == VK_SUCCESS, "Failed to end a Buffer resource");
+
+   // Report all the referenced resources with a single call, instead of locking the ResourceTracker per command
+   ResourceTrackerInterface::Get()->MarkReferenced(m_referencedResources);
+   m_referencedResources.clear();
 }
 
 // ----------- SubCommandBuffer -----------
@@ -74,6 +132,7 @@ SubCommandBuffer::SubCommandBuffer(SubCommandBufferDescriptor&& p_desc)
     : CommandBufferBase(static_cast<CommandBufferBaseDescriptor>(p_desc))
 {
    m_vulkanDevice = p_desc.m_vulkanDevice;
+   m_isSubCommandBuffer = true;
 }
 
 SubCommandBuffer::~SubCommandBuffer()
@@ -96,6 +155,7 @@ SubCommandBuffer* CommandBuffer::CreateSubCommandBuffer()
 {
    SubCommandBufferDescriptor desc;
    desc.m_vulkanDevice = m_vulkanDevice;
+   desc.m_queueType = GetQueueType();
 
    Ptr<SubCommandBuffer> subCommandBuffer = SubCommandBuffer::CreateInstance(eastl::move(desc));
    m_subCommandBuffers.push_back(subCommandBuffer);
@@ -107,12 +167,17 @@ void CommandBuffer::Compile()
 {
    ASSERT(IsCompiled() == false, "Can't compile a CommandBuffer twice");
 
-   if (m_subCommandBuffers.size())
-   {
-   }
-
    // Validate
    // Add additional commands for the sub command buffers
+   InsertCommands();
+
+   // The submit waits for the uploads on the GPU, they have to be submitted before it. Flush them now, outside of the submit path
+   UploadTicket uploadTicket = m_uploadTicket;
+   for (Ptr<SubCommandBuffer>& subCommandBuffer : m_subCommandBuffers)
+   {
+      uploadTicket = MergeUploadTickets(uploadTicket, subCommandBuffer->GetUploadTicket());
+   }
+   AsyncUploadQueueInterface::Get()->FlushUpload(uploadTicket);
 
    // Compile the CommandBuffer with native render commands
    CommandPoolManagerInterface::Get()->CompileCommandBuffer(this);
@@ -120,6 +185,49 @@ void CommandBuffer::Compile()
 
 void CommandBuffer::InsertCommands()
 {
+   // Gather the QueueFamily ownership acquires of this CommandBuffer and all the SubCommandBuffers
+   Std::vector<BufferOwnershipAcquire> bufferAcquires = eastl::move(m_bufferOwnershipAcquires);
+   Std::vector<ImageOwnershipAcquire> imageAcquires = eastl::move(m_imageOwnershipAcquires);
+   for (Ptr<SubCommandBuffer>& subCommandBuffer : m_subCommandBuffers)
+   {
+      bufferAcquires.insert(bufferAcquires.end(), subCommandBuffer->m_bufferOwnershipAcquires.begin(),
+                            subCommandBuffer->m_bufferOwnershipAcquires.end());
+      imageAcquires.insert(imageAcquires.end(), subCommandBuffer->m_imageOwnershipAcquires.begin(),
+                           subCommandBuffer->m_imageOwnershipAcquires.end());
+      subCommandBuffer->m_bufferOwnershipAcquires.clear();
+      subCommandBuffer->m_imageOwnershipAcquires.clear();
+   }
+
+   if (bufferAcquires.empty() && imageAcquires.empty())
+   {
+      return;
+   }
+
+   // The acquires have to happen before any command uses the resources, record them at the start of the CommandBuffer. The
+   // upload dependency that is added with each acquire makes the submit wait for the release.
+   PipelineBarrierCommand* acquireBarrier = PipelineBarrier();
+   for (const BufferOwnershipAcquire& bufferAcquire : bufferAcquires)
+   {
+      acquireBarrier->AddBufferBarrier(VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                                       VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
+                                       bufferAcquire.m_acquire.m_srcQueueFamilyIndex,
+                                       bufferAcquire.m_acquire.m_dstQueueFamilyIndex, bufferAcquire.m_buffer, 0u, VK_WHOLE_SIZE);
+   }
+
+   for (const ImageOwnershipAcquire& imageAcquire : imageAcquires)
+   {
+      const VkImageSubresourceRange& subresourceRange = imageAcquire.m_acquire.m_subresourceRange;
+      acquireBarrier->AddImageBarrier(VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                                      VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
+                                      imageAcquire.m_acquire.m_oldLayout, imageAcquire.m_acquire.m_newLayout,
+                                      imageAcquire.m_acquire.m_srcQueueFamilyIndex, imageAcquire.m_acquire.m_dstQueueFamilyIndex,
+                                      imageAcquire.m_image, subresourceRange);
+   }
+
+   // PipelineBarrier appends the command, move it to the front
+   Std::unique_ptr<RenderCommand> acquireCommand = eastl::move(m_renderCommands.back());
+   m_renderCommands.pop_back();
+   m_renderCommands.insert(m_renderCommands.begin(), eastl::move(acquireCommand));
 }
 
 uint32_t CommandBuffer::GetSubCommandBufferCount() const
@@ -1,16 +1,51 @@
 #include <CommandBuffer.h>
 
+#include <Util/Assert.h>
+
 #include <CommandPool.h>
 #include <VulkanDevice.h>
 #include <RenderCommands.h>
 #include <CommandPoolManager.h>
 #include <Buffer.h>
 #include <GraphicsPipeline.h>
+#include <ComputePipeline.h>
 #include <BufferView.h>
+#include <DescriptorSet.h>
+#include <Image.h>
 
 namespace Render
 {
 
+namespace
+{
+namespace Internal
+{
+// Orders the transfer write of UpdateBuffer and FillBuffer against all the commands that access the range before, or after it
+void AddTransferWriteBarrier(PipelineBarrierCommand* p_pipelineBarrier, Ptr<Buffer> p_buffer, uint64_t p_offset, uint64_t p_size,
+                             bool p_beforeWrite)
+{
+   const VkPipelineStageFlags2 allCommands = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+   const VkAccessFlags2 allAccesses = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+   const VkPipelineStageFlags2 transfer = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+   const VkAccessFlags2 transferWrite = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+
+   ASSERT(static_cast<uint32_t>(p_buffer->GetUsageFlags()) & static_cast<uint32_t>(BufferUsageFlags::TransferDestination),
+          "Buffer must be created with the TransferDestination usage");
+
+   if (p_beforeWrite)
+   {
+      p_pipelineBarrier->AddBufferBarrier(allCommands, allAccesses, transfer, transferWrite, VK_QUEUE_FAMILY_IGNORED,
+                                          VK_QUEUE_FAMILY_IGNORED, p_buffer, p_offset, p_size);
+   }
+   else
+   {
+      p_pipelineBarrier->AddBufferBarrier(transfer, transferWrite, allCommands, allAccesses, VK_QUEUE_FAMILY_IGNORED,
+                                          VK_QUEUE_FAMILY_IGNORED, p_buffer, p_offset, p_size);
+   }
+}
+}; // namespace Internal
+}; // namespace
+
 // ----------- CommandBufferBase Render Commands -----------
 
 void CommandBufferBase::SetLineWidth(float p_lineWidth)
@@ -71,6 +106,12 @@ void CommandBufferBase::SetScissorWithCount(Std::span<VkRect2D> p_viewports)
 void CommandBufferBase::BindVertexBuffers(uint32_t p_firstBinding,
                                           Std::span<BindVertexBuffersCommand::VertexBufferView> p_vertexBufferViews)
 {
+   for (const BindVertexBuffersCommand::VertexBufferView& vertexBufferView : p_vertexBufferViews)
+   {
+      AddUploadDependency(vertexBufferView.m_vertexBufferView->GetBuffer()->GetUploadTicket());
+      AddOwnershipAcquire(vertexBufferView.m_vertexBufferView->GetBuffer());
+   }
+
    m_renderCommands.emplace_back(new BindVertexBuffersCommand(p_firstBinding, p_vertexBufferViews));
 }
 
@@ -118,6 +159,15 @@ void CommandBufferBase::SetPrimitiveRestartEnable(bool p_primitiveRestartEnable)
 void CommandBufferBase::BindDescriptorSets(PipelineBindPoint p_pipelineBindPoint, Ptr<GraphicsPipeline> p_graphicsPipeline,
                                            uint32_t p_firstSet, Std::span<Ptr<DescriptorSet>> p_descriptorSets)
 {
+   for (const Ptr<DescriptorSet>& descriptorSet : p_descriptorSets)
+   {
+      AddUploadDependency(descriptorSet->GetUploadTicket());
+      for (const Ptr<Buffer>& buffer : descriptorSet->GetUploadedBuffers())
+      {
+         AddOwnershipAcquire(buffer);
+      }
+   }
+
    m_renderCommands.emplace_back(
        new BindDescriptorSetsCommand(p_pipelineBindPoint, p_graphicsPipeline, p_firstSet, p_descriptorSets));
 }
@@ -127,6 +177,24 @@ void CommandBufferBase::BindPipeline(PipelineBindPoint p_pipelineBindPoint, Ptr<
    m_renderCommands.emplace_back(new BindPipelineCommand(p_pipelineBindPoint, p_graphicsPipeline));
 }
 
+void CommandBufferBase::BindPipeline(Ptr<ComputePipeline> p_computePipeline)
+{
+   m_renderCommands.emplace_back(new BindPipelineCommand(p_computePipeline));
+}
+
+void CommandBufferBase::PushConstants(Ptr<ComputePipeline> p_computePipeline, uint32_t p_offset, const void* p_data,
+                                      uint32_t p_dataSize)
+{
+   ASSERT(p_offset + p_dataSize <= p_computePipeline->GetPushConstantSizeInBytes(), "Push constants are out of range");
+
+   m_renderCommands.emplace_back(new PushConstantsCommand(p_computePipeline, p_offset, p_data, p_dataSize));
+}
+
+void CommandBufferBase::Dispatch(uint32_t p_groupCountX, uint32_t p_groupCountY, uint32_t p_groupCountZ)
+{
+   m_renderCommands.emplace_back(new DispatchCommand(p_groupCountX, p_groupCountY, p_groupCountZ));
+}
+
 void CommandBufferBase::SetDepthBounds(float p_minDepthBounds, float p_maxDepthBounds)
 {
    m_renderCommands.emplace_back(new SetDepthBoundsCommand(p_minDepthBounds, p_maxDepthBounds));
@@ -134,6 +202,9 @@ void CommandBufferBase::SetDepthBounds(float p_minDepthBounds, float p_maxDepthB
 
 void CommandBufferBase::BindIndexBuffer(Ptr<BufferView> p_indexBuffer, IndexType p_indexType)
 {
+   AddUploadDependency(p_indexBuffer->GetBuffer()->GetUploadTicket());
+   AddOwnershipAcquire(p_indexBuffer->GetBuffer());
+
    m_renderCommands.emplace_back(new BindIndexBufferCommand(p_indexBuffer, p_indexType));
 }
 
@@ -144,6 +215,9 @@ void CommandBufferBase::ExecuteCommands(Std::span<SubCommandBuffer*> p_subComman
 
 void CommandBufferBase::EndRendering()
 {
+   ASSERT(m_isRendering, "EndRendering is recorded without BeginRendering");
+   m_isRendering = false;
+
    m_renderCommands.emplace_back(new EndRenderingCommand());
 }
 
@@ -164,12 +238,109 @@ void CommandBufferBase::DrawIndexed(uint32_t p_indexCount, uint32_t p_instanceCo
 
 void CommandBufferBase::CopyBuffer(Ptr<Buffer> p_srcBuffer, Ptr<Buffer> p_destBuffer, Std::span<BufferCopyRegion> p_copyRegions)
 {
+   ASSERT(CanRecordTransferCommands(), "CopyBuffer can't be recorded while rendering, or in a SubCommandBuffer");
+   ASSERT(m_recordsUploads || !p_destBuffer->IsShared(), "Buffer is shared by the ImmutableBufferCache, it can't be written");
+
+   // The copy writes the destination, which can still be uploading. Readers of the destination also wait for the upload of the
+   // source
+   AddUploadDependency(p_srcBuffer->GetUploadTicket());
+   AddUploadDependency(p_destBuffer->GetUploadTicket());
+   p_destBuffer->MergeUploadTicket(p_srcBuffer->GetUploadTicket());
+   AddOwnershipAcquire(p_srcBuffer);
+   AddOwnershipAcquire(p_destBuffer);
+
    m_renderCommands.emplace_back(new CopyBufferCommand(p_srcBuffer, p_destBuffer, p_copyRegions));
 }
 
+void CommandBufferBase::UpdateBuffer(Ptr<Buffer> p_destBuffer, uint64_t p_destOffset, const void* p_data, uint64_t p_dataSize)
+{
+   Internal::AddTransferWriteBarrier(PipelineBarrier(), p_destBuffer, p_destOffset, p_dataSize, true);
+   UpdateBufferWithoutBarriers(p_destBuffer, p_destOffset, p_data, p_dataSize);
+   Internal::AddTransferWriteBarrier(PipelineBarrier(), p_destBuffer, p_destOffset, p_dataSize, false);
+}
+
+void CommandBufferBase::UpdateBufferWithoutBarriers(Ptr<Buffer> p_destBuffer, uint64_t p_destOffset, const void* p_data,
+                                                    uint64_t p_dataSize)
+{
+   ASSERT(CanRecordTransferCommands(), "UpdateBuffer can't be recorded while rendering, or in a SubCommandBuffer");
+   ASSERT(!p_destBuffer->IsShared(), "Buffer is shared by the ImmutableBufferCache, it can't be written");
+   ASSERT(p_dataSize > 0u && p_dataSize <= UpdateBufferCommand::MaxDataSizeInBytes, "Payload size isn't supported by UpdateBuffer");
+   ASSERT(p_destOffset % 4u == 0u && p_dataSize % 4u == 0u, "Offset and size of UpdateBuffer must be a multiple of 4");
+   ASSERT(p_destOffset + p_dataSize <= p_destBuffer->GetBufferSizeRequested(), "Range is out of the bounds of the Buffer");
+
+   AddOwnershipAcquire(p_destBuffer);
+
+   m_renderCommands.emplace_back(new UpdateBufferCommand(p_destBuffer, p_destOffset, p_data, p_dataSize));
+}
+
+void CommandBufferBase::FillBuffer(Ptr<Buffer> p_destBuffer, uint64_t p_destOffset, uint64_t p_size, uint32_t p_data)
+{
+   ASSERT(CanRecordTransferCommands(), "FillBuffer can't be recorded while rendering, or in a SubCommandBuffer");
+   ASSERT(!p_destBuffer->IsShared(), "Buffer is shared by the ImmutableBufferCache, it can't be written");
+   ASSERT(p_destOffset % 4u == 0u, "Offset of FillBuffer must be a multiple of 4");
+   ASSERT(p_size == VK_WHOLE_SIZE || (p_size > 0u && p_size % 4u == 0u), "Size of FillBuffer must be a multiple of 4");
+   ASSERT(p_size == VK_WHOLE_SIZE || p_destOffset + p_size <= p_destBuffer->GetBufferSizeRequested(),
+          "Range is out of the bounds of the Buffer");
+
+   AddOwnershipAcquire(p_destBuffer);
+
+   Internal::AddTransferWriteBarrier(PipelineBarrier(), p_destBuffer, p_destOffset, p_size, true);
+   m_renderCommands.emplace_back(new FillBufferCommand(p_destBuffer, p_destOffset, p_size, p_data));
+   Internal::AddTransferWriteBarrier(PipelineBarrier(), p_destBuffer, p_destOffset, p_size, false);
+}
+
+void CommandBufferBase::CopyBufferToImage(Ptr<Buffer> p_srcBuffer, Ptr<Image> p_destImage, VkImageLayout p_destImageLayout,
+                                          Std::span<BufferImageCopyRegion> p_copyRegions)
+{
+   ASSERT(CanRecordTransferCommands(), "CopyBufferToImage can't be recorded while rendering, or in a SubCommandBuffer");
+
+   AddUploadDependency(p_srcBuffer->GetUploadTicket());
+   AddOwnershipAcquire(p_srcBuffer);
+   AddOwnershipAcquire(p_destImage);
+
+   m_renderCommands.emplace_back(new CopyBufferToImageCommand(p_srcBuffer, p_destImage, p_destImageLayout, p_copyRegions));
+}
+
+void CommandBufferBase::CopyImageToBuffer(Ptr<Image> p_srcImage, VkImageLayout p_srcImageLayout, Ptr<Buffer> p_destBuffer,
+                                          Std::span<BufferImageCopyRegion> p_copyRegions)
+{
+   ASSERT(CanRecordTransferCommands(), "CopyImageToBuffer can't be recorded while rendering, or in a SubCommandBuffer");
+
+   AddOwnershipAcquire(p_srcImage);
+   AddOwnershipAcquire(p_destBuffer);
+
+   m_renderCommands.emplace_back(new CopyImageToBufferCommand(p_srcImage, p_srcImageLayout, p_destBuffer, p_copyRegions));
+}
+
+void CommandBufferBase::CopyImage(Ptr<Image> p_srcImage, VkImageLayout p_srcImageLayout, Ptr<Image> p_destImage,
+                                  VkImageLayout p_destImageLayout, Std::span<ImageCopyRegion> p_copyRegions)
+{
+   ASSERT(CanRecordTransferCommands(), "CopyImage can't be recorded while rendering, or in a SubCommandBuffer");
+
+   AddOwnershipAcquire(p_srcImage);
+   AddOwnershipAcquire(p_destImage);
+
+   m_renderCommands.emplace_back(new CopyImageCommand(p_srcImage, p_srcImageLayout, p_destImage, p_destImageLayout, p_copyRegions));
+}
+
+void CommandBufferBase::BlitImage(Ptr<Image> p_srcImage, VkImageLayout p_srcImageLayout, Ptr<Image> p_destImage,
+                                  VkImageLayout p_destImageLayout, Std::span<ImageBlitRegion> p_blitRegions, VkFilter p_filter)
+{
+   ASSERT(CanRecordTransferCommands(), "BlitImage can't be recorded while rendering, or in a SubCommandBuffer");
+
+   AddOwnershipAcquire(p_srcImage);
+   AddOwnershipAcquire(p_destImage);
+
+   m_renderCommands.emplace_back(
+       new BlitImageCommand(p_srcImage, p_srcImageLayout, p_destImage, p_destImageLayout, p_blitRegions, p_filter));
+}
+
 void CommandBufferBase::BeginRendering(VkRect2D p_renderArea, Std::span<RenderingAttachmentInfo> p_colorAttachments,
                                        RenderingAttachmentInfo& p_depthAttachment, RenderingAttachmentInfo& p_stencilAttachment)
 {
+   ASSERT(!m_isRendering, "BeginRendering is recorded while already rendering");
+   m_isRendering = true;
+
    m_renderCommands.emplace_back(
        new BeginRenderingCommand(p_renderArea, p_colorAttachments, p_depthAttachment, p_stencilAttachment));
 }
@@ -22,12 +22,20 @@ CommandPool::CommandPool(CommandPoolDescriptor&& p_desc)
    [[maybe_unused]] const VkResult result =
        vkCreateCommandPool(m_vulkanDeviceRef->GetLogicalDeviceNative(), &cmdPoolInfo, nullptr, &m_commandPoolNative);
    ASSERT(result == VK_SUCCESS, "Failed to create a CommandPool");
+
+   // CommandPool memory is owned by the driver, only the usage is reported
+   ResourceTrackerInterface::Get()->ReportAllocation(
+       this, MemoryTelemetryRecord{.m_category = MemoryTelemetryCategory::CommandPool,
+                                   .m_resource = this,
+                                   .m_usageFlags = static_cast<uint32_t>(cmdPoolInfo.flags)});
 }
 
 CommandPool::~CommandPool()
 {
    ASSERT(m_allocatedCommandBuffers.size() == 0u, "There are still CommandBuffers allocated with this CommandPool");
 
+   ResourceTrackerInterface::Get()->ReportDeallocation(this);
+
    vkResetCommandPool(m_vulkanDeviceRef->GetLogicalDeviceNative(), m_commandPoolNative,
                       VK_COMMAND_POOL_RESET_RELEASE_RESOURCES_BIT);
 
@@ -60,6 +68,8 @@ void CommandPool::AllocateCommandBuffer(Ptr<CommandBufferBase> p_commandBuffer,
    p_commandBuffer->SetCommandBufferNative(commandBufferNative);
 
    m_allocatedCommandBuffers.emplace(p_commandBuffer.get());
+
+   ResourceTrackerInterface::Get()->MarkReferenced(this);
 }
 
 void CommandPool::FreeQueuedCommandBuffers()
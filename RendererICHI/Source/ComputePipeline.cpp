@@ -0,0 +1,83 @@
+#include <ComputePipeline.h>
+
+#include <vulkan/vulkan.h>
+
+#include <Util/Assert.h>
+
+#include <DescriptorSetLayout.h>
+#include <ShaderStage.h>
+#include <VulkanDevice.h>
+
+namespace Render
+{
+
+ComputePipeline::ComputePipeline(ComputePipelineDescriptor&& p_desc)
+{
+   m_vulkanDevice = p_desc.m_vulkanDevice;
+   m_shaderStage = p_desc.m_shaderStage;
+   m_descriptorSetLayouts = p_desc.m_descriptorSetLayouts;
+   m_pushConstantSizeInBytes = p_desc.m_pushConstantSizeInBytes;
+
+   ASSERT(m_shaderStage, "A ComputePipeline requires a compute ShaderStage");
+
+   // Create the PipelineLayout
+   {
+      Std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
+      for (Ptr<DescriptorSetLayout>& descriptorSetLayout : m_descriptorSetLayouts)
+      {
+         descriptorSetLayouts.push_back(descriptorSetLayout->GetDescriptorSetLayoutNative());
+      }
+
+      const VkPushConstantRange pushConstantRange{
+          .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT, .offset = 0u, .size = m_pushConstantSizeInBytes};
+
+      VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {};
+      pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+      pipelineLayoutCreateInfo.pNext = nullptr;
+      pipelineLayoutCreateInfo.flags = 0u;
+      pipelineLayoutCreateInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
+      pipelineLayoutCreateInfo.pSetLayouts = descriptorSetLayouts.data();
+      pipelineLayoutCreateInfo.pushConstantRangeCount = m_pushConstantSizeInBytes > 0u ? 1u : 0u;
+      pipelineLayoutCreateInfo.pPushConstantRanges = m_pushConstantSizeInBytes > 0u ? &pushConstantRange : nullptr;
+
+      [[maybe_unused]] const VkResult res =
+          vkCreatePipelineLayout(m_vulkanDevice->GetLogicalDeviceNative(), &pipelineLayoutCreateInfo, nullptr, &m_pipelineLayout);
+      ASSERT(res == VK_SUCCESS, "Failed to create a PipelineLayoutCreateInfo resource");
+   }
+
+   VkComputePipelineCreateInfo pipelineCreateInfo = {};
+   pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+   pipelineCreateInfo.pNext = nullptr;
+   pipelineCreateInfo.flags = 0u;
+   pipelineCreateInfo.stage = m_shaderStage->GetShaderStageCreateInfoNative();
+   pipelineCreateInfo.layout = m_pipelineLayout;
+   pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+   pipelineCreateInfo.basePipelineIndex = -1;
+
+   [[maybe_unused]] const VkResult res = vkCreateComputePipelines(m_vulkanDevice->GetLogicalDeviceNative(), VK_NULL_HANDLE, 1u,
+                                                                  &pipelineCreateInfo, nullptr, &m_computePipeline);
+   ASSERT(res == VK_SUCCESS, "Failed to create a ComputePipeline resource");
+}
+
+ComputePipeline::~ComputePipeline()
+{
+   vkDestroyPipelineLayout(m_vulkanDevice->GetLogicalDeviceNative(), m_pipelineLayout, nullptr);
+   vkDestroyPipeline(m_vulkanDevice->GetLogicalDeviceNative(), m_computePipeline, nullptr);
+}
+
+const VkPipelineLayout ComputePipeline::GetComputePipelineLayoutNative() const
+{
+   return m_pipelineLayout;
+}
+
+const VkPipeline ComputePipeline::GetComputePipelineNative() const
+{
+   return m_computePipeline;
+}
+
+uint32_t ComputePipeline::GetPushConstantSizeInBytes() const
+{
+   return m_pushConstantSizeInBytes;
+}
+
+} // namespace Render
@@ -16,6 +16,17 @@ DescriptorPool::DescriptorPool(DescriptorPoolDescriptor&& p_desc)
    m_descriptorSetLayout = p_desc.m_descriptorSetLayout;
    m_vulkanDevice = p_desc.m_vulkanDevice;
 
+   ASSERT(p_desc.m_maxDescriptorSets > 0u, "DescriptorPool needs to be able to allocate at least one DescriptorSet");
+
+   // All the slots are free, pop them from the back in order
+   m_descriptorSetsNative.resize(p_desc.m_maxDescriptorSets, VK_NULL_HANDLE);
+   m_returnedSlotLinks.resize(p_desc.m_maxDescriptorSets, InvalidIndex);
+   m_freeSlots.reserve(p_desc.m_maxDescriptorSets);
+   for (uint32_t slot = p_desc.m_maxDescriptorSets; slot > 0u; slot--)
+   {
+      m_freeSlots.push_back(slot - 1u);
+   }
+
    // Create the DescriptorPoolSizes
    Std::span<const LayoutBinding> descriptorSetLayoutBindings = m_descriptorSetLayout->GetDescriptorSetlayoutBindings();
 
@@ -25,7 +36,7 @@ DescriptorPool::DescriptorPool(DescriptorPoolDescriptor&& p_desc)
       VkDescriptorPoolSize descriptorPoolSize;
       descriptorPoolSize.type = RenderTypeToNative::DescriptorTypeToNative(descriptorSetLayoutBinding.descriptorType);
       descriptorPoolSize.descriptorCount =
-          descriptorSetLayoutBinding.descriptorCount * DescriptorPoolManagerInterface::DescriptorSetInstanceCount;
+          descriptorSetLayoutBinding.descriptorCount * p_desc.m_maxDescriptorSets;
       m_descriptorPoolSizes.push_back(descriptorPoolSize);
    }
 
@@ -34,57 +45,128 @@ DescriptorPool::DescriptorPool(DescriptorPoolDescriptor&& p_desc)
    descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
    descriptorPoolInfo.pNext = nullptr;
    descriptorPoolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT | VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
-   // TODO: For now, create 12 sets per DescriptorPool
-   descriptorPoolInfo.maxSets = 36u;
+   descriptorPoolInfo.maxSets = p_desc.m_maxDescriptorSets;
    descriptorPoolInfo.poolSizeCount = static_cast<uint32_t>(m_descriptorPoolSizes.size());
    descriptorPoolInfo.pPoolSizes = m_descriptorPoolSizes.data();
 
    [[maybe_unused]] const VkResult result =
        vkCreateDescriptorPool(m_vulkanDevice->GetLogicalDeviceNative(), &descriptorPoolInfo, nullptr, &m_descriptorPoolNative);
    ASSERT(result == VK_SUCCESS, "Failed to create the DescriptorPool");
+
+   // DescriptorPool memory is owned by the driver, report the amount of descriptors instead
+   uint32_t descriptorCount = 0u;
+   for (const VkDescriptorPoolSize& descriptorPoolSize : m_descriptorPoolSizes)
+   {
+      descriptorCount += descriptorPoolSize.descriptorCount;
+   }
+   ResourceTrackerInterface::Get()->ReportAllocation(
+       this, MemoryTelemetryRecord{.m_category = MemoryTelemetryCategory::DescriptorPool,
+                                   .m_resource = this,
+                                   .m_usageFlags = static_cast<uint32_t>(descriptorPoolInfo.flags),
+                                   .m_elementCount = descriptorCount});
 }
 
 DescriptorPool::~DescriptorPool()
 {
+   // The last DescriptorSets can be returned after the DescriptorPoolManager is gone
+   FreeReturnedDescriptorSets();
    ASSERT(GetAllocatedDescriptorSetCount() == 0u, "There are still DescriptorSets alloated from this pool");
 
+   ResourceTrackerInterface::Get()->ReportDeallocation(this);
+
    vkDestroyDescriptorPool(m_vulkanDevice->GetLogicalDeviceNative(), m_descriptorPoolNative, nullptr);
 }
 
 bool DescriptorPool::IsDescriptorSetSlotAvailable() const
 {
-   std::lock_guard<std::mutex> guard(m_mutex);
+   return !m_freeSlots.empty() || m_returnedSlotHead.load() != InvalidIndex;
+}
+
+void DescriptorPool::AllocateDescriptorSet(DescriptorSet* p_descriptorSet)
+{
+   FreeReturnedDescriptorSets();
+   ASSERT(!m_freeSlots.empty(), "There are no DescriptorSet slots available in this pool");
+
+   const uint32_t slot = m_freeSlots.back();
+   m_freeSlots.pop_back();
+
+   const VkDescriptorSetLayout descriptorSetLayoutNative = GetDescriptorSetLayoutNative();
+   VkDescriptorSetAllocateInfo info = {};
+   info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+   info.descriptorPool = m_descriptorPoolNative;
+   info.descriptorSetCount = 1u;
+   info.pSetLayouts = &descriptorSetLayoutNative;
+
+   const VkResult result =
+       vkAllocateDescriptorSets(m_vulkanDevice->GetLogicalDeviceNative(), &info, &m_descriptorSetsNative[slot]);
+   if (result == VK_ERROR_OUT_OF_HOST_MEMORY || result == VK_ERROR_OUT_OF_DEVICE_MEMORY)
+   {
+      ASSERT(false, "Failed to allocate a DescriptorSet from the DescriptorPool");
+   }
+   else if (result == VK_ERROR_FRAGMENTED_POOL)
+   {
+      ASSERT(false, "DescriptorPool is too fragmented");
+   }
+
+   m_allocatedDescriptorSetCount++;
 
-   return GetAllocatedDescriptorSetCount() < DescriptorPoolManagerInterface::DescriptorSetInstanceCount;
+   p_descriptorSet->SetDescriptorPool(this, slot, m_descriptorSetsNative[slot]);
 }
 
-void DescriptorPool::RegisterDescriptorSet(DescriptorSet* p_descriptorSet)
+void DescriptorPool::FreeReturnedDescriptorSets()
 {
-   std::lock_guard<std::mutex> guard(m_mutex);
+   // Take the whole stack, the links of the returned slots aren't touched until they're allocated again
+   uint32_t slot = m_returnedSlotHead.exchange(InvalidIndex);
+   if (slot == InvalidIndex)
+   {
+      return;
+   }
 
-   auto setIt = m_descriptorSets.find(p_descriptorSet);
-   ASSERT(setIt == m_descriptorSets.end(), "The DescriptorSet already exists");
+   Std::vector<VkDescriptorSet> descriptorSetsNative;
+   for (; slot != InvalidIndex; slot = m_returnedSlotLinks[slot])
+   {
+      ASSERT(m_descriptorSetsNative[slot] != VK_NULL_HANDLE, "DescriptorSet isn't allocated in this pool");
 
-   m_descriptorSets.insert(p_descriptorSet);
+      descriptorSetsNative.push_back(m_descriptorSetsNative[slot]);
+      m_descriptorSetsNative[slot] = VK_NULL_HANDLE;
+      m_freeSlots.push_back(slot);
+   }
 
-   p_descriptorSet->SetDescriptorPool(this);
+   vkFreeDescriptorSets(m_vulkanDevice->GetLogicalDeviceNative(), m_descriptorPoolNative,
+                        static_cast<uint32_t>(descriptorSetsNative.size()), descriptorSetsNative.data());
+   m_allocatedDescriptorSetCount -= static_cast<uint32_t>(descriptorSetsNative.size());
 }
 
-void DescriptorPool::UnregisterDescriptorSet(DescriptorSet* p_descriptorSet)
+void DescriptorPool::ReturnDescriptorSet(uint32_t p_slot)
 {
-   std::lock_guard<std::mutex> guard(m_mutex);
+   ASSERT(p_slot < m_returnedSlotLinks.size(), "DescriptorSet isn't allocated in this pool");
 
-   auto setIt = m_descriptorSets.find(p_descriptorSet);
-   ASSERT(setIt != m_descriptorSets.end(), "DescriptorSet isn't allocated in this pool");
-
-   m_descriptorSets.erase(p_descriptorSet);
+   uint32_t head = m_returnedSlotHead.load();
+   do
+   {
+      m_returnedSlotLinks[p_slot] = head;
+   } while (!m_returnedSlotHead.compare_exchange_weak(head, p_slot));
 
-   // Tell the DescriptorPoolManager that there is no more sets allocated on this pool
+   // A detached pool has no owner to free the DescriptorSet, hand it back to the DescriptorPoolManager. Only the first return
+   // after the pool was detached does so
    // TODO: It isn't guaranteed to be registered if used if used in an if-statement
-   if (DescriptorPoolManagerInterface::IsRegistered())
+   if (m_detached.exchange(false) && DescriptorPoolManagerInterface::IsRegistered())
+   {
+      DescriptorPoolManagerInterface::Get()->QueueAvailableDescriptorPool(this);
+   }
+}
+
+bool DescriptorPool::Detach()
+{
+   m_detached.store(true);
+
+   // A return that raced with the detach might have missed it, take the ownership back in that case
+   if (m_returnedSlotHead.load() != InvalidIndex && m_detached.exchange(false))
    {
-      DescriptorPoolManagerInterface::Get()->QueueEmptyDescriptorPool(this);
+      return false;
    }
+
+   return true;
 }
 
 const VkDescriptorPool DescriptorPool::GetDescriptorPoolNative() const
@@ -99,7 +181,12 @@ const VkDescriptorSetLayout DescriptorPool::GetDescriptorSetLayoutNative() const
 
 inline uint32_t DescriptorPool::GetAllocatedDescriptorSetCount() const
 {
-   return static_cast<uint32_t>(m_descriptorSets.size());
+   return m_allocatedDescriptorSetCount;
+}
+
+uint32_t DescriptorPool::GetMaxDescriptorSetCount() const
+{
+   return static_cast<uint32_t>(m_descriptorSetsNative.size());
 }
 
 uint64_t DescriptorPool::GetDescriptorSetLayoutHash() const
@@ -1,9 +1,14 @@
 #include <DescriptorPoolManager.h>
 
+#include <atomic>
+
+#include <EASTL/algorithm.h>
 #include <EASTL/sort.h>
 
 #include <Util/MurmurHash3.h>
 
+#include <TaskScheduler.h>
+
 #include <Std/vector.h>
 
 #include <DescriptorSet.h>
@@ -15,70 +20,135 @@
 namespace Render
 {
 
+namespace
+{
+namespace Internal
+{
+std::atomic_uint64_t InstanceCount = 0u;
+}; // namespace Internal
+}; // namespace
+
 DescriptorPoolManager::DescriptorPoolManager(DescriptorPoolManagerDescriptor&& p_desc)
 {
    m_vulkanDevice = p_desc.m_vulkanDevice;
+   m_taskScheduler = p_desc.m_taskScheduler;
+   m_instanceId = Internal::InstanceCount.fetch_add(1u, std::memory_order_relaxed) + 1u;
 }
 
 DescriptorPoolManager::~DescriptorPoolManager()
 {
+   m_threadCaches.clear();
    m_descriptorPoolLists.clear();
 }
 
 void DescriptorPoolManager::AllocateDescriptorSet(DescriptorSet* p_descriptorSet)
 {
-   std::lock_guard<std::mutex> guard(m_descriptorPoolManagerMutex);
-
-   // Find a DescriptorPool that has enough space to allocate the DesriptorSet
-   DescriptorPoolList& descriptorPoolList =
-       m_descriptorPoolLists[p_descriptorSet->GetDescirptorSetLayout()->GetDescriptorSetLayoutHash()];
+   ConstPtr<DescriptorSetLayout> descriptorSetLayout = p_descriptorSet->GetDescirptorSetLayout();
 
-   // Check if there are still DescriptorSet slots available in the existing DescriptorPools
-   const auto findAndRegisterDescriptorPool = [&descriptorPoolList, &p_descriptorSet]() -> bool {
-      for (auto& descriptorPool : descriptorPoolList)
+   // Task threads allocate from the pool they own, only a refill takes the lock
+   if (m_taskScheduler && m_taskScheduler->GetThreadNum() != enki::NO_THREAD_NUM)
+   {
+      Ptr<DescriptorPool>& descriptorPool =
+          GetThreadCache()->m_descriptorPools[descriptorSetLayout->GetDescriptorSetLayoutHash()];
+      if (!descriptorPool)
       {
-         if (descriptorPool->IsDescriptorSetSlotAvailable())
-         {
-            descriptorPool->RegisterDescriptorSet(p_descriptorSet);
+         std::lock_guard<std::mutex> guard(m_descriptorPoolManagerMutex);
+         FreeDescriptorPool();
+         descriptorPool = AcquireDescriptorPool(descriptorSetLayout);
+      }
 
-            return true;
-         }
+      descriptorPool->AllocateDescriptorSet(p_descriptorSet);
+
+      // The pool is referenced by its DescriptorSets while it's full, the next allocation refills
+      if (!descriptorPool->IsDescriptorSetSlotAvailable() && descriptorPool->Detach())
+      {
+         descriptorPool = nullptr;
       }
 
-      return false;
-   };
+      return;
+   }
 
-   // There is no DescriptorPool which has DescriptorSets available, create a new pool
-   if (findAndRegisterDescriptorPool() == false)
+   std::lock_guard<std::mutex> guard(m_descriptorPoolManagerMutex);
+
+   // Make the returned pools available before allocating
+   FreeDescriptorPool();
+
+   DescriptorPoolList& descriptorPoolList = m_descriptorPoolLists[descriptorSetLayout->GetDescriptorSetLayoutHash()];
+   if (descriptorPoolList.m_availablePools.empty())
+   {
+      AddAvailablePool(descriptorPoolList, AcquireDescriptorPool(descriptorSetLayout));
+   }
+
+   // The shared pools are owned by the DescriptorPoolManager, the last available pool has a free slot
+   Ptr<DescriptorPool> descriptorPool = descriptorPoolList.m_availablePools.back();
+   descriptorPool->AllocateDescriptorSet(p_descriptorSet);
+
+   // The pool is referenced by its DescriptorSets while it's full, it's added back once a DescriptorSet is returned
+   if (!descriptorPool->IsDescriptorSetSlotAvailable())
    {
-      // Allocate from the newly allocated pool
-      Ptr<DescriptorPool> descriptorPool;
+      RemoveAvailablePool(descriptorPoolList, descriptorPool.get());
+      if (!descriptorPool->Detach())
       {
-         DescriptorPoolDescriptor desc;
-         desc.m_descriptorSetLayout = p_descriptorSet->GetDescirptorSetLayout();
-         desc.m_vulkanDevice = m_vulkanDevice;
-         descriptorPool = DescriptorPool::CreateInstance(eastl::move(desc));
+         AddAvailablePool(descriptorPoolList, descriptorPool);
       }
+   }
+}
+
+void DescriptorPoolManager::QueueAvailableDescriptorPool(DescriptorPool* p_descriptorPool)
+{
+   std::lock_guard<std::mutex> releasePoolGuard(m_emptyPoolMutex);
+
+   m_releaseQueue.push_back(p_descriptorPool);
+}
 
-     descriptorPool->RegisterDescriptorSet(p_descriptorSet);
+DescriptorPoolManager::ThreadCache* DescriptorPoolManager::GetThreadCache()
+{
+   thread_local uint64_t threadCacheInstanceId = 0u;
+   thread_local ThreadCache* threadCache = nullptr;
 
-      // Push the pool in front
-      descriptorPoolList.push_front(eastl::move(descriptorPool));
+   if (threadCacheInstanceId != m_instanceId)
+   {
+      std::lock_guard<std::mutex> guard(m_descriptorPoolManagerMutex);
+      m_threadCaches.emplace_back(new ThreadCache());
+      threadCache = m_threadCaches.back().get();
+      threadCacheInstanceId = m_instanceId;
    }
 
-   FreeDescriptorPool();
+   return threadCache;
 }
 
-void DescriptorPoolManager::QueueEmptyDescriptorPool(DescriptorPool* m_descriptorPool)
+Ptr<DescriptorPool> DescriptorPoolManager::AcquireDescriptorPool(ConstPtr<DescriptorSetLayout> p_descriptorSetLayout)
 {
-   std::lock_guard<std::mutex> releasePoolGuard(m_emptyPoolMutex);
+   DescriptorPoolList& descriptorPoolList = m_descriptorPoolLists[p_descriptorSetLayout->GetDescriptorSetLayoutHash()];
+   if (!descriptorPoolList.m_availablePools.empty())
+   {
+      Ptr<DescriptorPool> descriptorPool = descriptorPoolList.m_availablePools.back();
+      RemoveAvailablePool(descriptorPoolList, descriptorPool.get());
+      return descriptorPool;
+   }
+
+   // There is no DescriptorPool which has DescriptorSets available, create a new pool
+   Ptr<DescriptorPool> descriptorPool;
+   {
+      DescriptorPoolDescriptor desc;
+      desc.m_descriptorSetLayout = p_descriptorSetLayout;
+      desc.m_vulkanDevice = m_vulkanDevice;
+      const uint32_t maxDescriptorSetsOfLayout =
+          MaxDescriptorsPerPool / eastl::max(p_descriptorSetLayout->GetDescriptorCount(), 1u);
+      desc.m_maxDescriptorSets = eastl::max(eastl::min(descriptorPoolList.m_nextMaxDescriptorSets, maxDescriptorSetsOfLayout), 1u);
+      descriptorPool = DescriptorPool::CreateInstance(eastl::move(desc));
+   }
+
+   // Grow geometrically, the amount of pools stays logarithmic to the amount of DescriptorSets
+   descriptorPoolList.m_nextMaxDescriptorSets =
+       eastl::min(descriptorPoolList.m_nextMaxDescriptorSets * 2u, MaxDescriptorSetsPerPool);
 
-   m_releaseQueue.push_back(m_descriptorPool);
+   return descriptorPool;
 }
 
 void DescriptorPoolManager::FreeDescriptorPool()
 {
-   Std::vector<const DescriptorPool*> releaseQueue;
+   Std::vector<Ptr<DescriptorPool>> releaseQueue;
    {
       std::lock_guard<std::mutex> releasePoolGuard(m_emptyPoolMutex);
       releaseQueue = eastl::move(m_releaseQueue);
@@ -87,23 +157,52 @@ void DescriptorPoolManager::FreeDescriptorPool()
       m_releaseQueue.clear();
    }
 
-   for (const DescriptorPool* descriptorPool : releaseQueue)
+   for (Ptr<DescriptorPool>& descriptorPool : releaseQueue)
    {
-      if (descriptorPool->GetAllocatedDescriptorSetCount() > 0u)
+      // Check if there exists a DescriptorPoolList with the DescriptorPool's hash (Same as the DescriptorSetLayout)
+      auto descriptorPoolListIt = m_descriptorPoolLists.find(descriptorPool->GetDescriptorSetLayoutHash());
+      ASSERT(descriptorPoolListIt != m_descriptorPoolLists.end(), "DescriptorPoolList width the hash doesn't exist in the map");
+      DescriptorPoolList& descriptorPoolList = descriptorPoolListIt->second;
+
+      // The queued pool has no owner, the DescriptorPoolManager takes the ownership and frees the returned DescriptorSets
+      descriptorPool->FreeReturnedDescriptorSets();
+
+      // Free the pools that are empty, but keep one to avoid recreating a pool when DescriptorSets are freed and allocated
+      // every frame
+      if (descriptorPool->GetAllocatedDescriptorSetCount() == 0u && !descriptorPoolList.m_availablePools.empty())
       {
          continue;
       }
 
-      // Check if there exists a DescriptorPoolList with the DescriptorPool's hash (Same as the DescriptorSetLayout)
-      auto descriptorPoolListIt = m_descriptorPoolLists.find(descriptorPool->GetDescriptorSetLayoutHash());
-      ASSERT(descriptorPoolListIt != m_descriptorPoolLists.end(), "DescriptorPoolList width the hash doesn't exist in the map");
+      AddAvailablePool(descriptorPoolList, descriptorPool);
+   }
+}
 
-      // Remove the DescriptorPool from the list if it's available in the list
-      const auto predicate = [&](const Ptr<DescriptorPool> p_descriptorPool) { return p_descriptorPool.get() == descriptorPool; };
+void DescriptorPoolManager::AddAvailablePool(DescriptorPoolList& p_descriptorPoolList, Ptr<DescriptorPool> p_descriptorPool)
+{
+   ASSERT(p_descriptorPool->m_availableIndex == DescriptorPool::InvalidIndex, "DescriptorPool is already available");
+
+   p_descriptorPool->m_availableIndex = static_cast<uint32_t>(p_descriptorPoolList.m_availablePools.size());
+   p_descriptorPoolList.m_availablePools.push_back(eastl::move(p_descriptorPool));
+}
 
-      auto& descriptorPoolList = descriptorPoolListIt->second;
-      descriptorPoolList.remove_if(predicate);
+void DescriptorPoolManager::RemoveAvailablePool(DescriptorPoolList& p_descriptorPoolList, DescriptorPool* p_descriptorPool)
+{
+   const uint32_t availableIndex = p_descriptorPool->m_availableIndex;
+   ASSERT(availableIndex < p_descriptorPoolList.m_availablePools.size() &&
+              p_descriptorPoolList.m_availablePools[availableIndex].get() == p_descriptorPool,
+          "DescriptorPool isn't available");
+
+   p_descriptorPool->m_availableIndex = DescriptorPool::InvalidIndex;
+
+   // Swap and pop
+   Std::vector<Ptr<DescriptorPool>>& availablePools = p_descriptorPoolList.m_availablePools;
+   if (availableIndex != availablePools.size() - 1u)
+   {
+      availablePools[availableIndex] = eastl::move(availablePools.back());
+      availablePools[availableIndex]->m_availableIndex = availableIndex;
    }
+   availablePools.pop_back();
 }
 
 }; // namespace Render
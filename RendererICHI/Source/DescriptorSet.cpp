@@ -1,5 +1,7 @@
 #include <DescriptorSet.h>
 
+#include <EASTL/algorithm.h>
+
 #include <Std/array.h>
 
 #include <DescriptorSetLayout.h>
@@ -67,28 +69,9 @@ DescriptorSet::DescriptorSet(DescriptorSetDescriptor&& p_desc)
    // Allocate a new descriptor set from the global descriptor pool
    // TODO: Only supports a single DesriptorSet per Allocation
    m_desc = eastl::move(p_desc);
-   DescriptorPoolManagerInterface::Get()->AllocateDescriptorSet(this);
-
-   // Get the DescriptorSet Vulkan resource
-   VkDescriptorSetLayout descriptorSetLayoutNative = m_descriptorPool->GetDescriptorSetLayoutNative();
-
-   // Create the DescriptorSet
-   VkDescriptorSetAllocateInfo info = {};
-   info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-   info.descriptorPool = m_descriptorPool->GetDescriptorPoolNative();
-   info.descriptorSetCount = 1u;
-   info.pSetLayouts = &descriptorSetLayoutNative;
-
-   VkResult result = vkAllocateDescriptorSets(m_desc.m_vulkanDevice->GetLogicalDeviceNative(), &info, &m_descriptorSetNative);
 
-   if (result == VK_ERROR_OUT_OF_HOST_MEMORY || result == VK_ERROR_OUT_OF_DEVICE_MEMORY)
-   {
-      ASSERT(false, "Failed to allocate a DescriptorSet from the DescriptorPool");
-   }
-   else if (result == VK_ERROR_FRAGMENTED_POOL)
-   {
-      ASSERT(false, "DescriptorPool is too fragmented");
-   }
+   // The DescriptorPool creates the DescriptorSet Vulkan resource
+   DescriptorPoolManagerInterface::Get()->AllocateDescriptorSet(this);
 
    // Create the default dynamic pools offsets
    Std::span<const LayoutBinding> layoutBindings = m_desc.m_descriptorSetLayout->GetDescriptorSetlayoutBindings();
@@ -104,15 +87,14 @@ DescriptorSet::DescriptorSet(DescriptorSetDescriptor&& p_desc)
 
 DescriptorSet::~DescriptorSet()
 {
-   vkFreeDescriptorSets(m_desc.m_vulkanDevice->GetLogicalDeviceNative(), m_descriptorPool->GetDescriptorPoolNative(), 1u,
-                        &m_descriptorSetNative);
-
-   m_descriptorPool->UnregisterDescriptorSet(this);
+   // The DescriptorSet is freed by the owner of the DescriptorPool
+   m_descriptorPool->ReturnDescriptorSet(m_descriptorPoolSlot);
 }
 
 void DescriptorSet::QueueResourceUpdate(uint32_t bindingIndex, uint32_t arrayOffset, Std::span<const Ptr<BufferView>> p_bufferView)
 {
    ASSERT(!p_bufferView.empty(), "p_bufferView Can't be empty");
+   ASSERT(!m_isShared, "DescriptorSet is shared by the DescriptorSetCache, it can't be updated");
 
    const Ptr<BufferView> firstBufferView = p_bufferView[0];
    const BufferUsage usage = firstBufferView->GetUsage();
@@ -122,13 +104,24 @@ void DescriptorSet::QueueResourceUpdate(uint32_t bindingIndex, uint32_t arrayOff
    {
       ASSERT(Internal::IsBufferViewValid(bufferView->GetUsage()), "Not a valid usage to bind to a DescriptorSet");
       ASSERT(usage == bufferView->GetUsage(), "All buffers must have the same usage");
+
+      // The Buffer is read by the consumer QueueFamily from now on
+      Ptr<Buffer> buffer = bufferView->GetBuffer();
+      buffer->MarkOwnedByConsumer();
+      const UploadTicket uploadTicket = buffer->GetUploadTicket();
+      m_uploadTicket = MergeUploadTickets(m_uploadTicket, uploadTicket);
+      if (uploadTicket.m_timelineSemaphore &&
+          eastl::find(m_uploadedBuffers.begin(), m_uploadedBuffers.end(), buffer) == m_uploadedBuffers.end())
+      {
+         m_uploadedBuffers.push_back(buffer);
+      }
    }
 
    Std::span<const LayoutBinding> layoutBindings = m_desc.m_descriptorSetLayout->GetDescriptorSetlayoutBindings();
    LayoutBinding layoutBinding;
 
    bool foundBindingIndex = false;
-   [[maybe_unused]] const uint32_t descriptorUpperBoundCount = arrayOffset + static_cast<uint32_t>(p_bufferView.size());
+   const uint32_t descriptorUpperBoundCount = arrayOffset + static_cast<uint32_t>(p_bufferView.size());
    for (const LayoutBinding& binding : layoutBindings)
    {
       if (binding.bindingIndex == bindingIndex)
@@ -184,10 +177,35 @@ void DescriptorSet::QueueResourceUpdate(uint32_t bindingIndex, uint32_t arrayOff
 
    // TODO: Support multiple uploads at once
    vkUpdateDescriptorSets(m_desc.m_vulkanDevice->GetLogicalDeviceNative(), 1u, &writeDescriptorSet, 0u, nullptr);
+
+   // Overwrite the Buffers of the updated array elements, and rebuild the flattened list
+   Std::vector<const Buffer*>& bindingBuffers = m_bindingBuffers[bindingIndex];
+   if (bindingBuffers.size() < descriptorUpperBoundCount)
+   {
+      bindingBuffers.resize(descriptorUpperBoundCount, nullptr);
+   }
+   for (uint32_t i = 0u; i < static_cast<uint32_t>(p_bufferView.size()); i++)
+   {
+      bindingBuffers[arrayOffset + i] = p_bufferView[i]->GetBuffer().get();
+   }
+
+   m_boundBuffers.clear();
+   for (const auto& it : m_bindingBuffers)
+   {
+      for (const Buffer* buffer : it.second)
+      {
+         if (buffer && eastl::find(m_boundBuffers.begin(), m_boundBuffers.end(), buffer) == m_boundBuffers.end())
+         {
+            m_boundBuffers.push_back(buffer);
+         }
+      }
+   }
 }
 
 void DescriptorSet::SetDynamicOffset(uint32_t p_bindingIndex, uint32_t p_arrayOffset, Std::span<uint32_t> p_dynamicOffsets)
 {
+   ASSERT(!m_isShared, "DescriptorSet is shared by the DescriptorSetCache, its dynamic offsets can't be updated");
+
    const auto& findIt = m_dynamicOffsets.find(p_bindingIndex);
    ASSERT(findIt != m_dynamicOffsets.end(), "Descriptor with that binding index isn't of type UniformBuffer or StorageBuffer");
    Std::vector<uint32_t>& dynamicOffsets = findIt->second;
@@ -232,10 +250,38 @@ ConstPtr<DescriptorSetLayout> DescriptorSet::GetDescirptorSetLayout() const
    return m_desc.m_descriptorSetLayout;
 }
 
-void DescriptorSet::SetDescriptorPool(Ptr<DescriptorPool> p_descriptorPool)
+const UploadTicket& DescriptorSet::GetUploadTicket() const
+{
+   return m_uploadTicket;
+}
+
+Std::span<const Ptr<Buffer>> DescriptorSet::GetUploadedBuffers() const
+{
+   return m_uploadedBuffers;
+}
+
+Std::span<const Buffer* const> DescriptorSet::GetBoundBuffers() const
+{
+   return m_boundBuffers;
+}
+
+bool DescriptorSet::IsShared() const
+{
+   return m_isShared;
+}
+
+void DescriptorSet::SetDescriptorPool(Ptr<DescriptorPool> p_descriptorPool, uint32_t p_descriptorPoolSlot,
+                                      VkDescriptorSet p_descriptorSetNative)
 {
    ASSERT(m_descriptorPool.get() == nullptr, "DescriptorPool is already set");
    m_descriptorPool = p_descriptorPool;
+   m_descriptorPoolSlot = p_descriptorPoolSlot;
+   m_descriptorSetNative = p_descriptorSetNative;
+}
+
+void DescriptorSet::MarkShared()
+{
+   m_isShared = true;
 }
 
 }; // namespace Render
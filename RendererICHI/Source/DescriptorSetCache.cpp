@@ -0,0 +1,203 @@
+#include <DescriptorSetCache.h>
+
+#include <EASTL/algorithm.h>
+#include <EASTL/sort.h>
+
+#include <Util/Assert.h>
+#include <Util/MurmurHash3.h>
+
+#include <BufferView.h>
+#include <Buffer.h>
+#include <DescriptorSet.h>
+#include <DescriptorSetLayout.h>
+#include <Renderer.h>
+#include <RendererStateInterface.h>
+
+namespace Render
+{
+
+bool DescriptorSetCache::DescriptorRecord::operator==(const DescriptorRecord& p_other) const
+{
+   return m_buffer == p_other.m_buffer && m_bufferView == p_other.m_bufferView && m_offset == p_other.m_offset &&
+          m_range == p_other.m_range && m_usage == p_other.m_usage && m_bindingIndex == p_other.m_bindingIndex &&
+          m_arrayElement == p_other.m_arrayElement;
+}
+
+DescriptorSetCache::DescriptorSetCache(DescriptorSetCacheDescriptor&& p_desc)
+{
+   m_descriptor = p_desc;
+}
+
+DescriptorSetCache::~DescriptorSetCache()
+{
+   m_cachedDescriptorSets.clear();
+}
+
+Ptr<DescriptorSet> DescriptorSetCache::AcquireDescriptorSet(Ptr<DescriptorSetLayout> p_descriptorSetLayout,
+                                                            Std::span<const DescriptorSetBinding> p_bindings)
+{
+   const uint64_t descriptorSetLayoutHash = p_descriptorSetLayout->GetDescriptorSetLayoutHash();
+
+   // Describe every descriptor that is written, bindings that are written in a different order result in the same content
+   Std::vector<DescriptorRecord> descriptorRecords;
+   for (const DescriptorSetBinding& binding : p_bindings)
+   {
+      for (uint32_t i = 0u; i < binding.m_bufferViews.size(); i++)
+      {
+         const Ptr<BufferView>& bufferView = binding.m_bufferViews[i];
+         descriptorRecords.push_back(DescriptorRecord{.m_buffer = bufferView->GetBuffer()->GetBufferNative(),
+                                                      .m_bufferView = bufferView->GetBufferViewNative(),
+                                                      .m_offset = bufferView->GetOffsetFromBase(),
+                                                      .m_range = bufferView->GetViewRange(),
+                                                      .m_usage = static_cast<uint64_t>(bufferView->GetUsage()),
+                                                      .m_bindingIndex = binding.m_bindingIndex,
+                                                      .m_arrayElement = binding.m_arrayOffset + i});
+      }
+   }
+   eastl::sort(descriptorRecords.begin(), descriptorRecords.end(),
+               [](const DescriptorRecord& p_lhs, const DescriptorRecord& p_rhs) {
+                  return p_lhs.m_bindingIndex < p_rhs.m_bindingIndex ||
+                         (p_lhs.m_bindingIndex == p_rhs.m_bindingIndex && p_lhs.m_arrayElement < p_rhs.m_arrayElement);
+               });
+
+   // Hash the records, seeded with the DescriptorSetLayout hash
+   uint64_t contentHash = 0u;
+   MurmurHash3_x64_64(descriptorRecords.data(), static_cast<int>(descriptorRecords.size() * sizeof(DescriptorRecord)),
+                      static_cast<uint32_t>(descriptorSetLayoutHash), (void*)&contentHash);
+   contentHash ^= descriptorSetLayoutHash;
+
+   const uint64_t frameIndex = RenderStateInterface::Get()->GetFrameIndex();
+
+   {
+      std::lock_guard<std::mutex> lock(m_cachedDescriptorSetsMutex);
+
+      CachedDescriptorSet* cachedDescriptorSet =
+          FindCachedDescriptorSet(contentHash, descriptorSetLayoutHash, descriptorRecords);
+      if (cachedDescriptorSet)
+      {
+         cachedDescriptorSet->m_lastUsedFrameIndex = frameIndex;
+         m_sharedCount++;
+         return cachedDescriptorSet->m_descriptorSet;
+      }
+   }
+
+   // Allocate and write the DescriptorSet outside of the lock
+   Ptr<DescriptorSet> descriptorSet;
+   {
+      DescriptorSetDescriptor desc;
+      desc.m_vulkanDevice = m_descriptor.m_vulkanDevice;
+      desc.m_descriptorSetLayout = p_descriptorSetLayout;
+      descriptorSet = DescriptorSet::CreateInstance(eastl::move(desc));
+   }
+
+   Std::vector<Ptr<BufferView>> bufferViews;
+   for (const DescriptorSetBinding& binding : p_bindings)
+   {
+      descriptorSet->QueueResourceUpdate(binding.m_bindingIndex, binding.m_arrayOffset, binding.m_bufferViews);
+      bufferViews.insert(bufferViews.end(), binding.m_bufferViews.begin(), binding.m_bufferViews.end());
+   }
+
+   std::lock_guard<std::mutex> lock(m_cachedDescriptorSetsMutex);
+
+   // Another thread might have cached a DescriptorSet with the same content in the meantime, in which case that one is shared
+   CachedDescriptorSet* cachedDescriptorSet = FindCachedDescriptorSet(contentHash, descriptorSetLayoutHash, descriptorRecords);
+   if (cachedDescriptorSet)
+   {
+      cachedDescriptorSet->m_lastUsedFrameIndex = frameIndex;
+      m_sharedCount++;
+      return cachedDescriptorSet->m_descriptorSet;
+   }
+
+   // From here on the DescriptorSet is shared, updating it would change the content of every holder
+   descriptorSet->MarkShared();
+   m_cachedDescriptorSets[contentHash].push_back(CachedDescriptorSet{.m_descriptorSetLayoutHash = descriptorSetLayoutHash,
+                                                                     .m_descriptorRecords = eastl::move(descriptorRecords),
+                                                                     .m_descriptorSet = descriptorSet,
+                                                                     .m_bufferViews = eastl::move(bufferViews),
+                                                                     .m_lastUsedFrameIndex = frameIndex});
+   return descriptorSet;
+}
+
+void DescriptorSetCache::Update()
+{
+   const uint64_t frameIndex = RenderStateInterface::Get()->GetFrameIndex();
+
+   std::lock_guard<std::mutex> lock(m_cachedDescriptorSetsMutex);
+
+   for (auto cachedDescriptorSetsIt = m_cachedDescriptorSets.begin(); cachedDescriptorSetsIt != m_cachedDescriptorSets.end();)
+   {
+      Std::vector<CachedDescriptorSet>& cachedDescriptorSets = cachedDescriptorSetsIt->second;
+      for (uint32_t i = 0u; i < cachedDescriptorSets.size();)
+      {
+         CachedDescriptorSet& cachedDescriptorSet = cachedDescriptorSets[i];
+
+         // A DescriptorSet that is only referenced by the cache can't be referenced again without the lock
+         if (cachedDescriptorSet.m_descriptorSet->GetRefCount() > 1u)
+         {
+            cachedDescriptorSet.m_lastUsedFrameIndex = frameIndex;
+         }
+
+         // Keep the unused DescriptorSets around for the frames in flight, they're likely to be acquired again
+         if ((frameIndex - cachedDescriptorSet.m_lastUsedFrameIndex) >= RendererDefines::MaxQueuedFrames)
+         {
+            // Swap and pop
+            eastl::iter_swap(cachedDescriptorSets.begin() + i, cachedDescriptorSets.end() - 1);
+            cachedDescriptorSets.pop_back();
+         }
+         else
+         {
+            i++;
+         }
+      }
+
+      if (cachedDescriptorSets.empty())
+      {
+         cachedDescriptorSetsIt = m_cachedDescriptorSets.erase(cachedDescriptorSetsIt);
+      }
+      else
+      {
+         cachedDescriptorSetsIt++;
+      }
+   }
+}
+
+uint64_t DescriptorSetCache::GetCachedCount()
+{
+   std::lock_guard<std::mutex> lock(m_cachedDescriptorSetsMutex);
+
+   uint64_t cachedCount = 0u;
+   for (const auto& cachedDescriptorSets : m_cachedDescriptorSets)
+   {
+      cachedCount += cachedDescriptorSets.second.size();
+   }
+   return cachedCount;
+}
+
+uint64_t DescriptorSetCache::GetSharedCount() const
+{
+   return m_sharedCount.load();
+}
+
+DescriptorSetCache::CachedDescriptorSet* DescriptorSetCache::FindCachedDescriptorSet(
+    uint64_t p_contentHash, uint64_t p_descriptorSetLayoutHash, Std::span<const DescriptorRecord> p_descriptorRecords)
+{
+   const auto cachedDescriptorSetsIt = m_cachedDescriptorSets.find(p_contentHash);
+   if (cachedDescriptorSetsIt == m_cachedDescriptorSets.end())
+   {
+      return nullptr;
+   }
+
+   for (CachedDescriptorSet& cachedDescriptorSet : cachedDescriptorSetsIt->second)
+   {
+      if (cachedDescriptorSet.m_descriptorSetLayoutHash == p_descriptorSetLayoutHash &&
+          cachedDescriptorSet.m_descriptorRecords.size() == p_descriptorRecords.size() &&
+          eastl::equal(p_descriptorRecords.begin(), p_descriptorRecords.end(), cachedDescriptorSet.m_descriptorRecords.begin()))
+      {
+         return &cachedDescriptorSet;
+      }
+   }
+
+   return nullptr;
+}
+
+} // namespace Render
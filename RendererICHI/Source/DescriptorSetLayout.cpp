@@ -30,6 +30,7 @@ void Render::DescriptorSetLayoutDescriptor::AddResourceLayoutBinding(uint32_t p_
 DescriptorSetLayout::DescriptorSetLayout(DescriptorSetLayoutDescriptor&& p_desc)
 {
    m_vulkanDeviceRef = p_desc.m_vulkanDevice;
+   m_updateAfterBind = p_desc.m_updateAfterBind;
 
    m_layoutBindings = eastl::move(p_desc.m_layoutBindings);
    // Sort the DescriptorSetLayoutBindings in order of it
@@ -42,6 +43,9 @@ DescriptorSetLayout::DescriptorSetLayout(DescriptorSetLayoutDescriptor&& p_desc)
    for (uint32_t i = 0u; i < static_cast<uint32_t>(m_layoutBindings.size()); i++)
    {
       ASSERT(m_layoutBindings[i].bindingIndex == i, "Expected index isn't provided");
+      ASSERT(!m_updateAfterBind || (m_layoutBindings[i].descriptorType != DescriptorType::UniformBuffer &&
+                                    m_layoutBindings[i].descriptorType != DescriptorType::StorageBuffer),
+             "Dynamic descriptors can't be updated after bind");
    }
 
    Std::vector<VkDescriptorSetLayoutBinding> nativeLayoutBindings;
@@ -60,8 +64,12 @@ DescriptorSetLayout::DescriptorSetLayout(DescriptorSetLayoutDescriptor&& p_desc)
    const uint32_t bindingCount = static_cast<uint32_t>(m_layoutBindings.size());
 
    // For all DescriptorSetLayouts, allow updating of descriptors after it's been bound or used by shaders
-   const VkDescriptorBindingFlags bindingFlag =
+   VkDescriptorBindingFlags bindingFlag =
        VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+   if (m_updateAfterBind)
+   {
+      bindingFlag |= VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT;
+   }
    Std::vector<VkDescriptorBindingFlags> bindingFlags(bindingCount, bindingFlag);
 
    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsCreateInfo = {};
@@ -104,10 +112,20 @@ uint64_t DescriptorSetLayout::GetDescriptorSetLayoutHash() const
    return m_descriptorSetLayoutHash;
 }
 
+uint32_t DescriptorSetLayout::GetDescriptorCount() const
+{
+   uint32_t descriptorCount = 0u;
+   for (const LayoutBinding& layoutBinding : m_layoutBindings)
+   {
+      descriptorCount += layoutBinding.descriptorCount;
+   }
+   return descriptorCount;
+}
+
 void DescriptorSetLayout::GenerateHash()
 {
-   // Hash the array
-   constexpr uint32_t seed = 42u;
+   // Hash the array, layouts that only differ in their binding flags aren't compatible
+   const uint32_t seed = m_updateAfterBind ? 43u : 42u;
 
    uint64_t generatedHash = 0u;
    MurmurHash3_x64_64(m_layoutBindings.data(), static_cast<int>(m_layoutBindings.size()) * sizeof(LayoutBinding), seed,
@@ -0,0 +1,328 @@
+#include <DynamicBuffer.h>
+
+#include <string.h>
+
+#include <EASTL/algorithm.h>
+
+#include <Util/Assert.h>
+#include <Util/Util.h>
+
+#include <Buffer.h>
+#include <CommandBuffer.h>
+#include <RenderCommands.h>
+#include <RendererStateInterface.h>
+#include <StagingCopy.h>
+
+namespace Render
+{
+
+namespace
+{
+namespace Internal
+{
+// Offsets and sizes of UpdateBuffer and CopyBuffer are aligned to 4 bytes
+static constexpr uint64_t RangeAlignment = 4u;
+// Staging Buffers don't grow in steps smaller than this
+static constexpr uint64_t MinStagingSizeInBytes = 64u * 1024u;
+}; // namespace Internal
+}; // namespace
+
+DynamicBuffer::DynamicBuffer(DynamicBufferDescriptor&& p_desc)
+{
+   m_descriptor = p_desc;
+
+   ASSERT(m_descriptor.m_bufferSize > 0u && m_descriptor.m_bufferSize % Internal::RangeAlignment == 0u,
+          "Size of a DynamicBuffer must be a multiple of 4");
+   ASSERT(m_descriptor.m_initialDataSize <= m_descriptor.m_bufferSize, "Initial data is larger than the Buffer");
+   ASSERT(m_descriptor.m_inlineUpdateThresholdInBytes <= UpdateBufferCommand::MaxDataSizeInBytes,
+          "Inline updates are limited to UpdateBufferCommand::MaxDataSizeInBytes");
+
+   m_hostVisible = static_cast<uint32_t>(m_descriptor.m_memoryProperties) & static_cast<uint32_t>(MemoryPropertyFlags::HostVisible);
+   ASSERT(m_hostVisible || static_cast<uint32_t>(m_descriptor.m_bufferUsageFlags) &
+                               static_cast<uint32_t>(BufferUsageFlags::TransferDestination),
+          "DynamicBuffers that aren't HostVisible must be created with the TransferDestination usage");
+
+   // The shadow copy is the initial data of all the Buffers, so they start out in sync with it
+   m_shadowData.resize(m_descriptor.m_bufferSize, 0u);
+   if (m_descriptor.m_initialData)
+   {
+      memcpy(m_shadowData.data(), m_descriptor.m_initialData, m_descriptor.m_initialDataSize);
+   }
+
+   m_bufferSlotCount = m_hostVisible ? RendererDefines::MaxQueuedFrames : 1u;
+   for (uint32_t i = 0u; i < m_bufferSlotCount; i++)
+   {
+      BufferDescriptor bufferDescriptor;
+      bufferDescriptor.m_vulkanDevice = m_descriptor.m_vulkanDevice;
+      bufferDescriptor.m_bufferSize = m_descriptor.m_bufferSize;
+      bufferDescriptor.m_bufferUsageFlags = m_descriptor.m_bufferUsageFlags;
+      bufferDescriptor.m_memoryProperties = m_descriptor.m_memoryProperties;
+      bufferDescriptor.m_initialData = m_shadowData.data();
+      bufferDescriptor.m_initialDataSize = m_shadowData.size();
+
+      BufferSlot& bufferSlot = m_bufferSlots[i];
+      bufferSlot.m_buffer = Buffer::CreateInstance(eastl::move(bufferDescriptor));
+      if (m_hostVisible)
+      {
+         // The Buffers stay mapped for the lifetime of the DynamicBuffer
+         bufferSlot.m_mappedData = static_cast<uint8_t*>(bufferSlot.m_buffer->Map(0u));
+      }
+   }
+}
+
+DynamicBuffer::~DynamicBuffer()
+{
+   for (uint32_t i = 0u; i < m_bufferSlotCount; i++)
+   {
+      if (m_bufferSlots[i].m_mappedData)
+      {
+         m_bufferSlots[i].m_buffer->Unmap();
+      }
+   }
+
+   for (FrameStaging& frameStaging : m_frameStagings)
+   {
+      if (frameStaging.m_stagingBuffer)
+      {
+         frameStaging.m_stagingBuffer->Unmap();
+      }
+   }
+}
+
+void DynamicBuffer::Write(uint64_t p_offset, const void* p_data, uint64_t p_size)
+{
+   ASSERT(p_offset + p_size <= m_shadowData.size(), "Range is out of the bounds of the DynamicBuffer");
+
+   memcpy(m_shadowData.data() + p_offset, p_data, p_size);
+   MarkDirty(p_offset, p_size);
+}
+
+uint8_t* DynamicBuffer::GetShadowData()
+{
+   return m_shadowData.data();
+}
+
+const uint8_t* DynamicBuffer::GetShadowData() const
+{
+   return m_shadowData.data();
+}
+
+void DynamicBuffer::MarkDirty(uint64_t p_offset, uint64_t p_size)
+{
+   ASSERT(p_offset + p_size <= m_shadowData.size(), "Range is out of the bounds of the DynamicBuffer");
+
+   if (p_size == 0u)
+   {
+      return;
+   }
+
+   // Widen the range to the alignment of the copies, the size of the Buffer is aligned as well
+   const DirtyRange dirtyRange{
+       .m_begin = p_offset / Internal::RangeAlignment * Internal::RangeAlignment,
+       .m_end = (p_offset + p_size + Internal::RangeAlignment - 1u) / Internal::RangeAlignment * Internal::RangeAlignment};
+
+   for (uint32_t i = 0u; i < m_bufferSlotCount; i++)
+   {
+      AddDirtyRange(m_bufferSlots[i].m_dirtyRanges, dirtyRange);
+   }
+}
+
+void DynamicBuffer::Flush(CommandBufferBase* p_commandBuffer)
+{
+   BufferSlot& bufferSlot = GetCurrentBufferSlot();
+   if (bufferSlot.m_dirtyRanges.empty())
+   {
+      return;
+   }
+
+   if (m_hostVisible)
+   {
+      FlushHostVisible(bufferSlot);
+   }
+   else
+   {
+      FlushDeviceLocal(bufferSlot, p_commandBuffer);
+   }
+
+   bufferSlot.m_dirtyRanges.clear();
+}
+
+Ptr<Buffer> DynamicBuffer::GetBuffer() const
+{
+   return GetCurrentBufferSlot().m_buffer;
+}
+
+uint64_t DynamicBuffer::GetSize() const
+{
+   return m_shadowData.size();
+}
+
+uint64_t DynamicBuffer::GetDirtySize() const
+{
+   uint64_t dirtySize = 0u;
+   for (const DirtyRange& dirtyRange : GetCurrentBufferSlot().m_dirtyRanges)
+   {
+      dirtySize += dirtyRange.m_end - dirtyRange.m_begin;
+   }
+   return dirtySize;
+}
+
+void DynamicBuffer::AddDirtyRange(Std::vector<DirtyRange>& p_dirtyRanges, DirtyRange p_dirtyRange)
+{
+   // First range that ends at or after the begin of the new range, it's the first one that can be merged
+   auto first = eastl::lower_bound(p_dirtyRanges.begin(), p_dirtyRanges.end(), p_dirtyRange.m_begin,
+                                   [](const DirtyRange& p_range, uint64_t p_begin) { return p_range.m_end < p_begin; });
+
+   // Merge all the ranges that start at or before the end of the new range
+   auto last = first;
+   while (last != p_dirtyRanges.end() && last->m_begin <= p_dirtyRange.m_end)
+   {
+      p_dirtyRange.m_begin = eastl::min(p_dirtyRange.m_begin, last->m_begin);
+      p_dirtyRange.m_end = eastl::max(p_dirtyRange.m_end, last->m_end);
+      last++;
+   }
+
+   if (first == last)
+   {
+      p_dirtyRanges.insert(first, p_dirtyRange);
+   }
+   else
+   {
+      *first = p_dirtyRange;
+      p_dirtyRanges.erase(first + 1, last);
+   }
+}
+
+DynamicBuffer::BufferSlot& DynamicBuffer::GetCurrentBufferSlot()
+{
+   return m_bufferSlots[m_hostVisible ? RenderStateInterface::Get()->GetResourceIndex() : 0u];
+}
+
+const DynamicBuffer::BufferSlot& DynamicBuffer::GetCurrentBufferSlot() const
+{
+   return m_bufferSlots[m_hostVisible ? RenderStateInterface::Get()->GetResourceIndex() : 0u];
+}
+
+void DynamicBuffer::FlushHostVisible(BufferSlot& p_bufferSlot)
+{
+   // The Buffer of the current frame isn't used by the device anymore, write the dirty ranges directly
+   Std::vector<StagingCopy::CopyRange> copyRanges;
+   copyRanges.reserve(p_bufferSlot.m_dirtyRanges.size());
+   for (const DirtyRange& dirtyRange : p_bufferSlot.m_dirtyRanges)
+   {
+      copyRanges.push_back(StagingCopy::CopyRange{.m_dest = p_bufferSlot.m_mappedData + dirtyRange.m_begin,
+                                                  .m_source = m_shadowData.data() + dirtyRange.m_begin,
+                                                  .m_size = dirtyRange.m_end - dirtyRange.m_begin});
+   }
+   StagingCopy::ParallelStreamingCopy(nullptr, copyRanges);
+
+   for (const DirtyRange& dirtyRange : p_bufferSlot.m_dirtyRanges)
+   {
+      p_bufferSlot.m_buffer->FlushMappedRange(dirtyRange.m_begin, dirtyRange.m_end - dirtyRange.m_begin);
+   }
+}
+
+void DynamicBuffer::FlushDeviceLocal(BufferSlot& p_bufferSlot, CommandBufferBase* p_commandBuffer)
+{
+   ASSERT(p_commandBuffer, "Flushing a DynamicBuffer that isn't HostVisible requires a CommandBuffer");
+
+   const uint64_t dirtySize = GetDirtySize();
+
+   // Wait for the previous accesses of the Buffer, and make the writes visible to all the commands that follow
+   const VkPipelineStageFlags2 allCommands = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+   const VkAccessFlags2 allAccesses = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+   const VkPipelineStageFlags2 transfer = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+   const VkAccessFlags2 transferWrite = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+
+   // Small updates are embedded in the CommandBuffer, which doesn't need staging memory. All the writes share a barrier pair
+   if (dirtySize <= m_descriptor.m_inlineUpdateThresholdInBytes)
+   {
+      p_commandBuffer->AddOwnershipAcquire(p_bufferSlot.m_buffer);
+
+      p_commandBuffer->PipelineBarrier()->AddBufferBarrier(allCommands, allAccesses, transfer, transferWrite,
+                                                           VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, p_bufferSlot.m_buffer,
+                                                           0u, VK_WHOLE_SIZE);
+
+      for (const DirtyRange& dirtyRange : p_bufferSlot.m_dirtyRanges)
+      {
+         p_commandBuffer->UpdateBufferWithoutBarriers(p_bufferSlot.m_buffer, dirtyRange.m_begin,
+                                                      m_shadowData.data() + dirtyRange.m_begin,
+                                                      dirtyRange.m_end - dirtyRange.m_begin);
+      }
+
+      p_commandBuffer->PipelineBarrier()->AddBufferBarrier(transfer, transferWrite, allCommands, allAccesses,
+                                                           VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, p_bufferSlot.m_buffer,
+                                                           0u, VK_WHOLE_SIZE);
+      return;
+   }
+
+   // Pack the dirty ranges in the staging memory, and copy them with a single CopyBuffer
+   FrameStaging* frameStaging = nullptr;
+   uint64_t stagingOffset = AllocateStaging(dirtySize, frameStaging);
+
+   Std::vector<StagingCopy::CopyRange> copyRanges;
+   Std::vector<BufferCopyRegion> copyRegions;
+   copyRanges.reserve(p_bufferSlot.m_dirtyRanges.size());
+   copyRegions.reserve(p_bufferSlot.m_dirtyRanges.size());
+   for (const DirtyRange& dirtyRange : p_bufferSlot.m_dirtyRanges)
+   {
+      const uint64_t size = dirtyRange.m_end - dirtyRange.m_begin;
+      copyRanges.push_back(StagingCopy::CopyRange{.m_dest = frameStaging->m_mappedData + stagingOffset,
+                                                  .m_source = m_shadowData.data() + dirtyRange.m_begin,
+                                                  .m_size = size});
+      copyRegions.push_back(BufferCopyRegion{.m_srcOffset = stagingOffset, .m_destOffset = dirtyRange.m_begin, .m_size = size});
+      stagingOffset += size;
+   }
+   StagingCopy::ParallelStreamingCopy(nullptr, copyRanges);
+
+   p_commandBuffer->AddOwnershipAcquire(p_bufferSlot.m_buffer);
+
+   p_commandBuffer->PipelineBarrier()->AddBufferBarrier(allCommands, allAccesses, transfer, transferWrite, VK_QUEUE_FAMILY_IGNORED,
+                                                        VK_QUEUE_FAMILY_IGNORED, p_bufferSlot.m_buffer, 0u, VK_WHOLE_SIZE);
+
+   p_commandBuffer->CopyBuffer(frameStaging->m_stagingBuffer, p_bufferSlot.m_buffer, copyRegions);
+
+   p_commandBuffer->PipelineBarrier()->AddBufferBarrier(transfer, transferWrite, allCommands, allAccesses, VK_QUEUE_FAMILY_IGNORED,
+                                                        VK_QUEUE_FAMILY_IGNORED, p_bufferSlot.m_buffer, 0u, VK_WHOLE_SIZE);
+}
+
+uint64_t DynamicBuffer::AllocateStaging(uint64_t p_size, FrameStaging*& p_frameStaging)
+{
+   // The staging memory of a resource index is reused once the frame that used it last is complete
+   const uint64_t frameIndex = RenderStateInterface::Get()->GetFrameIndex();
+   FrameStaging& frameStaging = m_frameStagings[RenderStateInterface::Get()->GetResourceIndex()];
+   if (frameStaging.m_frameIndex != frameIndex)
+   {
+      frameStaging.m_frameIndex = frameIndex;
+      frameStaging.m_offset = 0u;
+   }
+
+   const uint64_t capacity = frameStaging.m_stagingBuffer ? frameStaging.m_stagingBuffer->GetBufferSizeRequested() : 0u;
+   if (frameStaging.m_offset + p_size > capacity)
+   {
+      // Copies that were recorded before keep a reference to the previous staging Buffer, it's released once they're complete
+      if (frameStaging.m_stagingBuffer)
+      {
+         frameStaging.m_stagingBuffer->Unmap();
+      }
+
+      BufferDescriptor bufferDescriptor;
+      bufferDescriptor.m_vulkanDevice = m_descriptor.m_vulkanDevice;
+      bufferDescriptor.m_bufferSize = eastl::max(eastl::max(capacity * 2u, p_size), Internal::MinStagingSizeInBytes);
+      bufferDescriptor.m_memoryProperties =
+          Foundation::Util::SetFlags<MemoryPropertyFlags>(MemoryPropertyFlags::HostVisible, MemoryPropertyFlags::HostCoherent);
+      bufferDescriptor.m_bufferUsageFlags = BufferUsageFlags::TransferSource;
+      frameStaging.m_stagingBuffer = Buffer::CreateInstance(eastl::move(bufferDescriptor));
+      frameStaging.m_stagingBuffer->SetName("DynamicBuffer Staging Buffer");
+      frameStaging.m_mappedData = static_cast<uint8_t*>(frameStaging.m_stagingBuffer->Map(0u));
+      frameStaging.m_offset = 0u;
+   }
+
+   const uint64_t offset = frameStaging.m_offset;
+   frameStaging.m_offset += p_size;
+
+   p_frameStaging = &frameStaging;
+   return offset;
+}
+
+} // namespace Render
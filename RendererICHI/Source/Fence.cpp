@@ -23,11 +23,13 @@ Fence::~Fence()
    vkDestroyFence(m_vulkanDevice->GetLogicalDeviceNative(), m_fenceNative, nullptr);
 }
 
-void Fence::WaitForSignal(uint64_t p_waitInNanoSeconds /* = static_cast<uint64_t>(-1)*/)
+bool Fence::WaitForSignal(uint64_t p_waitInNanoSeconds /* = static_cast<uint64_t>(-1)*/)
 {
-   [[maybe_unused]] const VkResult res =
+   const VkResult res =
        vkWaitForFences(m_vulkanDevice->GetLogicalDeviceNative(), 1u, &m_fenceNative, VK_TRUE, p_waitInNanoSeconds);
-   ASSERT(res == VK_SUCCESS, "Failed to wait for the fence");
+   ASSERT(res == VK_SUCCESS || res == VK_TIMEOUT, "Failed to wait for the fence");
+
+   return res == VK_SUCCESS;
 }
 
 bool Fence::IsSignaled() const
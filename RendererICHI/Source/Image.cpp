@@ -24,6 +24,21 @@ Image::Image(ImageDescriptor&& p_desc)
    m_initialLayout = p_desc.m_initialLayout;
    m_memoryProperties = p_desc.m_memoryProperties;
 
+   // Transient attachments are backed by lazily allocated memory when the device supports it, which might never be committed
+   // on tile-based GPUs. VulkanDevice falls back to regular memory if it isn't supported.
+   if (IsTransient())
+   {
+      [[maybe_unused]] const uint32_t transientCompatibleUsage =
+          static_cast<uint32_t>(ImageUsageFlags::TransientAttachment) | static_cast<uint32_t>(ImageUsageFlags::ColorAttachment) |
+          static_cast<uint32_t>(ImageUsageFlags::DepthStencilAttachment) | static_cast<uint32_t>(ImageUsageFlags::InputAttachment);
+      ASSERT((static_cast<uint32_t>(m_imageUsageFlags) & ~transientCompatibleUsage) == 0u,
+             "Transient Images can only be used as Color, DepthStencil or Input attachments");
+
+      m_memoryProperties = Foundation::Util::SetFlags<MemoryPropertyFlags>(
+          m_memoryProperties,
+          Foundation::Util::SetFlags<MemoryPropertyFlags>(MemoryPropertyFlags::DeviceLocal, MemoryPropertyFlags::LazilyAllocated));
+   }
+
    VkImageCreateInfo createInfo = {};
    createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
    createInfo.pNext = nullptr;
@@ -55,6 +70,13 @@ Image::Image(ImageDescriptor&& p_desc)
    // Bind the Buffer resource to the Memory resource
    res = vkBindImageMemory(m_vulkanDevice->GetLogicalDeviceNative(), GetImageNative(), GetDeviceMemoryNative(), 0u);
    ASSERT(res == VK_SUCCESS, "Failed to bind the Buffer resource to the Memory resource");
+
+   ResourceTrackerInterface::Get()->ReportAllocation(
+       this, MemoryTelemetryRecord{.m_category = MemoryTelemetryCategory::Image,
+                                   .m_resource = this,
+                                   .m_sizeInBytes = m_bufferSizeAllocatedMemory,
+                                   .m_memoryPropertyFlags = RenderTypeToNative::MemoryPropertyFlagsToNative(m_memoryProperties),
+                                   .m_usageFlags = ImageUsageFlagsToNative(m_imageUsageFlags)});
 }
 
 Image::Image(ImageDescriptor2&& p_desc)
@@ -78,6 +100,8 @@ Image::~Image()
    // Only clean up the Vulkan resource if it's not created from a swapchain
    if (!m_swapchain)
    {
+      ResourceTrackerInterface::Get()->ReportDeallocation(this);
+
       vkDestroyImage(m_vulkanDevice->GetLogicalDeviceNative(), m_imageNative, nullptr);
       vkFreeMemory(m_vulkanDevice->GetLogicalDeviceNative(), GetDeviceMemoryNative(), nullptr);
    }
@@ -128,6 +152,48 @@ uint32_t Image::GetArrayLayers() const
    return m_arrayLayers;
 }
 
+MemoryPropertyFlags Image::GetMemoryProperties() const
+{
+   return m_memoryProperties;
+}
+
+bool Image::IsTransient() const
+{
+   return static_cast<uint32_t>(m_imageUsageFlags) & static_cast<uint32_t>(ImageUsageFlags::TransientAttachment);
+}
+
+void Image::SetPendingOwnershipAcquire(const QueueFamilyOwnershipAcquire& p_acquire)
+{
+   std::lock_guard<std::mutex> lock(m_ownershipMutex);
+   ASSERT(!m_hasPendingOwnershipAcquire, "The Image is released while an earlier release isn't acquired yet");
+   m_pendingOwnershipAcquire = p_acquire;
+   m_hasPendingOwnershipAcquire = true;
+   m_ownedByConsumer = true;
+}
+
+bool Image::ConsumePendingOwnershipAcquire(uint32_t p_queueFamilyIndex, QueueFamilyOwnershipAcquire& p_acquire)
+{
+   std::lock_guard<std::mutex> lock(m_ownershipMutex);
+   if (!m_hasPendingOwnershipAcquire || m_pendingOwnershipAcquire.m_dstQueueFamilyIndex != p_queueFamilyIndex)
+   {
+      return false;
+   }
+
+   p_acquire = m_pendingOwnershipAcquire;
+   m_hasPendingOwnershipAcquire = false;
+   return true;
+}
+
+void Image::MarkOwnedByConsumer()
+{
+   m_ownedByConsumer = true;
+}
+
+bool Image::IsOwnedByConsumer() const
+{
+   return m_ownedByConsumer;
+}
+
 const VkDeviceMemory Image::GetDeviceMemoryNative() const
 {
    return m_deviceMemory;
@@ -0,0 +1,124 @@
+#include <ImmutableBufferCache.h>
+
+#include <Util/Assert.h>
+#include <Util/MurmurHash3.h>
+
+#include <Buffer.h>
+
+namespace Render
+{
+
+bool ImmutableBufferCache::ContentKey::operator==(const ContentKey& p_other) const
+{
+   return m_contentHash[0] == p_other.m_contentHash[0] && m_contentHash[1] == p_other.m_contentHash[1] &&
+          m_initialDataSize == p_other.m_initialDataSize && m_bufferSize == p_other.m_bufferSize &&
+          m_bufferUsageFlags == p_other.m_bufferUsageFlags && m_memoryProperties == p_other.m_memoryProperties &&
+          m_queueFamilyAccess == p_other.m_queueFamilyAccess;
+}
+
+size_t ImmutableBufferCache::ContentKeyHash::operator()(const ContentKey& p_contentKey) const
+{
+   // The content hash is already well distributed, the other members only differ for identical content
+   return static_cast<size_t>(p_contentKey.m_contentHash[0] ^ p_contentKey.m_bufferSize ^
+                              (static_cast<uint64_t>(p_contentKey.m_bufferUsageFlags) << 32u));
+}
+
+ImmutableBufferCache::~ImmutableBufferCache()
+{
+   m_residentBuffers.clear();
+}
+
+Ptr<Buffer> ImmutableBufferCache::AcquireBuffer(BufferDescriptor&& p_desc)
+{
+   ASSERT(p_desc.m_initialData && p_desc.m_initialDataSize > 0u, "Cached Buffers need initial data");
+   ASSERT(p_desc.m_importedHostData == nullptr, "Cached Buffers can't import host memory");
+
+   const ContentKey contentKey = CreateContentKey(p_desc);
+
+   Ptr<Buffer> residentBuffer;
+   {
+      std::lock_guard<std::mutex> lock(m_residentBuffersMutex);
+
+      const auto residentBufferIt = m_residentBuffers.find(contentKey);
+      if (residentBufferIt != m_residentBuffers.end())
+      {
+         residentBuffer = residentBufferIt->second;
+      }
+   }
+
+   if (residentBuffer)
+   {
+      m_sharedCount++;
+
+      // The Buffer might be created with asynchronous initial data, wait for it if the caller expects it to be uploaded
+      if (!p_desc.m_asyncInitialData && !residentBuffer->IsReady())
+      {
+         AsyncUploadQueueInterface::Get()->WaitForUpload(residentBuffer->GetUploadTicket());
+      }
+
+      return residentBuffer;
+   }
+
+   // Create the Buffer outside of the lock, the upload of the initial data might block
+   Ptr<Buffer> buffer = Buffer::CreateInstance(eastl::move(p_desc));
+   buffer->MarkShared();
+
+   std::lock_guard<std::mutex> lock(m_residentBuffersMutex);
+
+   // Another thread might have created a Buffer with the same content in the meantime, in which case that one is shared
+   const auto insertResult = m_residentBuffers.insert(eastl::make_pair(contentKey, buffer));
+   if (!insertResult.second)
+   {
+      m_sharedCount++;
+   }
+
+   return insertResult.first->second;
+}
+
+void ImmutableBufferCache::Update()
+{
+   std::lock_guard<std::mutex> lock(m_residentBuffersMutex);
+
+   // A Buffer that is only referenced by the cache can't be referenced again without the lock, it's safe to release it
+   for (auto residentBufferIt = m_residentBuffers.begin(); residentBufferIt != m_residentBuffers.end();)
+   {
+      if (residentBufferIt->second->GetRefCount() == 1u)
+      {
+         residentBufferIt = m_residentBuffers.erase(residentBufferIt);
+      }
+      else
+      {
+         residentBufferIt++;
+      }
+   }
+}
+
+uint64_t ImmutableBufferCache::GetResidentCount()
+{
+   std::lock_guard<std::mutex> lock(m_residentBuffersMutex);
+   return m_residentBuffers.size();
+}
+
+uint64_t ImmutableBufferCache::GetSharedCount() const
+{
+   return m_sharedCount.load();
+}
+
+ImmutableBufferCache::ContentKey ImmutableBufferCache::CreateContentKey(const BufferDescriptor& p_desc)
+{
+   ASSERT(p_desc.m_initialDataSize <= static_cast<uint64_t>(INT32_MAX), "Initial data is too large to hash");
+
+   constexpr uint32_t seed = 42u;
+
+   ContentKey contentKey{.m_initialDataSize = p_desc.m_initialDataSize,
+                         .m_bufferSize = p_desc.m_bufferSize,
+                         .m_bufferUsageFlags = p_desc.m_bufferUsageFlags,
+                         .m_memoryProperties = p_desc.m_memoryProperties,
+                         .m_queueFamilyAccess = p_desc.m_queueFamilyAccess};
+   MurmurHash3_x64_128(p_desc.m_initialData, static_cast<int>(p_desc.m_initialDataSize), seed,
+                       (void*)contentKey.m_contentHash);
+
+   return contentKey;
+}
+
+} // namespace Render
@@ -0,0 +1,238 @@
+#include <Lz4BlockCodec.h>
+
+#include <string.h>
+
+#include <EASTL/algorithm.h>
+
+namespace Render
+{
+
+namespace
+{
+namespace Internal
+{
+// The last bytes of a block are always literals, and the last match starts before MatchStartLimit bytes from the end
+static constexpr uint64_t LastLiteralsSize = 5u;
+static constexpr uint64_t MatchStartLimit = 12u;
+// Blocks smaller than this are stored as literals only
+static constexpr uint64_t MinCompressedBlockSize = MatchStartLimit + 1u;
+
+static constexpr uint32_t HashTableBits = 13u;
+static constexpr uint32_t RunMask = 15u;
+
+uint32_t Read32(const uint8_t* p_data)
+{
+   uint32_t value;
+   memcpy(&value, p_data, sizeof(value));
+   return value;
+}
+
+uint32_t Hash(uint32_t p_sequence)
+{
+   return (p_sequence * 2654435761u) >> (32u - HashTableBits);
+}
+
+// Writes the remainder of a length that doesn't fit in the 4 bits of the token
+uint8_t* WriteLength(uint8_t* p_dest, uint64_t p_length)
+{
+   for (; p_length >= 255u; p_length -= 255u)
+   {
+      *p_dest++ = 255u;
+   }
+   *p_dest++ = static_cast<uint8_t>(p_length);
+   return p_dest;
+}
+
+// Reads the remainder of a length, returns false if the data ends before the length
+bool ReadLength(const uint8_t*& p_source, const uint8_t* p_sourceEnd, uint64_t& p_length)
+{
+   uint8_t value = 255u;
+   while (value == 255u)
+   {
+      if (p_source >= p_sourceEnd)
+      {
+         return false;
+      }
+      value = *p_source++;
+      p_length += value;
+   }
+   return true;
+}
+
+uint8_t* WriteSequence(uint8_t* p_dest, const uint8_t* p_literals, uint64_t p_literalSize, uint32_t p_matchOffset,
+                       uint64_t p_matchSize)
+{
+   const uint64_t matchLength = p_matchSize - Lz4BlockCodec::MinMatchSize;
+
+   uint8_t* token = p_dest++;
+   *token = static_cast<uint8_t>((eastl::min(p_literalSize, static_cast<uint64_t>(RunMask)) << 4u) |
+                                 eastl::min(matchLength, static_cast<uint64_t>(RunMask)));
+
+   if (p_literalSize >= RunMask)
+   {
+      p_dest = WriteLength(p_dest, p_literalSize - RunMask);
+   }
+   memcpy(p_dest, p_literals, p_literalSize);
+   p_dest += p_literalSize;
+
+   *p_dest++ = static_cast<uint8_t>(p_matchOffset & 0xffu);
+   *p_dest++ = static_cast<uint8_t>(p_matchOffset >> 8u);
+
+   if (matchLength >= RunMask)
+   {
+      p_dest = WriteLength(p_dest, matchLength - RunMask);
+   }
+   return p_dest;
+}
+
+uint8_t* WriteLastLiterals(uint8_t* p_dest, const uint8_t* p_literals, uint64_t p_literalSize)
+{
+   *p_dest++ = static_cast<uint8_t>(eastl::min(p_literalSize, static_cast<uint64_t>(RunMask)) << 4u);
+   if (p_literalSize >= RunMask)
+   {
+      p_dest = WriteLength(p_dest, p_literalSize - RunMask);
+   }
+   // The literals of an empty block can be null
+   if (p_literalSize > 0u)
+   {
+      memcpy(p_dest, p_literals, p_literalSize);
+   }
+   return p_dest + p_literalSize;
+}
+}; // namespace Internal
+}; // namespace
+
+bool Lz4BlockCodec::DecompressBlock(const uint8_t* p_compressedData, uint64_t p_compressedSizeInBytes, uint8_t* p_destData,
+                                    uint64_t p_decompressedSizeInBytes) const
+{
+   const uint8_t* source = p_compressedData;
+   const uint8_t* sourceEnd = p_compressedData + p_compressedSizeInBytes;
+   uint8_t* dest = p_destData;
+   uint8_t* destEnd = p_destData + p_decompressedSizeInBytes;
+
+   while (source < sourceEnd)
+   {
+      const uint8_t token = *source++;
+
+      // Copy the literals
+      uint64_t literalSize = token >> 4u;
+      if (literalSize == Internal::RunMask && !Internal::ReadLength(source, sourceEnd, literalSize))
+      {
+         return false;
+      }
+      if (literalSize > static_cast<uint64_t>(sourceEnd - source) || literalSize > static_cast<uint64_t>(destEnd - dest))
+      {
+         return false;
+      }
+      if (literalSize > 0u)
+      {
+         memcpy(dest, source, literalSize);
+      }
+      source += literalSize;
+      dest += literalSize;
+
+      // The last sequence only has literals
+      if (source == sourceEnd)
+      {
+         return dest == destEnd;
+      }
+
+      // Copy the match, which can overlap the bytes it produces
+      if (sourceEnd - source < 2)
+      {
+         return false;
+      }
+      const uint64_t matchOffset = static_cast<uint64_t>(source[0]) | (static_cast<uint64_t>(source[1]) << 8u);
+      source += 2u;
+      if (matchOffset == 0u || matchOffset > static_cast<uint64_t>(dest - p_destData))
+      {
+         return false;
+      }
+
+      uint64_t matchSize = token & Internal::RunMask;
+      if (matchSize == Internal::RunMask && !Internal::ReadLength(source, sourceEnd, matchSize))
+      {
+         return false;
+      }
+      matchSize += MinMatchSize;
+      if (matchSize > static_cast<uint64_t>(destEnd - dest))
+      {
+         return false;
+      }
+
+      const uint8_t* match = dest - matchOffset;
+      if (matchOffset >= matchSize)
+      {
+         memcpy(dest, match, matchSize);
+         dest += matchSize;
+      }
+      else
+      {
+         for (uint64_t i = 0u; i < matchSize; i++)
+         {
+            *dest++ = *match++;
+         }
+      }
+   }
+
+   return false;
+}
+
+uint64_t Lz4BlockCodec::CompressBlock(const uint8_t* p_sourceData, uint64_t p_sourceSizeInBytes, uint8_t* p_destData)
+{
+   const uint8_t* sourceEnd = p_sourceData + p_sourceSizeInBytes;
+   const uint8_t* literals = p_sourceData;
+   uint8_t* dest = p_destData;
+
+   if (p_sourceSizeInBytes >= Internal::MinCompressedBlockSize)
+   {
+      // Positions of the last sequence with the same hash, relative to the start of the block
+      uint32_t hashTable[1u << Internal::HashTableBits] = {};
+
+      const uint8_t* matchStartEnd = sourceEnd - Internal::MatchStartLimit;
+      const uint8_t* matchEnd = sourceEnd - Internal::LastLiteralsSize;
+
+      const uint8_t* source = p_sourceData + 1u;
+      while (source <= matchStartEnd)
+      {
+         const uint32_t sequence = Internal::Read32(source);
+         const uint32_t hash = Internal::Hash(sequence);
+         const uint8_t* match = p_sourceData + hashTable[hash];
+         hashTable[hash] = static_cast<uint32_t>(source - p_sourceData);
+
+         if (match >= source || static_cast<uint64_t>(source - match) > MaxMatchOffset || Internal::Read32(match) != sequence)
+         {
+            source++;
+            continue;
+         }
+
+         // Extend the match backwards into the literals, and forwards until the last literals
+         while (source > literals && match > p_sourceData && source[-1] == match[-1])
+         {
+            source--;
+            match--;
+         }
+
+         uint64_t matchSize = MinMatchSize;
+         while (source + matchSize < matchEnd && source[matchSize] == match[matchSize])
+         {
+            matchSize++;
+         }
+
+         dest = Internal::WriteSequence(dest, literals, static_cast<uint64_t>(source - literals),
+                                        static_cast<uint32_t>(source - match), matchSize);
+         source += matchSize;
+         literals = source;
+      }
+   }
+
+   dest = Internal::WriteLastLiterals(dest, literals, static_cast<uint64_t>(sourceEnd - literals));
+   return static_cast<uint64_t>(dest - p_destData);
+}
+
+uint64_t Lz4BlockCodec::GetMaxCompressedSize(uint64_t p_sourceSizeInBytes)
+{
+   return p_sourceSizeInBytes + p_sourceSizeInBytes / 255u + 16u;
+}
+
+} // namespace Render
@@ -0,0 +1,223 @@
+#include <MappedFile.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <EASTL/algorithm.h>
+
+#include <Util/Assert.h>
+
+namespace Render
+{
+
+namespace
+{
+namespace Internal
+{
+uint64_t GetPageSize()
+{
+#if defined(_WIN32)
+   SYSTEM_INFO systemInfo;
+   GetSystemInfo(&systemInfo);
+   return static_cast<uint64_t>(systemInfo.dwPageSize);
+#else
+   return static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+}; // namespace Internal
+}; // namespace
+
+MappedFile::~MappedFile()
+{
+   Close();
+}
+
+bool MappedFile::Open(const char* p_path)
+{
+   ASSERT(!IsOpen(), "MappedFile is already open");
+
+#if defined(_WIN32)
+   HANDLE fileHandle = CreateFileA(p_path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                   FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+   if (fileHandle == INVALID_HANDLE_VALUE)
+   {
+      return false;
+   }
+   m_fileHandle = fileHandle;
+
+   LARGE_INTEGER fileSize;
+   if (!GetFileSizeEx(fileHandle, &fileSize))
+   {
+      Close();
+      return false;
+   }
+   m_size = static_cast<uint64_t>(fileSize.QuadPart);
+
+   // Empty files can't be mapped
+   if (m_size == 0u)
+   {
+      return true;
+   }
+
+   m_mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0u, 0u, nullptr);
+   if (m_mappingHandle == nullptr)
+   {
+      Close();
+      return false;
+   }
+
+   m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0u, 0u, 0u));
+#else
+   m_fileDescriptor = open(p_path, O_RDONLY);
+   if (m_fileDescriptor == -1)
+   {
+      return false;
+   }
+
+   struct stat fileStat;
+   if (fstat(m_fileDescriptor, &fileStat) != 0)
+   {
+      Close();
+      return false;
+   }
+   m_size = static_cast<uint64_t>(fileStat.st_size);
+
+   // Empty files can't be mapped
+   if (m_size == 0u)
+   {
+      return true;
+   }
+
+   void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fileDescriptor, 0);
+   if (data != MAP_FAILED)
+   {
+      m_data = static_cast<const uint8_t*>(data);
+
+      // The file is streamed front to back, which allows the kernel to read further ahead
+      madvise(data, m_size, MADV_SEQUENTIAL);
+   }
+#endif
+
+   if (m_data == nullptr)
+   {
+      Close();
+      return false;
+   }
+
+   return true;
+}
+
+void MappedFile::Close()
+{
+#if defined(_WIN32)
+   if (m_data)
+   {
+      UnmapViewOfFile(m_data);
+   }
+
+   if (m_mappingHandle)
+   {
+      CloseHandle(m_mappingHandle);
+      m_mappingHandle = nullptr;
+   }
+
+   if (m_fileHandle)
+   {
+      CloseHandle(m_fileHandle);
+      m_fileHandle = nullptr;
+   }
+#else
+   if (m_data)
+   {
+      munmap(const_cast<uint8_t*>(m_data), m_size);
+   }
+
+   if (m_fileDescriptor != -1)
+   {
+      close(m_fileDescriptor);
+      m_fileDescriptor = -1;
+   }
+#endif
+
+   m_data = nullptr;
+   m_size = 0u;
+}
+
+bool MappedFile::IsOpen() const
+{
+#if defined(_WIN32)
+   return m_fileHandle != nullptr;
+#else
+   return m_fileDescriptor != -1;
+#endif
+}
+
+const uint8_t* MappedFile::GetData() const
+{
+   return m_data;
+}
+
+uint64_t MappedFile::GetSize() const
+{
+   return m_size;
+}
+
+void MappedFile::WillNeed(uint64_t p_offsetInBytes, uint64_t p_sizeInBytes) const
+{
+   uint8_t* pageStart = nullptr;
+   uint64_t pageRangeSize = 0u;
+   GetPageRange(p_offsetInBytes, p_sizeInBytes, pageStart, pageRangeSize);
+   if (pageRangeSize == 0u)
+   {
+      return;
+   }
+
+#if defined(_WIN32)
+   WIN32_MEMORY_RANGE_ENTRY rangeEntry{.VirtualAddress = pageStart, .NumberOfBytes = static_cast<SIZE_T>(pageRangeSize)};
+   PrefetchVirtualMemory(GetCurrentProcess(), 1u, &rangeEntry, 0u);
+#else
+   madvise(pageStart, pageRangeSize, MADV_WILLNEED);
+#endif
+}
+
+void MappedFile::DontNeed(uint64_t p_offsetInBytes, uint64_t p_sizeInBytes) const
+{
+   uint8_t* pageStart = nullptr;
+   uint64_t pageRangeSize = 0u;
+   GetPageRange(p_offsetInBytes, p_sizeInBytes, pageStart, pageRangeSize);
+   if (pageRangeSize == 0u)
+   {
+      return;
+   }
+
+#if defined(_WIN32)
+   // Unlocking pages that aren't locked removes them from the working set, the mapping stays valid
+   VirtualUnlock(pageStart, static_cast<SIZE_T>(pageRangeSize));
+#else
+   // The mapping is read-only, the pages are read from the file again if they're touched afterwards
+   madvise(pageStart, pageRangeSize, MADV_DONTNEED);
+#endif
+}
+
+void MappedFile::GetPageRange(uint64_t p_offsetInBytes, uint64_t p_sizeInBytes, uint8_t*& p_pageStart,
+                              uint64_t& p_pageRangeSize) const
+{
+   static const uint64_t pageSize = Internal::GetPageSize();
+
+   const uint64_t begin = eastl::min(p_offsetInBytes, m_size);
+   const uint64_t end = begin + eastl::min(p_sizeInBytes, m_size - begin);
+   const uint64_t pageAlignedBegin = begin / pageSize * pageSize;
+
+   p_pageStart = const_cast<uint8_t*>(m_data) + pageAlignedBegin;
+   p_pageRangeSize = end > begin ? end - pageAlignedBegin : 0u;
+}
+
+} // namespace Render
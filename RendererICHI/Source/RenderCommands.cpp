@@ -6,6 +6,7 @@
 #include <BufferView.h>
 #include <Buffer.h>
 #include <GraphicsPipeline.h>
+#include <ComputePipeline.h>
 #include <DescriptorSet.h>
 #include <ImageView.h>
 #include <Image.h>
@@ -220,6 +221,8 @@ void BindVertexBuffersCommand::ExecuteInternal(CommandBufferBase* p_commandBuffe
       offsets.push_back(vertexBufferView.m_vertexBufferView->GetOffsetFromBase());
       sizes.push_back(vertexBufferView.m_vertexBufferView->GetViewRange());
       strides.push_back(vertexBufferView.m_stride);
+
+      p_commandBuffer->AddReferencedResource(vertexBufferView.m_vertexBufferView->GetBuffer().get());
    }
 
    vkCmdBindVertexBuffers2(p_commandBuffer->GetCommandBufferNative(), m_firstBinding,
@@ -370,6 +373,14 @@ BindDescriptorSetsCommand::BindDescriptorSetsCommand(PipelineBindPoint p_pipelin
 
 void BindDescriptorSetsCommand::ExecuteInternal(CommandBufferBase* p_commandBuffer)
 {
+   for (const Ptr<DescriptorSet>& descriptorSet : m_descriptorSets)
+   {
+      for (const Buffer* buffer : descriptorSet->GetBoundBuffers())
+      {
+         p_commandBuffer->AddReferencedResource(buffer);
+      }
+   }
+
    vkCmdBindDescriptorSets(p_commandBuffer->GetCommandBufferNative(), m_nativePipelineBindPoint, m_nativePipelineLayout, m_firstSet,
                            static_cast<uint32_t>(m_nativeDescriptorSets.size()), m_nativeDescriptorSets.data(),
                            static_cast<uint32_t>(m_dynamicOffsets.size()), m_dynamicOffsets.data());
@@ -387,6 +398,16 @@ BindPipelineCommand::BindPipelineCommand(PipelineBindPoint p_pipelineBindPoint,
    m_nativePipeline = m_graphicsPipeline->GetGraphicsPipelineNative();
 }
 
+BindPipelineCommand::BindPipelineCommand(Ptr<ComputePipeline> p_computePipeline)
+    : RenderCommand("Bind Pipeline", RenderCommandType::SetState)
+{
+   m_pipelineBindPoint = PipelineBindPoint::Compute;
+   m_computePipeline = p_computePipeline;
+
+   m_nativePipelineBindPoint = RenderTypeToNative::PipelineBindPointToNative(m_pipelineBindPoint);
+   m_nativePipeline = m_computePipeline->GetComputePipelineNative();
+}
+
 void BindPipelineCommand::ExecuteInternal(CommandBufferBase* p_commandBuffer)
 {
    vkCmdBindPipeline(p_commandBuffer->GetCommandBufferNative(), m_nativePipelineBindPoint, m_nativePipeline);
@@ -421,6 +442,8 @@ void BindIndexBufferCommand::ExecuteInternal(CommandBufferBase* p_commandBuffer)
 {
    vkCmdBindIndexBuffer(p_commandBuffer->GetCommandBufferNative(), m_indexBuffer->GetBuffer()->GetBufferNative(),
                         m_indexBuffer->GetOffsetFromBase(), m_nativeIndexType);
+
+   p_commandBuffer->AddReferencedResource(m_indexBuffer->GetBuffer().get());
 }
 
 // ----------- ExecuteCommandsCommand -----------
@@ -481,6 +504,18 @@ PipelineBarrierCommand* PipelineBarrierCommand::AddBufferBarrier(VkPipelineStage
    return this;
 }
 
+PipelineBarrierCommand* PipelineBarrierCommand::AddBufferBarrier(VkPipelineStageFlags2 p_srcStageMask,
+                                                                 VkAccessFlags2 p_srcAccessMask,
+                                                                 VkPipelineStageFlags2 p_dstStageMask,
+                                                                 VkAccessFlags2 p_dstAccessMask, uint32_t p_srcQueueFamilyIndex,
+                                                                 uint32_t p_dstQueueFamilyIndex, Ptr<Buffer> p_buffer,
+                                                                 uint64_t p_offset, uint64_t p_size)
+{
+   m_bufferBarriers.emplace_back(p_srcStageMask, p_srcAccessMask, p_dstStageMask, p_dstAccessMask, p_srcQueueFamilyIndex,
+                                 p_dstQueueFamilyIndex, nullptr, p_buffer, p_offset, p_size);
+   return this;
+}
+
 PipelineBarrierCommand* PipelineBarrierCommand::AddImageBarrier(VkPipelineStageFlags2 p_srcStageMask,
                                                                 VkAccessFlags2 p_srcAccessMask,
                                                                 VkPipelineStageFlags2 p_dstStageMask,
@@ -493,6 +528,19 @@ PipelineBarrierCommand* PipelineBarrierCommand::AddImageBarrier(VkPipelineStageF
    return this;
 }
 
+PipelineBarrierCommand* PipelineBarrierCommand::AddImageBarrier(VkPipelineStageFlags2 p_srcStageMask,
+                                                                VkAccessFlags2 p_srcAccessMask,
+                                                                VkPipelineStageFlags2 p_dstStageMask,
+                                                                VkAccessFlags2 p_dstAccessMask, VkImageLayout p_oldLayout,
+                                                                VkImageLayout p_newLayout, uint32_t p_srcQueueFamilyIndex,
+                                                                uint32_t p_dstQueueFamilyIndex, Ptr<Image> p_image,
+                                                                const VkImageSubresourceRange& p_subresourceRange)
+{
+   m_imageBarriers.emplace_back(p_srcStageMask, p_srcAccessMask, p_dstStageMask, p_dstAccessMask, p_oldLayout, p_newLayout,
+                                p_srcQueueFamilyIndex, p_dstQueueFamilyIndex, nullptr, p_image, p_subresourceRange);
+   return this;
+}
+
 void PipelineBarrierCommand::ExecuteInternal(CommandBufferBase* p_commandBuffer)
 {
    Std::vector<VkMemoryBarrier2> memoryBarriersNative;
@@ -507,6 +555,16 @@ void PipelineBarrierCommand::ExecuteInternal(CommandBufferBase* p_commandBuffer)
    bufferBarriersNative.reserve(m_bufferBarriers.size());
    for (PipelineBufferBarrier& barrier : m_bufferBarriers)
    {
+      // Barriers without a BufferView provide the Buffer and the range directly
+      if (!barrier.m_bufferView)
+      {
+         bufferBarriersNative.emplace_back(VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2, nullptr, barrier.m_srcStageMask,
+                                           barrier.m_srcAccessMask, barrier.m_dstStageMask, barrier.m_dstAccessMask,
+                                           barrier.m_srcQueueFamilyIndex, barrier.m_dstQueueFamilyIndex,
+                                           barrier.m_buffer->GetBufferNative(), barrier.m_offset, barrier.m_size);
+         continue;
+      }
+
       const VkBuffer bufferNative = barrier.m_bufferView->GetBuffer()->GetBufferNative();
       const uint64_t offset = barrier.m_bufferView->GetOffsetFromBase();
       const uint64_t size = barrier.m_bufferView->GetViewRange();
@@ -520,6 +578,17 @@ void PipelineBarrierCommand::ExecuteInternal(CommandBufferBase* p_commandBuffer)
    imageBarriersNative.reserve(m_imageBarriers.size());
    for (PipelineImageBarrier& barrier : m_imageBarriers)
    {
+      // Barriers without an ImageView provide the Image and the SubresourceRange directly
+      if (!barrier.m_imageView)
+      {
+         imageBarriersNative.emplace_back(VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2, nullptr, barrier.m_srcStageMask,
+                                          barrier.m_srcAccessMask, barrier.m_dstStageMask, barrier.m_dstAccessMask,
+                                          barrier.m_oldLayout, barrier.m_newLayout, barrier.m_srcQueueFamilyIndex,
+                                          barrier.m_dstQueueFamilyIndex, barrier.m_image->GetImageNative(),
+                                          barrier.m_subresourceRange);
+         continue;
+      }
+
       const VkImage imageNative = barrier.m_imageView->GetImage()->GetImageNative();
 
       Ptr<ImageView> imageView = barrier.m_imageView;
@@ -571,6 +640,40 @@ void DrawIndexedCommand::ExecuteInternal(CommandBufferBase* p_commandBuffer)
                     m_firstInstance);
 }
 
+// ----------- PushConstantsCommand -----------
+
+PushConstantsCommand::PushConstantsCommand(Ptr<ComputePipeline> p_computePipeline, uint32_t p_offset, const void* p_data,
+                                           uint32_t p_dataSize)
+    : RenderCommand("Push Constants", RenderCommandType::SetState)
+{
+   m_computePipeline = p_computePipeline;
+   m_offset = p_offset;
+
+   const uint8_t* data = static_cast<const uint8_t*>(p_data);
+   m_data.assign(data, data + p_dataSize);
+}
+
+void PushConstantsCommand::ExecuteInternal(CommandBufferBase* p_commandBuffer)
+{
+   vkCmdPushConstants(p_commandBuffer->GetCommandBufferNative(), m_computePipeline->GetComputePipelineLayoutNative(),
+                      VK_SHADER_STAGE_COMPUTE_BIT, m_offset, static_cast<uint32_t>(m_data.size()), m_data.data());
+}
+
+// ----------- DispatchCommand -----------
+
+DispatchCommand::DispatchCommand(uint32_t p_groupCountX, uint32_t p_groupCountY, uint32_t p_groupCountZ)
+    : RenderCommand("Dispatch", RenderCommandType::Action)
+{
+   m_groupCountX = p_groupCountX;
+   m_groupCountY = p_groupCountY;
+   m_groupCountZ = p_groupCountZ;
+}
+
+void DispatchCommand::ExecuteInternal(CommandBufferBase* p_commandBuffer)
+{
+   vkCmdDispatch(p_commandBuffer->GetCommandBufferNative(), m_groupCountX, m_groupCountY, m_groupCountZ);
+}
+
 // ----------- CopyBufferCommand -----------
 
 CopyBufferCommand::CopyBufferCommand(Ptr<Buffer> p_srcBuffer, Ptr<Buffer> p_destBuffer, Std::span<BufferCopyRegion> p_copyRegions)
@@ -590,6 +693,179 @@ void CopyBufferCommand::ExecuteInternal(CommandBufferBase* p_commandBuffer)
 {
    vkCmdCopyBuffer(p_commandBuffer->GetCommandBufferNative(), m_srcBuffer->GetBufferNative(), m_destBuffer->GetBufferNative(),
                    static_cast<uint32_t>(m_bufferCopyRegions.size()), m_bufferCopyRegions.data());
+
+   p_commandBuffer->AddReferencedResource(m_srcBuffer.get());
+   p_commandBuffer->AddReferencedResource(m_destBuffer.get());
+}
+
+// ----------- UpdateBufferCommand -----------
+
+UpdateBufferCommand::UpdateBufferCommand(Ptr<Buffer> p_destBuffer, uint64_t p_destOffset, const void* p_data, uint64_t p_dataSize)
+    : RenderCommand("Update Buffer", RenderCommandType::Action)
+{
+   m_destBuffer = p_destBuffer;
+   m_destOffset = p_destOffset;
+
+   const uint8_t* data = static_cast<const uint8_t*>(p_data);
+   m_data.assign(data, data + p_dataSize);
+}
+
+void UpdateBufferCommand::ExecuteInternal(CommandBufferBase* p_commandBuffer)
+{
+   vkCmdUpdateBuffer(p_commandBuffer->GetCommandBufferNative(), m_destBuffer->GetBufferNative(), m_destOffset,
+                     static_cast<VkDeviceSize>(m_data.size()), m_data.data());
+
+   p_commandBuffer->AddReferencedResource(m_destBuffer.get());
+}
+
+// ----------- FillBufferCommand -----------
+
+FillBufferCommand::FillBufferCommand(Ptr<Buffer> p_destBuffer, uint64_t p_destOffset, uint64_t p_size, uint32_t p_data)
+    : RenderCommand("Fill Buffer", RenderCommandType::Action)
+{
+   m_destBuffer = p_destBuffer;
+   m_destOffset = p_destOffset;
+   m_size = p_size;
+   m_data = p_data;
+}
+
+void FillBufferCommand::ExecuteInternal(CommandBufferBase* p_commandBuffer)
+{
+   vkCmdFillBuffer(p_commandBuffer->GetCommandBufferNative(), m_destBuffer->GetBufferNative(), m_destOffset, m_size, m_data);
+
+   p_commandBuffer->AddReferencedResource(m_destBuffer.get());
+}
+
+// ----------- CopyBufferToImageCommand -----------
+
+namespace
+{
+namespace Internal
+{
+VkBufferImageCopy BufferImageCopyRegionToNative(const BufferImageCopyRegion& p_copyRegion)
+{
+   return VkBufferImageCopy{.bufferOffset = p_copyRegion.m_bufferOffset,
+                            .bufferRowLength = p_copyRegion.m_bufferRowLength,
+                            .bufferImageHeight = p_copyRegion.m_bufferImageHeight,
+                            .imageSubresource = p_copyRegion.m_imageSubresource,
+                            .imageOffset = p_copyRegion.m_imageOffset,
+                            .imageExtent = p_copyRegion.m_imageExtent};
+}
+}; // namespace Internal
+}; // namespace
+
+CopyBufferToImageCommand::CopyBufferToImageCommand(Ptr<Buffer> p_srcBuffer, Ptr<Image> p_destImage, VkImageLayout p_destImageLayout,
+                                                   Std::span<BufferImageCopyRegion> p_copyRegions)
+    : RenderCommand("Copy Buffer To Image", RenderCommandType::Action)
+{
+   m_srcBuffer = p_srcBuffer;
+   m_destImage = p_destImage;
+   m_destImageLayout = p_destImageLayout;
+
+   m_copyRegions.reserve(p_copyRegions.size());
+   for (const BufferImageCopyRegion& copyRegion : p_copyRegions)
+   {
+      m_copyRegions.push_back(Internal::BufferImageCopyRegionToNative(copyRegion));
+   }
+}
+
+void CopyBufferToImageCommand::ExecuteInternal(CommandBufferBase* p_commandBuffer)
+{
+   vkCmdCopyBufferToImage(p_commandBuffer->GetCommandBufferNative(), m_srcBuffer->GetBufferNative(), m_destImage->GetImageNative(),
+                          m_destImageLayout, static_cast<uint32_t>(m_copyRegions.size()), m_copyRegions.data());
+
+   p_commandBuffer->AddReferencedResource(m_srcBuffer.get());
+   p_commandBuffer->AddReferencedResource(m_destImage.get());
+}
+
+// ----------- CopyImageToBufferCommand -----------
+
+CopyImageToBufferCommand::CopyImageToBufferCommand(Ptr<Image> p_srcImage, VkImageLayout p_srcImageLayout, Ptr<Buffer> p_destBuffer,
+                                                   Std::span<BufferImageCopyRegion> p_copyRegions)
+    : RenderCommand("Copy Image To Buffer", RenderCommandType::Action)
+{
+   m_srcImage = p_srcImage;
+   m_srcImageLayout = p_srcImageLayout;
+   m_destBuffer = p_destBuffer;
+
+   m_copyRegions.reserve(p_copyRegions.size());
+   for (const BufferImageCopyRegion& copyRegion : p_copyRegions)
+   {
+      m_copyRegions.push_back(Internal::BufferImageCopyRegionToNative(copyRegion));
+   }
+}
+
+void CopyImageToBufferCommand::ExecuteInternal(CommandBufferBase* p_commandBuffer)
+{
+   vkCmdCopyImageToBuffer(p_commandBuffer->GetCommandBufferNative(), m_srcImage->GetImageNative(), m_srcImageLayout,
+                          m_destBuffer->GetBufferNative(), static_cast<uint32_t>(m_copyRegions.size()), m_copyRegions.data());
+
+   p_commandBuffer->AddReferencedResource(m_srcImage.get());
+   p_commandBuffer->AddReferencedResource(m_destBuffer.get());
+}
+
+// ----------- CopyImageCommand -----------
+
+CopyImageCommand::CopyImageCommand(Ptr<Image> p_srcImage, VkImageLayout p_srcImageLayout, Ptr<Image> p_destImage,
+                                   VkImageLayout p_destImageLayout, Std::span<ImageCopyRegion> p_copyRegions)
+    : RenderCommand("Copy Image", RenderCommandType::Action)
+{
+   m_srcImage = p_srcImage;
+   m_srcImageLayout = p_srcImageLayout;
+   m_destImage = p_destImage;
+   m_destImageLayout = p_destImageLayout;
+
+   m_copyRegions.reserve(p_copyRegions.size());
+   for (const ImageCopyRegion& copyRegion : p_copyRegions)
+   {
+      m_copyRegions.push_back(VkImageCopy{.srcSubresource = copyRegion.m_srcSubresource,
+                                          .srcOffset = copyRegion.m_srcOffset,
+                                          .dstSubresource = copyRegion.m_destSubresource,
+                                          .dstOffset = copyRegion.m_destOffset,
+                                          .extent = copyRegion.m_extent});
+   }
+}
+
+void CopyImageCommand::ExecuteInternal(CommandBufferBase* p_commandBuffer)
+{
+   vkCmdCopyImage(p_commandBuffer->GetCommandBufferNative(), m_srcImage->GetImageNative(), m_srcImageLayout,
+                  m_destImage->GetImageNative(), m_destImageLayout, static_cast<uint32_t>(m_copyRegions.size()),
+                  m_copyRegions.data());
+
+   p_commandBuffer->AddReferencedResource(m_srcImage.get());
+   p_commandBuffer->AddReferencedResource(m_destImage.get());
+}
+
+// ----------- BlitImageCommand -----------
+
+BlitImageCommand::BlitImageCommand(Ptr<Image> p_srcImage, VkImageLayout p_srcImageLayout, Ptr<Image> p_destImage,
+                                   VkImageLayout p_destImageLayout, Std::span<ImageBlitRegion> p_blitRegions, VkFilter p_filter)
+    : RenderCommand("Blit Image", RenderCommandType::Action)
+{
+   m_srcImage = p_srcImage;
+   m_srcImageLayout = p_srcImageLayout;
+   m_destImage = p_destImage;
+   m_destImageLayout = p_destImageLayout;
+   m_filter = p_filter;
+
+   m_blitRegions.reserve(p_blitRegions.size());
+   for (const ImageBlitRegion& blitRegion : p_blitRegions)
+   {
+      m_blitRegions.push_back(VkImageBlit{.srcSubresource = blitRegion.m_srcSubresource,
+                                          .srcOffsets = {blitRegion.m_srcOffsets[0], blitRegion.m_srcOffsets[1]},
+                                          .dstSubresource = blitRegion.m_destSubresource,
+                                          .dstOffsets = {blitRegion.m_destOffsets[0], blitRegion.m_destOffsets[1]}});
+   }
+}
+
+void BlitImageCommand::ExecuteInternal(CommandBufferBase* p_commandBuffer)
+{
+   vkCmdBlitImage(p_commandBuffer->GetCommandBufferNative(), m_srcImage->GetImageNative(), m_srcImageLayout,
+                  m_destImage->GetImageNative(), m_destImageLayout, static_cast<uint32_t>(m_blitRegions.size()),
+                  m_blitRegions.data(), m_filter);
+
+   p_commandBuffer->AddReferencedResource(m_srcImage.get());
+   p_commandBuffer->AddReferencedResource(m_destImage.get());
 }
 
 BindDescriptorSetsCommand::~BindDescriptorSetsCommand()
@@ -607,6 +883,23 @@ BeginRenderingCommand::BeginRenderingCommand(VkRect2D p_renderArea, Std::span<Re
    m_colorAttachments.assign(p_colorAttachments.begin(), p_colorAttachments.end());
    m_depthAttachment = p_depthAttachment;
    m_stencilAttachment = p_stencilAttachment;
+
+   // Resolve the StoreOp of attachments that didn't explicitly set one. The contents of transient attachments are never needed
+   // after the pass, so don't write them back to memory.
+   const auto ResolveDefaultStoreOp = [](RenderingAttachmentInfo& p_attachmentInfo) {
+      if (p_attachmentInfo.m_storeOp == AttachmentStoreOp::Invalid && p_attachmentInfo.m_imageView.get())
+      {
+         const bool isTransient = p_attachmentInfo.m_imageView->GetImage()->IsTransient();
+         p_attachmentInfo.m_storeOp = isTransient ? AttachmentStoreOp::DontCare : AttachmentStoreOp::Store;
+      }
+   };
+
+   for (RenderingAttachmentInfo& colorAttachment : m_colorAttachments)
+   {
+      ResolveDefaultStoreOp(colorAttachment);
+   }
+   ResolveDefaultStoreOp(m_depthAttachment);
+   ResolveDefaultStoreOp(m_stencilAttachment);
 }
 
 void BeginRenderingCommand::ExecuteInternal(CommandBufferBase* p_commandBuffer)
@@ -628,6 +921,8 @@ void BeginRenderingCommand::ExecuteInternal(CommandBufferBase* p_commandBuffer)
       nativeAttachmentInfo.storeOp = RenderTypeToNative::AttachmentStoreOpToNative(attachmentInfo.m_storeOp);
       nativeAttachmentInfo.clearValue = attachmentInfo.m_clearValue;
 
+      p_commandBuffer->AddReferencedResource(attachmentInfo.m_imageView->GetImage().get());
+
       return nativeAttachmentInfo;
    };
 
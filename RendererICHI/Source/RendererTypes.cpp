@@ -21,6 +21,7 @@ VkBufferUsageFlags RenderTypeToNative::BufferUsageFlagsToNative(const BufferUsag
        {BufferUsageFlags::IndexBuffer, VK_BUFFER_USAGE_INDEX_BUFFER_BIT},
        {BufferUsageFlags::VertexBuffer, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT},
        {BufferUsageFlags::IndirectBuffer, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT},
+       {BufferUsageFlags::ShaderDeviceAddress, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT},
    };
 
    return Foundation::Util::FlagsToNativeHelper<VkBufferUsageFlags>(BufferUsageFlagsToNativeMap, p_bufferUsageFlags);
@@ -33,6 +34,7 @@ VkMemoryPropertyFlags RenderTypeToNative::MemoryPropertyFlagsToNative(const Memo
        {MemoryPropertyFlags::HostVisible, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT},
        {MemoryPropertyFlags::HostCoherent, VK_MEMORY_PROPERTY_HOST_COHERENT_BIT},
        {MemoryPropertyFlags::HostCached, VK_MEMORY_PROPERTY_HOST_CACHED_BIT},
+       {MemoryPropertyFlags::LazilyAllocated, VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT},
    };
 
    return Foundation::Util::FlagsToNativeHelper<VkMemoryPropertyFlags>(MemoryPropertyFlagsToNativeMap, p_memoryPropertyFlags);
@@ -82,6 +84,7 @@ VkDescriptorType RenderTypeToNative::DescriptorTypeToNative(const DescriptorType
        {DescriptorType::UniformBuffer, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC},
        {DescriptorType::StorageBuffer, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC},
        {DescriptorType::InputAttachment, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT},
+       {DescriptorType::StaticStorageBuffer, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER},
    };
 
    return Foundation::Util::EnumToNativeHelper<VkDescriptorType>(DescriptorTypeToNativeMap, p_descriptorType);
@@ -1,13 +1,68 @@
 #include <ResourceTracker.h>
 
+#include <EASTL/sort.h>
+
+#include <Util/Util.h>
+
 #include <RenderResource.h>
+#include <RendererStateInterface.h>
 
 namespace Render
 {
 
+namespace
+{
+namespace Internal
+{
+const char* MemoryTelemetryCategoryToString(MemoryTelemetryCategory p_category)
+{
+   switch (p_category)
+   {
+   case MemoryTelemetryCategory::Buffer:
+      return "Buffer";
+   case MemoryTelemetryCategory::Image:
+      return "Image";
+   case MemoryTelemetryCategory::DescriptorPool:
+      return "DescriptorPool";
+   case MemoryTelemetryCategory::CommandPool:
+      return "CommandPool";
+   case MemoryTelemetryCategory::Staging:
+      return "Staging";
+   default:
+      ASSERT(false, "Invalid MemoryTelemetryCategory");
+      return "Invalid";
+   }
+}
+
+// Names are user provided, escape the characters that would break the JSON/CSV output. JSON escapes with a backslash, CSV by
+// doubling the quote
+Std::string EscapeName(Std::string_view p_name, char p_escapeCharacter)
+{
+   Std::string escapedName;
+   escapedName.reserve(p_name.size());
+   for (const char character : p_name)
+   {
+      if (character == '"' || character == p_escapeCharacter)
+      {
+         escapedName.push_back(p_escapeCharacter);
+      }
+      escapedName.push_back(character);
+   }
+   return escapedName;
+}
+
+uint64_t GetCurrentFrameIndex()
+{
+   // Resources can be created before the RenderState is registered
+   return RenderStateInterface::IsRegistered() ? RenderStateInterface::Get()->GetFrameIndex() : 0u;
+}
+}; // namespace Internal
+}; // namespace
+
 ResourceTracker::~ResourceTracker()
 {
    ASSERT(m_trackedResources.empty(), "There are dangling resources");
+   ASSERT(m_memoryRecords.empty(), "There are allocations that were never reported as deallocated");
 }
 
 void ResourceTracker::Track(Resource* p_resource)
@@ -31,4 +86,186 @@ bool ResourceTracker::IsTracked(Resource* p_resource)
    return m_trackedResources.find(p_resource) != m_trackedResources.end();
 }
 
-} // namespace Render
\ No newline at end of file
+// ----------- Memory Telemetry -----------
+
+void ResourceTracker::ReportAllocation(const void* p_owner, MemoryTelemetryRecord&& p_record)
+{
+   std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+   const uint64_t frameIndex = Internal::GetCurrentFrameIndex();
+   p_record.m_creationFrame = frameIndex;
+   p_record.m_lastReferencedFrame = frameIndex;
+
+   MemoryTelemetryFrameDelta& frameDelta = GetCurrentFrameDelta();
+   frameDelta.m_allocatedBytes += p_record.m_sizeInBytes;
+   frameDelta.m_allocationCount++;
+
+   [[maybe_unused]] const auto [it, inserted] = m_memoryRecords.emplace(p_owner, eastl::move(p_record));
+   ASSERT(inserted, "The owner already reported an allocation");
+}
+
+void ResourceTracker::ReportDeallocation(const void* p_owner)
+{
+   std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+   const auto recordIt = m_memoryRecords.find(p_owner);
+   ASSERT(recordIt != m_memoryRecords.end(), "The owner never reported an allocation");
+
+   MemoryTelemetryFrameDelta& frameDelta = GetCurrentFrameDelta();
+   frameDelta.m_freedBytes += recordIt->second.m_sizeInBytes;
+   frameDelta.m_freeCount++;
+
+   m_memoryRecords.erase(recordIt);
+}
+
+void ResourceTracker::MarkReferenced(const void* p_owner)
+{
+   std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+   const auto recordIt = m_memoryRecords.find(p_owner);
+   if (recordIt != m_memoryRecords.end())
+   {
+      recordIt->second.m_lastReferencedFrame = Internal::GetCurrentFrameIndex();
+   }
+}
+
+void ResourceTracker::MarkReferenced(Std::span<const void* const> p_owners)
+{
+   if (p_owners.empty())
+   {
+      return;
+   }
+
+   const uint64_t frameIndex = Internal::GetCurrentFrameIndex();
+
+   std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+   for (const void* owner : p_owners)
+   {
+      const auto recordIt = m_memoryRecords.find(owner);
+      if (recordIt != m_memoryRecords.end())
+      {
+         recordIt->second.m_lastReferencedFrame = frameIndex;
+      }
+   }
+}
+
+Std::vector<MemoryTelemetryRecord> ResourceTracker::GetLargestAllocations(uint32_t p_count)
+{
+   Std::vector<MemoryTelemetryRecord> records = GetRecordsSnapshot();
+
+   eastl::sort(records.begin(), records.end(), [](const MemoryTelemetryRecord& p_lhs, const MemoryTelemetryRecord& p_rhs) {
+      return p_lhs.m_sizeInBytes > p_rhs.m_sizeInBytes;
+   });
+
+   if (records.size() > p_count)
+   {
+      records.resize(p_count);
+   }
+
+   return records;
+}
+
+Std::vector<MemoryTelemetryRecord> ResourceTracker::GetStaleAllocations(uint64_t p_frameCount)
+{
+   const uint64_t frameIndex = Internal::GetCurrentFrameIndex();
+
+   Std::vector<MemoryTelemetryRecord> staleRecords;
+   for (MemoryTelemetryRecord& record : GetRecordsSnapshot())
+   {
+      if (frameIndex - record.m_lastReferencedFrame >= p_frameCount)
+      {
+         staleRecords.push_back(eastl::move(record));
+      }
+   }
+
+   return staleRecords;
+}
+
+MemoryTelemetryFrameDelta ResourceTracker::GetFrameDelta(uint64_t p_frameIndex)
+{
+   std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+   const MemoryTelemetryFrameDelta& frameDelta = m_frameDeltas[p_frameIndex % FrameDeltaHistoryCount];
+   if (frameDelta.m_frameIndex != p_frameIndex)
+   {
+      // Either nothing was allocated that frame, or it's no longer in the history
+      return MemoryTelemetryFrameDelta{.m_frameIndex = p_frameIndex};
+   }
+
+   return frameDelta;
+}
+
+Std::string ResourceTracker::DumpMemoryTelemetryJson()
+{
+   const Std::vector<MemoryTelemetryRecord> records = GetRecordsSnapshot();
+   const uint64_t frameIndex = Internal::GetCurrentFrameIndex();
+
+   Std::string json =
+       Foundation::Util::SimpleSprintf<Std::string>("{\n  \"frame\": %" PRIu64 ",\n  \"allocations\": [", frameIndex);
+   for (uint32_t i = 0u; i < records.size(); i++)
+   {
+      const MemoryTelemetryRecord& record = records[i];
+      json += Foundation::Util::SimpleSprintf<Std::string>(
+          "%s\n    {\"category\": \"%s\", \"name\": \"%s\", \"size\": %" PRIu64 ", \"memoryProperties\": %u, \"usage\": %u, "
+          "\"elementCount\": %u, \"creationFrame\": %" PRIu64 ", \"lastReferencedFrame\": %" PRIu64 "}",
+          i == 0u ? "" : ",", Internal::MemoryTelemetryCategoryToString(record.m_category),
+          Internal::EscapeName(record.m_name, '\\').c_str(), record.m_sizeInBytes, record.m_memoryPropertyFlags,
+          record.m_usageFlags, record.m_elementCount, record.m_creationFrame, record.m_lastReferencedFrame);
+   }
+   json += "\n  ]\n}\n";
+
+   return json;
+}
+
+Std::string ResourceTracker::DumpMemoryTelemetryCsv()
+{
+   const Std::vector<MemoryTelemetryRecord> records = GetRecordsSnapshot();
+
+   Std::string csv = "category,name,size,memoryProperties,usage,elementCount,creationFrame,lastReferencedFrame\n";
+   for (const MemoryTelemetryRecord& record : records)
+   {
+      csv += Foundation::Util::SimpleSprintf<Std::string>(
+          "%s,\"%s\",%" PRIu64 ",%u,%u,%u,%" PRIu64 ",%" PRIu64 "\n", Internal::MemoryTelemetryCategoryToString(record.m_category),
+          Internal::EscapeName(record.m_name, '"').c_str(), record.m_sizeInBytes, record.m_memoryPropertyFlags,
+          record.m_usageFlags, record.m_elementCount, record.m_creationFrame, record.m_lastReferencedFrame);
+   }
+
+   return csv;
+}
+
+Std::vector<MemoryTelemetryRecord> ResourceTracker::GetRecordsSnapshot()
+{
+   std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+   Std::vector<MemoryTelemetryRecord> records;
+   records.reserve(m_memoryRecords.size());
+   for (const auto& [owner, record] : m_memoryRecords)
+   {
+      records.push_back(record);
+
+      // Names are usually set after the allocation was reported, resolve it now
+      MemoryTelemetryRecord& recordCopy = records.back();
+      if (recordCopy.m_resource && !recordCopy.m_resource->GetName().empty())
+      {
+         recordCopy.m_name = recordCopy.m_resource->GetName();
+      }
+   }
+
+   return records;
+}
+
+MemoryTelemetryFrameDelta& ResourceTracker::GetCurrentFrameDelta()
+{
+   const uint64_t frameIndex = Internal::GetCurrentFrameIndex();
+
+   MemoryTelemetryFrameDelta& frameDelta = m_frameDeltas[frameIndex % FrameDeltaHistoryCount];
+   if (frameDelta.m_frameIndex != frameIndex)
+   {
+      frameDelta = MemoryTelemetryFrameDelta{.m_frameIndex = frameIndex};
+   }
+
+   return frameDelta;
+}
+
+} // namespace Render
@@ -0,0 +1,198 @@
+#include <ScatterUploader.h>
+
+#include <EASTL/algorithm.h>
+
+#include <Std/vector.h>
+
+#include <Util/Assert.h>
+#include <Util/Util.h>
+
+#include <Buffer.h>
+#include <CommandBuffer.h>
+#include <ComputePipeline.h>
+#include <RendererStateInterface.h>
+#include <ShaderModule.h>
+#include <ShaderStage.h>
+#include <StagingCopy.h>
+#include <VulkanDevice.h>
+
+namespace Render
+{
+
+namespace
+{
+namespace Internal
+{
+// SPIR-V of Shaders/ScatterUpload.comp, generated by the build
+static constexpr uint32_t ScatterUploadShaderSpirv[] = {
+#include <ScatterUpload.comp.inl>
+};
+
+// The table is read as an array of 16 byte records
+static constexpr uint64_t StagingAlignment = 16u;
+}; // namespace Internal
+}; // namespace
+
+ScatterUploader::ScatterUploader(ScatterUploaderDescriptor&& p_desc)
+{
+   m_descriptor = p_desc;
+
+   ASSERT(m_descriptor.m_vulkanDevice->IsBufferDeviceAddressSupported(), "The ScatterUploader requires buffer device addresses");
+
+   m_shaderModule = ShaderModule::CreateInstance(
+       ShaderModuleDescriptor{.m_spirvBinary = Internal::ScatterUploadShaderSpirv,
+                              .m_binarySizeInBytes = static_cast<uint32_t>(sizeof(Internal::ScatterUploadShaderSpirv)),
+                              .m_device = m_descriptor.m_vulkanDevice});
+   m_shaderStage = ShaderStage::CreateInstance(ShaderStageDescriptor{
+       .m_shaderModule = m_shaderModule, .m_shaderStage = VK_SHADER_STAGE_COMPUTE_BIT, .m_entryPoint = "main"});
+   m_computePipeline = ComputePipeline::CreateInstance(
+       ComputePipelineDescriptor{.m_vulkanDevice = m_descriptor.m_vulkanDevice,
+                                 .m_shaderStage = m_shaderStage,
+                                 .m_pushConstantSizeInBytes = static_cast<uint32_t>(sizeof(PushConstants))});
+
+   // The invocation index of the records of a dispatch has to fit in 32 bits as well
+   const uint64_t maxWorkgroupCount =
+       m_descriptor.m_vulkanDevice->GetPhysicalDeviceProperties().limits.maxComputeWorkGroupCount[0];
+   m_maxRecordsPerDispatch = static_cast<uint32_t>(eastl::min(maxWorkgroupCount * (WorkgroupSize / LanesPerRecord),
+                                                              static_cast<uint64_t>(UINT32_MAX / WorkgroupSize)));
+
+   for (FrameStaging& frameStaging : m_frameStagings)
+   {
+      BufferDescriptor bufferDescriptor;
+      bufferDescriptor.m_vulkanDevice = m_descriptor.m_vulkanDevice;
+      bufferDescriptor.m_bufferSize = m_descriptor.m_stagingSizeInBytesPerFrame;
+      bufferDescriptor.m_memoryProperties =
+          Foundation::Util::SetFlags<MemoryPropertyFlags>(MemoryPropertyFlags::HostVisible, MemoryPropertyFlags::HostCoherent);
+      bufferDescriptor.m_bufferUsageFlags = BufferUsageFlags::ShaderDeviceAddress;
+      frameStaging.m_stagingBuffer = Buffer::CreateInstance(eastl::move(bufferDescriptor));
+      frameStaging.m_stagingBuffer->SetName("ScatterUploader Staging Buffer");
+
+      // The staging buffers stay mapped for the lifetime of the ScatterUploader
+      frameStaging.m_mappedData = static_cast<uint8_t*>(frameStaging.m_stagingBuffer->Map(0u));
+   }
+}
+
+ScatterUploader::~ScatterUploader()
+{
+   for (FrameStaging& frameStaging : m_frameStagings)
+   {
+      frameStaging.m_stagingBuffer->Unmap();
+   }
+}
+
+void ScatterUploader::ScatterUpload(CommandBufferBase* p_commandBuffer, Ptr<Buffer> p_destBuffer,
+                                    Std::span<const ScatterUploadRequest> p_scatterUploadRequests)
+{
+   ASSERT(!p_scatterUploadRequests.empty(), "Nothing to upload");
+   ASSERT(!p_destBuffer->IsShared(), "Buffer is shared by the ImmutableBufferCache, it can't be written");
+   ASSERT(p_commandBuffer->CanRecordTransferCommands(),
+          "ScatterUpload can't be recorded while rendering, or in a SubCommandBuffer");
+   // The graphics and compute QueueFamilies are selected with compute support, the transfer QueueFamily might not support it
+   ASSERT(p_commandBuffer->GetQueueType() == QueueFamilyType::GraphicsQueue ||
+              p_commandBuffer->GetQueueType() == QueueFamilyType::ComputeQueue,
+          "ScatterUpload dispatches a compute shader, the CommandBuffer's Queue must support compute");
+
+   // The table is laid out in front of the data of the records
+   const uint64_t tableSize = p_scatterUploadRequests.size() * sizeof(ScatterRecord);
+   uint64_t dataSize = 0u;
+   for (const ScatterUploadRequest& scatterUploadRequest : p_scatterUploadRequests)
+   {
+      ASSERT(scatterUploadRequest.m_sizeInBytes % 4u == 0u && scatterUploadRequest.m_destOffsetInBytes % 4u == 0u,
+             "Offset and size of a scatter upload must be a multiple of 4");
+      ASSERT(scatterUploadRequest.m_destOffsetInBytes + scatterUploadRequest.m_sizeInBytes <=
+                 p_destBuffer->GetBufferSizeRequested(),
+             "Range is out of the bounds of the Buffer");
+      ASSERT(scatterUploadRequest.m_destOffsetInBytes / 4u <= static_cast<uint64_t>(UINT32_MAX),
+             "Destination offsets are limited to 32 bit word offsets");
+      dataSize += scatterUploadRequest.m_sizeInBytes;
+   }
+   ASSERT(dataSize / 4u <= static_cast<uint64_t>(UINT32_MAX), "Source offsets are limited to 32 bit word offsets");
+
+   FrameStaging* frameStaging = nullptr;
+   const uint64_t stagingOffset = AllocateStaging(tableSize + dataSize, frameStaging);
+
+   // Fill the table, and copy the data of the records after it
+   ScatterRecord* table = reinterpret_cast<ScatterRecord*>(frameStaging->m_mappedData + stagingOffset);
+   uint8_t* data = frameStaging->m_mappedData + stagingOffset + tableSize;
+
+   Std::vector<StagingCopy::CopyRange> copyRanges;
+   copyRanges.reserve(p_scatterUploadRequests.size() + 1u);
+   Std::vector<ScatterRecord> records;
+   records.reserve(p_scatterUploadRequests.size());
+
+   uint64_t dataOffset = 0u;
+   for (const ScatterUploadRequest& scatterUploadRequest : p_scatterUploadRequests)
+   {
+      records.push_back(ScatterRecord{.m_destOffset = static_cast<uint32_t>(scatterUploadRequest.m_destOffsetInBytes / 4u),
+                                      .m_sourceOffset = static_cast<uint32_t>(dataOffset / 4u),
+                                      .m_size = scatterUploadRequest.m_sizeInBytes / 4u});
+      copyRanges.push_back(StagingCopy::CopyRange{.m_dest = data + dataOffset,
+                                                  .m_source = scatterUploadRequest.m_sourceData,
+                                                  .m_size = scatterUploadRequest.m_sizeInBytes});
+      dataOffset += scatterUploadRequest.m_sizeInBytes;
+   }
+   copyRanges.push_back(StagingCopy::CopyRange{.m_dest = table, .m_source = records.data(), .m_size = tableSize});
+   StagingCopy::ParallelStreamingCopy(nullptr, copyRanges);
+
+   const VkDeviceAddress stagingAddress = frameStaging->m_stagingBuffer->GetDeviceAddress() + stagingOffset;
+   PushConstants pushConstants{.m_tableAddress = stagingAddress,
+                               .m_sourceAddress = stagingAddress + tableSize,
+                               .m_destAddress = p_destBuffer->GetDeviceAddress()};
+
+   p_commandBuffer->AddOwnershipAcquire(p_destBuffer);
+
+   // The Buffers are only accessed through their device addresses, which the recorded commands don't see
+   p_commandBuffer->AddReferencedResource(frameStaging->m_stagingBuffer.get());
+   p_commandBuffer->AddReferencedResource(p_destBuffer.get());
+
+   // Wait for the previous accesses of the Buffer, and make the writes visible to all the commands that follow
+   const VkPipelineStageFlags2 allCommands = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+   const VkAccessFlags2 allAccesses = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+   const VkPipelineStageFlags2 computeShader = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+   const VkAccessFlags2 storageWrite = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+   p_commandBuffer->PipelineBarrier()->AddBufferBarrier(allCommands, allAccesses, computeShader, storageWrite,
+                                                        VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, p_destBuffer, 0u,
+                                                        VK_WHOLE_SIZE);
+
+   p_commandBuffer->BindPipeline(m_computePipeline);
+
+   const uint32_t recordCount = static_cast<uint32_t>(p_scatterUploadRequests.size());
+   for (uint32_t firstRecord = 0u; firstRecord < recordCount; firstRecord += m_maxRecordsPerDispatch)
+   {
+      pushConstants.m_firstRecord = firstRecord;
+      pushConstants.m_recordCount = eastl::min(recordCount - firstRecord, m_maxRecordsPerDispatch);
+      p_commandBuffer->PushConstants(m_computePipeline, 0u, &pushConstants, static_cast<uint32_t>(sizeof(PushConstants)));
+
+      const uint32_t invocationCount = pushConstants.m_recordCount * LanesPerRecord;
+      p_commandBuffer->Dispatch((invocationCount + WorkgroupSize - 1u) / WorkgroupSize, 1u, 1u);
+   }
+
+   p_commandBuffer->PipelineBarrier()->AddBufferBarrier(computeShader, storageWrite, allCommands, allAccesses,
+                                                        VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, p_destBuffer, 0u,
+                                                        VK_WHOLE_SIZE);
+}
+
+uint64_t ScatterUploader::AllocateStaging(uint64_t p_size, FrameStaging*& p_frameStaging)
+{
+   std::lock_guard<std::mutex> lock(m_stagingMutex);
+
+   // The staging memory of a resource index is reused once the frame that used it last is complete
+   const uint64_t frameIndex = RenderStateInterface::Get()->GetFrameIndex();
+   FrameStaging& frameStaging = m_frameStagings[RenderStateInterface::Get()->GetResourceIndex()];
+   if (frameStaging.m_frameIndex != frameIndex)
+   {
+      frameStaging.m_frameIndex = frameIndex;
+      frameStaging.m_offset = 0u;
+   }
+
+   const uint64_t offset = (frameStaging.m_offset + Internal::StagingAlignment - 1u) / Internal::StagingAlignment *
+                           Internal::StagingAlignment;
+   ASSERT(offset + p_size <= m_descriptor.m_stagingSizeInBytesPerFrame,
+          "The staging memory of the frame is exhausted, increase m_stagingSizeInBytesPerFrame");
+   frameStaging.m_offset = offset + p_size;
+
+   p_frameStaging = &frameStaging;
+   return offset;
+}
+
+} // namespace Render
@@ -0,0 +1,116 @@
+#include <StagingCopy.h>
+
+#include <string.h>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#define RENDERICHI_STREAMING_STORES 1
+#include <emmintrin.h>
+#else
+#define RENDERICHI_STREAMING_STORES 0
+#endif
+
+#include <EASTL/algorithm.h>
+
+#include <Std/vector.h>
+
+#include <TaskScheduler.h>
+
+#include <Util/Assert.h>
+
+namespace Render
+{
+
+namespace StagingCopy
+{
+
+void StreamingCopy(void* p_dest, const void* p_source, uint64_t p_size)
+{
+#if RENDERICHI_STREAMING_STORES
+   uint8_t* dest = static_cast<uint8_t*>(p_dest);
+   const uint8_t* source = static_cast<const uint8_t*>(p_source);
+
+   // Non-temporal stores require an aligned destination, copy the head with a regular copy
+   const uint64_t headSize = eastl::min(static_cast<uint64_t>((16u - (reinterpret_cast<uintptr_t>(dest) & 15u)) & 15u), p_size);
+   memcpy(dest, source, headSize);
+   dest += headSize;
+   source += headSize;
+   p_size -= headSize;
+
+   // Stream 64 bytes per iteration, which fills a whole write-combine buffer
+   while (p_size >= 64u)
+   {
+      const __m128i data0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source) + 0);
+      const __m128i data1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source) + 1);
+      const __m128i data2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source) + 2);
+      const __m128i data3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source) + 3);
+      _mm_stream_si128(reinterpret_cast<__m128i*>(dest) + 0, data0);
+      _mm_stream_si128(reinterpret_cast<__m128i*>(dest) + 1, data1);
+      _mm_stream_si128(reinterpret_cast<__m128i*>(dest) + 2, data2);
+      _mm_stream_si128(reinterpret_cast<__m128i*>(dest) + 3, data3);
+
+      dest += 64u;
+      source += 64u;
+      p_size -= 64u;
+   }
+
+   memcpy(dest, source, p_size);
+
+   // Streaming stores are weakly ordered, make them visible before the staging memory is submitted
+   _mm_sfence();
+#else
+   memcpy(p_dest, p_source, p_size);
+#endif
+}
+
+void ParallelStreamingCopy(enki::TaskScheduler* p_taskScheduler, Std::span<const CopyRange> p_copyRanges)
+{
+   // Start offset of each range when all the ranges are laid out after one another
+   Std::vector<uint64_t> rangeOffsets;
+   rangeOffsets.reserve(p_copyRanges.size());
+   uint64_t totalSize = 0u;
+   for (const CopyRange& copyRange : p_copyRanges)
+   {
+      rangeOffsets.push_back(totalSize);
+      totalSize += copyRange.m_size;
+   }
+
+   if (p_taskScheduler == nullptr || totalSize < ParallelCopyThresholdInBytes)
+   {
+      for (const CopyRange& copyRange : p_copyRanges)
+      {
+         StreamingCopy(copyRange.m_dest, copyRange.m_source, copyRange.m_size);
+      }
+      return;
+   }
+
+   const uint32_t sliceCount =
+       static_cast<uint32_t>((totalSize + ParallelCopySliceSizeInBytes - 1u) / ParallelCopySliceSizeInBytes);
+   enki::TaskSet copyTask(sliceCount, [&](enki::TaskSetPartition p_range, [[maybe_unused]] uint32_t p_threadNum) {
+      const uint64_t begin = p_range.start * ParallelCopySliceSizeInBytes;
+      const uint64_t end = eastl::min(p_range.end * ParallelCopySliceSizeInBytes, totalSize);
+
+      // Find the range that contains the first byte of the slice, and copy until the end of the slice
+      uint64_t rangeIndex =
+          static_cast<uint64_t>(eastl::upper_bound(rangeOffsets.begin(), rangeOffsets.end(), begin) - rangeOffsets.begin()) - 1u;
+      uint64_t offset = begin;
+      while (offset < end)
+      {
+         const CopyRange& copyRange = p_copyRanges[rangeIndex];
+         const uint64_t offsetInRange = offset - rangeOffsets[rangeIndex];
+         const uint64_t copySize = eastl::min(copyRange.m_size - offsetInRange, end - offset);
+
+         StreamingCopy(static_cast<uint8_t*>(copyRange.m_dest) + offsetInRange,
+                       static_cast<const uint8_t*>(copyRange.m_source) + offsetInRange, copySize);
+
+         offset += copySize;
+         rangeIndex++;
+      }
+   });
+
+   p_taskScheduler->AddTaskSetToPipe(&copyTask);
+   p_taskScheduler->WaitforTask(&copyTask);
+}
+
+}; // namespace StagingCopy
+
+}; // namespace Render
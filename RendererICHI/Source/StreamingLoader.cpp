@@ -0,0 +1,177 @@
+#include <StreamingLoader.h>
+
+#include <EASTL/algorithm.h>
+
+#include <Util/Assert.h>
+
+#include <Buffer.h>
+#include <MappedFile.h>
+
+namespace Render
+{
+
+namespace
+{
+namespace Internal
+{
+// Upper bound of the source bytes that are read by a region, starting at the source offset of the region
+uint64_t GetRegionSourceSize(const ImageUploadRequest& p_request, const ImageUploadRegion& p_region)
+{
+   const uint64_t blocksPerRow = (p_region.m_imageExtent.width + p_request.m_texelBlockWidth - 1u) / p_request.m_texelBlockWidth;
+   const uint64_t rowCount = (p_region.m_imageExtent.height + p_request.m_texelBlockHeight - 1u) / p_request.m_texelBlockHeight;
+   const uint64_t packedRowPitch = blocksPerRow * p_request.m_texelBlockSizeInBytes;
+   const uint64_t sourceRowPitch = p_region.m_sourceRowPitchInBytes == 0u ? packedRowPitch : p_region.m_sourceRowPitchInBytes;
+   return sourceRowPitch * rowCount * p_region.m_imageExtent.depth * p_region.m_layerCount;
+}
+}; // namespace Internal
+}; // namespace
+
+StreamingLoader::StreamingLoader(StreamingLoaderDescriptor&& p_desc)
+{
+   m_descriptor = p_desc;
+
+   ASSERT(m_descriptor.m_chunkSizeInBytes > 0u, "Chunk size must be larger than 0");
+   ASSERT(m_descriptor.m_chunkSizeInBytes <= m_descriptor.m_maxBytesInFlight, "A chunk must fit within the bytes in flight limit");
+}
+
+template <typename T>
+UploadTicket StreamingLoader::QueueUpload(Std::span<T> p_uploadRequests)
+{
+   AsyncUploadQueueInterface* asyncUploadQueue = AsyncUploadQueueInterface::Get();
+
+   // Blocking on the budget would never return if this thread is the one that calls Flush, flush instead once the wait times out.
+   // Other threads only submit the pending uploads, which frees staging memory without resetting the budgets of the frame
+   UploadTicket uploadTicket;
+   while (asyncUploadQueue->TryQueueUpload(p_uploadRequests, m_descriptor.m_flushTimeoutInNanoSeconds, uploadTicket,
+                                           m_descriptor.m_priority) == UploadResult::RetryLater)
+   {
+      if (m_descriptor.m_callsFlush)
+      {
+         asyncUploadQueue->Flush();
+      }
+      else
+      {
+         asyncUploadQueue->SubmitPendingUploads();
+      }
+   }
+
+   return uploadTicket;
+}
+
+UploadTicket StreamingLoader::LoadBuffer(const StreamingBufferLoadRequest& p_request)
+{
+   MappedFile mappedFile;
+   [[maybe_unused]] const bool opened = mappedFile.Open(p_request.m_path.c_str());
+   ASSERT(opened, "Failed to map the file");
+   ASSERT(p_request.m_fileOffsetInBytes <= mappedFile.GetSize(), "File offset is out of the bounds of the file");
+
+   const uint64_t sizeInBytes = eastl::min(p_request.m_sizeInBytes, mappedFile.GetSize() - p_request.m_fileOffsetInBytes);
+   const uint64_t chunkSize = m_descriptor.m_chunkSizeInBytes;
+   const uint64_t readaheadSize = chunkSize * m_descriptor.m_readaheadChunkCount;
+
+   // Start reading the first chunks before the first copy touches them
+   mappedFile.WillNeed(p_request.m_fileOffsetInBytes, chunkSize + readaheadSize);
+
+   UploadTicket uploadTicket;
+   for (uint64_t offset = 0u; offset < sizeInBytes; offset += chunkSize)
+   {
+      const uint64_t copySize = eastl::min(chunkSize, sizeInBytes - offset);
+      const uint64_t fileOffset = p_request.m_fileOffsetInBytes + offset;
+
+      ReserveBytesInFlight(copySize);
+
+      // Keep the readahead window in front of the chunk that is copied
+      mappedFile.WillNeed(fileOffset + readaheadSize, chunkSize);
+
+      BufferUploadRequest uploadRequest{.m_sourceData = mappedFile.GetData() + fileOffset,
+                                        .m_copySizeInBytes = copySize,
+                                        .m_destBuffer = p_request.m_destBuffer,
+                                        .m_destOffsetInBytes = p_request.m_destOffsetInBytes + offset};
+      uploadTicket = QueueUpload(Std::span<BufferUploadRequest>(&uploadRequest, 1u));
+
+      // The chunk is copied into the staging memory, its pages aren't needed anymore
+      mappedFile.DontNeed(fileOffset, copySize);
+
+      m_inFlightChunks.push_back(InFlightChunk{.m_uploadTicket = uploadTicket, .m_sizeInBytes = copySize});
+      m_bytesInFlight += copySize;
+   }
+
+   return uploadTicket;
+}
+
+UploadTicket StreamingLoader::LoadImage(const StreamingImageLoadRequest& p_request)
+{
+   MappedFile mappedFile;
+   [[maybe_unused]] const bool opened = mappedFile.Open(p_request.m_path.c_str());
+   ASSERT(opened, "Failed to map the file");
+   ASSERT(p_request.m_fileOffsetInBytes <= mappedFile.GetSize(), "File offset is out of the bounds of the file");
+
+   ImageUploadRequest uploadRequest = p_request.m_imageUploadRequest;
+   uploadRequest.m_sourceData = mappedFile.GetData() + p_request.m_fileOffsetInBytes;
+
+   // The regions are staged by a single request, the bytes in flight limit applies to the whole request
+   uint64_t sourceSize = 0u;
+   for (const ImageUploadRegion& uploadRegion : uploadRequest.m_regions)
+   {
+      const uint64_t regionSourceSize = Internal::GetRegionSourceSize(uploadRequest, uploadRegion);
+      sourceSize = eastl::max(sourceSize, uploadRegion.m_sourceOffsetInBytes + regionSourceSize);
+
+      mappedFile.WillNeed(p_request.m_fileOffsetInBytes + uploadRegion.m_sourceOffsetInBytes, regionSourceSize);
+   }
+   ASSERT(p_request.m_fileOffsetInBytes + sourceSize <= mappedFile.GetSize(), "Regions are out of the bounds of the file");
+
+   // Requests larger than the limit are counted as the whole limit, they wait for all the chunks in flight
+   const uint64_t inFlightSize = eastl::min(sourceSize, m_descriptor.m_maxBytesInFlight);
+   ReserveBytesInFlight(inFlightSize);
+
+   const UploadTicket uploadTicket = QueueUpload(Std::span<ImageUploadRequest>(&uploadRequest, 1u));
+   mappedFile.DontNeed(p_request.m_fileOffsetInBytes, sourceSize);
+
+   m_inFlightChunks.push_back(InFlightChunk{.m_uploadTicket = uploadTicket, .m_sizeInBytes = inFlightSize});
+   m_bytesInFlight += inFlightSize;
+
+   return uploadTicket;
+}
+
+void StreamingLoader::WaitForAll()
+{
+   if (!m_inFlightChunks.empty())
+   {
+      // Chunks complete in order, waiting for the last one waits for all of them
+      AsyncUploadQueueInterface::Get()->WaitForUpload(m_inFlightChunks.back().m_uploadTicket);
+   }
+
+   m_inFlightChunks.clear();
+   m_bytesInFlight = 0u;
+}
+
+uint64_t StreamingLoader::GetBytesInFlight() const
+{
+   return m_bytesInFlight;
+}
+
+void StreamingLoader::ReserveBytesInFlight(uint64_t p_sizeInBytes)
+{
+   AsyncUploadQueueInterface* asyncUploadQueue = AsyncUploadQueueInterface::Get();
+
+   uint32_t retiredCount = 0u;
+   for (const InFlightChunk& inFlightChunk : m_inFlightChunks)
+   {
+      // Wait for the oldest chunk while the new chunk doesn't fit
+      if (m_bytesInFlight + p_sizeInBytes > m_descriptor.m_maxBytesInFlight)
+      {
+         asyncUploadQueue->WaitForUpload(inFlightChunk.m_uploadTicket);
+      }
+      else if (!asyncUploadQueue->IsUploadComplete(inFlightChunk.m_uploadTicket))
+      {
+         break;
+      }
+
+      m_bytesInFlight -= inFlightChunk.m_sizeInBytes;
+      retiredCount++;
+   }
+
+   m_inFlightChunks.erase(m_inFlightChunks.begin(), m_inFlightChunks.begin() + retiredCount);
+}
+
+} // namespace Render
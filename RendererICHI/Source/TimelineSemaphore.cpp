@@ -36,7 +36,7 @@ VkSemaphore TimelineSemaphore::GetTimelineSemaphoreNative() const
    return m_semaphoreNative;
 }
 
-void TimelineSemaphore::WaitForValue(uint64_t p_value)
+bool TimelineSemaphore::WaitForValue(uint64_t p_value, uint64_t p_waitInNanoSeconds /* = static_cast<uint64_t>(-1)*/)
 {
    VkSemaphoreWaitInfo waitInfo;
    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
@@ -46,8 +46,20 @@ void TimelineSemaphore::WaitForValue(uint64_t p_value)
    waitInfo.pSemaphores = &m_semaphoreNative;
    waitInfo.pValues = &p_value;
 
-   [[maybe_unused]] const VkResult res = vkWaitSemaphores(m_vulkanDevice->GetLogicalDeviceNative(), &waitInfo, UINT64_MAX);
-   ASSERT(res == VK_SUCCESS, "Failed to wait for the TimelineSemaphore");
+   const VkResult res = vkWaitSemaphores(m_vulkanDevice->GetLogicalDeviceNative(), &waitInfo, p_waitInNanoSeconds);
+   ASSERT(res == VK_SUCCESS || res == VK_TIMEOUT, "Failed to wait for the TimelineSemaphore");
+
+   return res == VK_SUCCESS;
+}
+
+uint64_t TimelineSemaphore::GetCurrentValue() const
+{
+   uint64_t value = 0u;
+   [[maybe_unused]] const VkResult res =
+       vkGetSemaphoreCounterValue(m_vulkanDevice->GetLogicalDeviceNative(), m_semaphoreNative, &value);
+   ASSERT(res == VK_SUCCESS, "Failed to get the value of the TimelineSemaphore");
+
+   return value;
 }
 
 } // namespace Render
@@ -16,6 +16,7 @@
 #include <Semaphore.h>
 #include <TimelineSemaphore.h>
 #include <Fence.h>
+#include <AsyncUploadQueueInterface.h>
 #include <CommandBuffer.h>
 #include <CommandPool.h>
 #include <Swapchain.h>
@@ -77,12 +78,13 @@ bool VulkanDevice::QueueFamily::AvailableQueue() const
 
 uint32_t VulkanDevice::QueueFamily::GetSupportedQueuesCount() const
 {
-   // TODO: this might fail if the queues get updated on Vulkan's side
-   const uint32_t QueueTypeCount = 5u;
+   // Only count the queue types that work is submitted to. Transfer-only QueueFamilies usually support sparse binding as well,
+   // which shouldn't make them less suited for transfers than a QueueFamily that supports everything.
+   const VkQueueFlags queueTypes[] = {VK_QUEUE_GRAPHICS_BIT, VK_QUEUE_COMPUTE_BIT, VK_QUEUE_TRANSFER_BIT};
    uint32_t supportedQueueTypes = 0u;
-   for (uint32_t i = 0; i < QueueTypeCount; i++)
+   for (const VkQueueFlags queueType : queueTypes)
    {
-      if (m_queueFamilyProperties.queueFlags & (1 << i))
+      if (m_queueFamilyProperties.queueFlags & queueType)
       {
          supportedQueueTypes++;
       }
@@ -328,6 +330,11 @@ bool VulkanDevice::IsDiscreteGpu() const
    return (m_physicalDeviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU);
 }
 
+const VkPhysicalDeviceProperties& VulkanDevice::GetPhysicalDeviceProperties() const
+{
+   return m_physicalDeviceProperties;
+}
+
 void VulkanDevice::CreateLogicalDevice(Std::vector<const char*>&& p_deviceExtensions)
 {
    // Store the extensions that are enabled
@@ -411,6 +418,27 @@ void VulkanDevice::CreateLogicalDevice(Std::vector<const char*>&& p_deviceExtens
       ASSERT(result == VK_SUCCESS, "Failed to create a logical device");
    }
 
+   // Query the import limits of host allocations if the extension is enabled
+   m_externalMemoryHostEnabled =
+       eastl::any_of(p_deviceExtensions.begin(), p_deviceExtensions.end(), [](const char* p_deviceExtension) {
+          return strcmp(p_deviceExtension, VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME) == 0;
+       });
+   if (m_externalMemoryHostEnabled)
+   {
+      VkPhysicalDeviceExternalMemoryHostPropertiesEXT externalMemoryHostProperties = {};
+      externalMemoryHostProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT;
+
+      VkPhysicalDeviceProperties2 physicalDeviceProperties = {};
+      physicalDeviceProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+      physicalDeviceProperties.pNext = &externalMemoryHostProperties;
+      vkGetPhysicalDeviceProperties2(m_physicalDevice, &physicalDeviceProperties);
+
+      m_minImportedHostPointerAlignment = externalMemoryHostProperties.minImportedHostPointerAlignment;
+      m_getMemoryHostPointerProperties = reinterpret_cast<PFN_vkGetMemoryHostPointerPropertiesEXT>(
+          vkGetDeviceProcAddr(m_logicalDevice, "vkGetMemoryHostPointerPropertiesEXT"));
+      m_externalMemoryHostEnabled = m_getMemoryHostPointerProperties != nullptr;
+   }
+
    // Get the queues from the Logical Device
    {
       const auto GetQueueFromDevice = [this](const QueueFamilyHandle& p_handle) {
@@ -418,6 +446,7 @@ void VulkanDevice::CreateLogicalDevice(Std::vector<const char*>&& p_deviceExtens
          if (queueIt == m_queues.end())
          {
             vkGetDeviceQueue(m_logicalDevice, p_handle.m_queueFamilyIndex, p_handle.m_queueIndex, &m_queues[p_handle]);
+            m_queueMutexes[p_handle] = Std::unique_ptr<std::mutex>(new std::mutex());
          }
       };
 
@@ -464,33 +493,59 @@ VkQueue VulkanDevice::GetGraphicsQueueNative() const
 }
 
 eastl::tuple<VkDeviceMemory, uint64_t> VulkanDevice::AllocateDeviceMemory(VkMemoryRequirements p_memoryRequirements,
-                                                                          MemoryPropertyFlags p_memoryProperties)
+                                                                          MemoryPropertyFlags p_memoryProperties,
+                                                                          bool p_deviceAddress /*= false*/)
 {
-   const auto GetMemoryTypeIndex = [this](uint32_t p_typeBits, MemoryPropertyFlags p_memoryProperties) -> uint32_t {
-      VkMemoryPropertyFlags memoryPropertyFlagsNative = RenderTypeToNative::MemoryPropertyFlagsToNative(p_memoryProperties);
+   static constexpr uint32_t InvalidMemoryTypeIndex = static_cast<uint32_t>(-1);
+
+   const auto FindMemoryTypeIndex = [this](uint32_t p_typeBits, VkMemoryPropertyFlags p_memoryPropertyFlagsNative) -> uint32_t {
       // Iterate over all memory types available for the device used in this example
       for (uint32_t i = 0; i < m_deviceMemoryProperties.memoryTypeCount; i++)
       {
          if (((p_typeBits >> i) & 1u) == 1u)
          {
-            if ((m_deviceMemoryProperties.memoryTypes[i].propertyFlags & memoryPropertyFlagsNative) == memoryPropertyFlagsNative)
+            if ((m_deviceMemoryProperties.memoryTypes[i].propertyFlags & p_memoryPropertyFlagsNative) ==
+                p_memoryPropertyFlagsNative)
             {
                return i;
             }
          }
       }
 
-      ASSERT(false, "Can't find a index into the DeviceMemoryProperties which support these combinations of memory properties");
-      return static_cast<uint32_t>(-1);
+      return InvalidMemoryTypeIndex;
+   };
+
+   const auto GetMemoryTypeIndex = [&FindMemoryTypeIndex](uint32_t p_typeBits, MemoryPropertyFlags p_memoryProperties) -> uint32_t {
+      const VkMemoryPropertyFlags memoryPropertyFlagsNative = RenderTypeToNative::MemoryPropertyFlagsToNative(p_memoryProperties);
+
+      uint32_t memoryTypeIndex = FindMemoryTypeIndex(p_typeBits, memoryPropertyFlagsNative);
+
+      // Lazily allocated memory is usually only exposed on tile-based and integrated GPUs, and host cached memory isn't exposed in
+      // every combination. Both are preferences, fall back to the same memory properties without them
+      static constexpr VkMemoryPropertyFlags OptionalMemoryProperties =
+          VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+      if (memoryTypeIndex == InvalidMemoryTypeIndex && (memoryPropertyFlagsNative & OptionalMemoryProperties))
+      {
+         memoryTypeIndex = FindMemoryTypeIndex(p_typeBits, memoryPropertyFlagsNative & ~OptionalMemoryProperties);
+      }
+
+      ASSERT(memoryTypeIndex != InvalidMemoryTypeIndex,
+             "Can't find a index into the DeviceMemoryProperties which support these combinations of memory properties");
+      return memoryTypeIndex;
    };
 
    VkDeviceMemory deviceMemory = VK_NULL_HANDLE;
    uint64_t allocatedSize = 0u;
    {
+      const VkMemoryAllocateFlagsInfo memoryAllocateFlagsInfo{.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
+                                                              .pNext = nullptr,
+                                                              .flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT,
+                                                              .deviceMask = 0u};
+
       // Allocate the memory
       VkMemoryAllocateInfo memoryAllocateInfo = {};
       memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-      memoryAllocateInfo.pNext = nullptr;
+      memoryAllocateInfo.pNext = p_deviceAddress ? &memoryAllocateFlagsInfo : nullptr;
       memoryAllocateInfo.allocationSize = p_memoryRequirements.size;
       memoryAllocateInfo.memoryTypeIndex = GetMemoryTypeIndex(p_memoryRequirements.memoryTypeBits, p_memoryProperties);
       [[maybe_unused]] const VkResult res = vkAllocateMemory(GetLogicalDeviceNative(), &memoryAllocateInfo, nullptr, &deviceMemory);
@@ -503,15 +558,84 @@ eastl::tuple<VkDeviceMemory, uint64_t> VulkanDevice::AllocateDeviceMemory(VkMemo
    return {deviceMemory, allocatedSize};
 }
 
+VkDeviceMemory VulkanDevice::ImportHostMemory(VkMemoryRequirements p_memoryRequirements, const void* p_hostPointer)
+{
+   ASSERT(m_externalMemoryHostEnabled, "VK_EXT_external_memory_host isn't enabled");
+   ASSERT(reinterpret_cast<uintptr_t>(p_hostPointer) % m_minImportedHostPointerAlignment == 0u &&
+              p_memoryRequirements.size % m_minImportedHostPointerAlignment == 0u,
+          "Imported host memory must be aligned to the minimum imported host pointer alignment");
+
+   // The host allocation limits the memory types it can be imported as
+   VkMemoryHostPointerPropertiesEXT hostPointerProperties = {};
+   hostPointerProperties.sType = VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT;
+   if (m_getMemoryHostPointerProperties(m_logicalDevice, VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT, p_hostPointer,
+                                        &hostPointerProperties) != VK_SUCCESS)
+   {
+      return VK_NULL_HANDLE;
+   }
+
+   // Take the first memory type that both the Buffer and the host allocation support
+   const uint32_t memoryTypeBits = p_memoryRequirements.memoryTypeBits & hostPointerProperties.memoryTypeBits;
+   uint32_t memoryTypeIndex = 0u;
+   while (memoryTypeIndex < m_deviceMemoryProperties.memoryTypeCount && ((memoryTypeBits >> memoryTypeIndex) & 1u) == 0u)
+   {
+      memoryTypeIndex++;
+   }
+   if (memoryTypeIndex == m_deviceMemoryProperties.memoryTypeCount)
+   {
+      return VK_NULL_HANDLE;
+   }
+
+   VkImportMemoryHostPointerInfoEXT importMemoryHostPointerInfo = {};
+   importMemoryHostPointerInfo.sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_HOST_POINTER_INFO_EXT;
+   importMemoryHostPointerInfo.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+   // The memory is only read by the device, the pointer isn't written through
+   importMemoryHostPointerInfo.pHostPointer = const_cast<void*>(p_hostPointer);
+
+   VkMemoryAllocateInfo memoryAllocateInfo = {};
+   memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+   memoryAllocateInfo.pNext = &importMemoryHostPointerInfo;
+   memoryAllocateInfo.allocationSize = p_memoryRequirements.size;
+   memoryAllocateInfo.memoryTypeIndex = memoryTypeIndex;
+
+   VkDeviceMemory deviceMemory = VK_NULL_HANDLE;
+   if (vkAllocateMemory(m_logicalDevice, &memoryAllocateInfo, nullptr, &deviceMemory) != VK_SUCCESS)
+   {
+      return VK_NULL_HANDLE;
+   }
+
+   return deviceMemory;
+}
+
 void VulkanDevice::QueueSubmit(QueueFamilyType p_executingQueueType, Std::span<Ptr<CommandBuffer>> p_commandBuffers,
                                Std::span<SemaphoreSubmitInfo> p_waitSemaphores,
                                Std::span<TimelineSemaphoreSubmitInfo> p_waitTimelineSemaphores,
                                Std::span<SemaphoreSubmitInfo> p_signalSemaphores,
                                Std::span<TimelineSemaphoreSubmitInfo> p_signalTimelineSemaphores, Ptr<Fence> p_signalOnCompletion)
 {
+   // CommandBuffers can read from resources that are still uploading, wait for the latest upload on the GPU
+   UploadTicket uploadTicket;
+   for (Ptr<CommandBuffer> commandBuffer : p_commandBuffers)
+   {
+      uploadTicket = MergeUploadTickets(uploadTicket, commandBuffer->GetUploadTicket());
+      for (Ptr<SubCommandBuffer> subCommandBuffer : commandBuffer->GetSubCommandBuffers())
+      {
+         uploadTicket = MergeUploadTickets(uploadTicket, subCommandBuffer->GetUploadTicket());
+      }
+   }
+
    Std::vector<VkSemaphoreSubmitInfo> waitSemaphores;
-   waitSemaphores.reserve(p_waitSemaphores.size() + p_waitTimelineSemaphores.size());
+   waitSemaphores.reserve(p_waitSemaphores.size() + p_waitTimelineSemaphores.size() + 1u);
    {
+      if (uploadTicket.m_value != 0u)
+      {
+         const TimelineSemaphoreSubmitInfo uploadWait =
+             AsyncUploadQueueInterface::Get()->GetUploadWaitInfo(uploadTicket, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+         waitSemaphores.emplace_back(VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO, nullptr,
+                                     uploadWait.m_timelineSemaphore->GetTimelineSemaphoreNative(), uploadWait.p_waitOrSignalValue,
+                                     uploadWait.m_stageMask, 0u);
+      }
+
       for (const SemaphoreSubmitInfo& semaphore : p_waitSemaphores)
       {
          waitSemaphores.emplace_back(VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO, nullptr, semaphore.m_semaphore->GetSemaphoreNative(),
@@ -552,16 +676,20 @@ void VulkanDevice::QueueSubmit(QueueFamilyType p_executingQueueType, Std::span<P
    }
 
    VkQueue queue = {};
+   QueueFamilyHandle queueFamilyHandle;
    switch (p_executingQueueType)
    {
    case QueueFamilyType::GraphicsQueue:
       queue = GetGraphicsQueueNative();
+      queueFamilyHandle = m_graphicsQueueFamilyHandle;
       break;
    case QueueFamilyType::ComputeQueue:
       queue = GetComputeQueueNative();
+      queueFamilyHandle = m_computeQueueFamilyHandle;
       break;
    case QueueFamilyType::TransferQueue:
       queue = GetTransferQueueNative();
+      queueFamilyHandle = m_transferQueueFamilyHandle;
       break;
    }
 
@@ -575,6 +703,8 @@ void VulkanDevice::QueueSubmit(QueueFamilyType p_executingQueueType, Std::span<P
                             .signalSemaphoreInfoCount = static_cast<uint32_t>(signalSemaphores.size()),
                             .pSignalSemaphoreInfos = signalSemaphores.data()};
 
+   // Threads submit to the same Queue concurrently, only the submit itself holds the lock
+   std::lock_guard<std::mutex> lock(*m_queueMutexes.find(queueFamilyHandle)->second);
    [[maybe_unused]] const VkResult res =
        vkQueueSubmit2(queue, 1u, &submitInfo, p_signalOnCompletion ? p_signalOnCompletion->GetFenceNative() : VK_NULL_HANDLE);
    ASSERT(res == VK_SUCCESS, "Failed to submit the queue");
@@ -600,6 +730,7 @@ void VulkanDevice::QueuePresent(Ptr<Swapchain> p_swapchain, uint32_t p_swapchain
    presentInfo.pWaitSemaphores = nativeWaitSemaphores.data();
    presentInfo.waitSemaphoreCount = static_cast<uint32_t>(nativeWaitSemaphores.size());
 
+   std::lock_guard<std::mutex> lock(*m_queueMutexes.find(m_graphicsQueueFamilyHandle)->second);
    const VkResult res = vkQueuePresentKHR(GetGraphicsQueueNative(), &presentInfo);
    ASSERT(res == VK_SUCCESS, "Failed to present the queue");
 }
@@ -635,6 +766,61 @@ uint32_t VulkanDevice::GetTransferQueueFamilyIndex() const
    return m_transferQueueFamilyHandle.m_queueFamilyIndex;
 }
 
+uint32_t VulkanDevice::GetQueueFamilyIndex(QueueFamilyType p_queueType) const
+{
+   switch (p_queueType)
+   {
+   case QueueFamilyType::GraphicsQueue:
+      return GetGraphicsQueueFamilyIndex();
+   case QueueFamilyType::ComputeQueue:
+      return GetCompuateQueueFamilyIndex();
+   case QueueFamilyType::TransferQueue:
+      return GetTransferQueueFamilyIndex();
+   default:
+      ASSERT(false, "Invalid QueueFamilyType");
+      return InvalidQueueFamilyIndex;
+   }
+}
+
+bool VulkanDevice::HasDedicatedTransferQueueFamily() const
+{
+   // A release has a single destination QueueFamily, resources that are also used by a separate compute QueueFamily can't be
+   // handed over by the transfer QueueFamily
+   return m_transferQueueFamilyHandle.m_queueFamilyIndex != m_graphicsQueueFamilyHandle.m_queueFamilyIndex &&
+          m_computeQueueFamilyHandle.m_queueFamilyIndex == m_graphicsQueueFamilyHandle.m_queueFamilyIndex;
+}
+
+bool VulkanDevice::IsBufferDeviceAddressSupported() const
+{
+   // All the supported features are enabled when the logical device is created
+   return m_supportedVulkan12Features.bufferDeviceAddress == VK_TRUE;
+}
+
+bool VulkanDevice::IsExternalMemoryHostEnabled() const
+{
+   return m_externalMemoryHostEnabled;
+}
+
+uint64_t VulkanDevice::GetMinImportedHostPointerAlignment() const
+{
+   return m_minImportedHostPointerAlignment;
+}
+
+bool VulkanDevice::CanImportHostMemory(const void* p_hostPointer, uint64_t p_size) const
+{
+   if (!m_externalMemoryHostEnabled || reinterpret_cast<uintptr_t>(p_hostPointer) % m_minImportedHostPointerAlignment != 0u ||
+       p_size % m_minImportedHostPointerAlignment != 0u)
+   {
+      return false;
+   }
+
+   VkMemoryHostPointerPropertiesEXT hostPointerProperties = {};
+   hostPointerProperties.sType = VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT;
+   const VkResult result = m_getMemoryHostPointerProperties(
+       m_logicalDevice, VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT, p_hostPointer, &hostPointerProperties);
+   return result == VK_SUCCESS && hostPointerProperties.memoryTypeBits != 0u;
+}
+
 const VulkanDevice::SurfaceProperties& VulkanDevice::GetSurfaceProperties() const
 {
    return m_surfaceProperties;
@@ -43,9 +43,13 @@
 #include <BufferView.h>
 #include <CommandPool.h>
 #include <AsyncUploadQueue.h>
+#include <AsyncReadbackQueue.h>
 #include <ResourceDeleter.h>
 #include <CommandPoolManager.h>
 #include <DescriptorPoolManager.h>
+#include <DescriptorSetCache.h>
+#include <BindlessDescriptorHeap.h>
+#include <ImmutableBufferCache.h>
 #include <RendererState.h>
 #include <ResourceTracker.h>
 #include <Semaphore.h>
@@ -215,6 +219,12 @@ Render::Ptr<Render::VulkanDevice> SelectPhysicalDeviceAndCreate(Std::vector<cons
       }
    }
 
+   // Optional, zero-copy uploads fall back to the staging memory without it
+   if (selectedDevice->IsDeviceExtensionSupported(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME))
+   {
+      p_deviceExtensions.push_back(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+   }
+
    // Select the compatible physical device, and create a logical device
    selectedDevice->CreateLogicalDevice(eastl::move(p_deviceExtensions));
 
@@ -302,6 +312,14 @@ void RenderFunction()
       AsyncUploadQueueInterface::Register(asyncUploadQueue.get());
    }
 
+   // Create and register the AsyncReadbackQueue
+   Std::unique_ptr<AsyncReadbackQueue> asyncReadbackQueue;
+   {
+      AsyncReadbackQueueDescriptor asyncReadbackQueueDesc{.m_vulkanDevice = vulkanDevice};
+      asyncReadbackQueue = Std::unique_ptr<AsyncReadbackQueue>(new AsyncReadbackQueue(eastl::move(asyncReadbackQueueDesc)));
+      AsyncReadbackQueueInterface::Register(asyncReadbackQueue.get());
+   }
+
    // Create and register the CommandPoolManager
    Std::unique_ptr<CommandPoolManager> commandPoolManager;
    {
@@ -310,15 +328,39 @@ void RenderFunction()
       CommandPoolManagerInterface::Register(commandPoolManager.get());
    }
 
+   // The render thread runs on the TaskScheduler, its workers allocate DescriptorSets from their own DescriptorPools
+   enki::TaskScheduler taskScheduler;
+   taskScheduler.Initialize();
+
    // Create and register the DescriptorPoolManager
    Std::unique_ptr<DescriptorPoolManager> descriptorPoolManager;
    {
-      DescriptorPoolManagerDescriptor desc{.m_vulkanDevice = vulkanDevice};
+      DescriptorPoolManagerDescriptor desc{.m_vulkanDevice = vulkanDevice, .m_taskScheduler = &taskScheduler};
       // Create the DescriptorSetLayoutManger
       descriptorPoolManager = Std::unique_ptr<DescriptorPoolManager>(new DescriptorPoolManager(eastl::move(desc)));
       DescriptorPoolManagerInterface::Register(descriptorPoolManager.get());
    }
 
+   // Create and register the DescriptorSetCache
+   Std::unique_ptr<DescriptorSetCache> descriptorSetCache;
+   {
+      DescriptorSetCacheDescriptor desc{.m_vulkanDevice = vulkanDevice};
+      descriptorSetCache = Std::unique_ptr<DescriptorSetCache>(new DescriptorSetCache(eastl::move(desc)));
+      DescriptorSetCacheInterface::Register(descriptorSetCache.get());
+   }
+
+   // Create and register the BindlessDescriptorHeap
+   Std::unique_ptr<BindlessDescriptorHeap> bindlessDescriptorHeap;
+   {
+      BindlessDescriptorHeapDescriptor desc{.m_vulkanDevice = vulkanDevice};
+      bindlessDescriptorHeap = Std::unique_ptr<BindlessDescriptorHeap>(new BindlessDescriptorHeap(eastl::move(desc)));
+      BindlessDescriptorHeapInterface::Register(bindlessDescriptorHeap.get());
+   }
+
+   // Create and register the ImmutableBufferCache
+   Std::unique_ptr<ImmutableBufferCache> immutableBufferCache(new ImmutableBufferCache());
+   ImmutableBufferCacheInterface::Register(immutableBufferCache.get());
+
    // Load the Shader binaries, create the ShaderModules, and create the ShaderStages
    Ptr<ShaderModule> vertexShaderModule;
    Ptr<ShaderModule> fragmentShaderModule;
@@ -457,14 +499,17 @@ void RenderFunction()
       ImageDescriptor imageDesc;
       imageDesc.m_vulkanDevice = vulkanDevice;
       imageDesc.m_imageCreationFlags = {};
-      imageDesc.m_imageUsageFlags = ImageUsageFlags::DepthStencilAttachment;
+      // The DepthBuffer's contents aren't needed after the pass, create it as a transient attachment
+      imageDesc.m_imageUsageFlags = Foundation::Util::SetFlags<ImageUsageFlags>(ImageUsageFlags::DepthStencilAttachment,
+                                                                                ImageUsageFlags::TransientAttachment);
       imageDesc.m_imageType = VkImageType::VK_IMAGE_TYPE_2D;
       imageDesc.m_extend = extent;
       imageDesc.m_format = GetOptimalDepthFormat(vulkanDevice);
       imageDesc.m_mipLevels = 1u;
       imageDesc.m_arrayLayers = 1u;
       imageDesc.m_imageTiling = VK_IMAGE_TILING_OPTIMAL;
-      imageDesc.m_memoryProperties = MemoryPropertyFlags::DeviceLocal;
+      imageDesc.m_memoryProperties =
+          Foundation::Util::SetFlags<MemoryPropertyFlags>(MemoryPropertyFlags::DeviceLocal, MemoryPropertyFlags::LazilyAllocated);
       imageDesc.m_initialLayout = VkImageLayout::VK_IMAGE_LAYOUT_UNDEFINED;
       depthStencilImage = Image::CreateInstance(eastl::move(imageDesc));
    }
@@ -556,8 +601,6 @@ void RenderFunction()
    Std::queue<SubmitCommandBufferContext> comandBufferContexts;
    std::mutex comandBufferContextsMutex;
 
-   enki::TaskScheduler taskScheduler;
-   taskScheduler.Initialize();
    enki::TaskSet renderThread(
        1u, [&submitWaitTimelineSemaphore, &comandBufferContexts, &comandBufferContextsMutex, &vulkanDevice, swapchain,
             renderWindow]([[maybe_unused]] enki::TaskSetPartition p_range, [[maybe_unused]] uint32_t p_threadNum) //
@@ -618,6 +661,9 @@ void RenderFunction()
                                              timelineSignalSemaphores, {});
 
                    highestWaitValue = commandBufferContext.m_timelineSemaphoreWaitValue;
+
+                   // Submit the readbacks that were queued while recording the frame, they're ordered after the frame
+                   AsyncReadbackQueueInterface::Get()->Flush();
                 }
 
                 // Present
@@ -656,6 +702,21 @@ void RenderFunction()
       // From here on, the frame from RendererDefines::MaxQueuedFrames ago is guaranteed to be finished
       ResourceDeleterInterface::Get()->DeleteStaleResources();
 
+      // Release the cached Buffers that aren't used anymore, they're deleted once the device is done with them
+      ImmutableBufferCacheInterface::Get()->Update();
+
+      // Evict the DescriptorSets that weren't used by the frames in flight
+      DescriptorSetCacheInterface::Get()->Update();
+
+      // Recycle the bindless indices that aren't read by the frames in flight anymore
+      BindlessDescriptorHeapInterface::Get()->Update();
+
+      // Submit all the uploads that were queued since the last frame in a single submit
+      AsyncUploadQueueInterface::Get()->Flush();
+
+      // Invoke the callbacks of the readbacks that arrived
+      AsyncReadbackQueueInterface::Get()->Update();
+
       // Create the commandBuffer
       {
          CommandBufferDescriptor commandBufferDesc;
@@ -809,7 +870,7 @@ void RenderFunction()
             depthStencilAttachment.m_resolveImageView = nullptr;
             depthStencilAttachment.m_resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
             depthStencilAttachment.m_loadOp = AttachmentLoadOp::Clear;
-            depthStencilAttachment.m_storeOp = AttachmentStoreOp::Store;
+            // NOTE: StoreOp isn't set, BeginRenderingCommand defaults it to DontCare for transient attachments
             depthStencilAttachment.m_clearValue = {.depthStencil = {.depth = 0.0f, .stencil = 0}};
 
             VkRect2D renderArea = {};
@@ -859,6 +920,10 @@ void RenderFunction()
 
    CommandPoolManagerInterface::Unregister();
    DescriptorPoolManagerInterface::Unregister();
+   DescriptorSetCacheInterface::Unregister();
+   BindlessDescriptorHeapInterface::Unregister();
+   ImmutableBufferCacheInterface::Unregister();
+   AsyncReadbackQueueInterface::Unregister();
    AsyncUploadQueueInterface::Unregister();
 }
 
@@ -0,0 +1,167 @@
+#include <inttypes.h>
+
+#include <EASTL/algorithm.h>
+
+#include <Std/vector.h>
+
+#include <Lz4BlockCodec.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace Render;
+
+namespace
+{
+// Compresses the data, and decompresses it again with the exact decompressed size
+Std::vector<uint8_t> RoundTrip(const Std::vector<uint8_t>& p_data, uint64_t& p_compressedSize)
+{
+   Std::vector<uint8_t> compressedData(Lz4BlockCodec::GetMaxCompressedSize(p_data.size()));
+   p_compressedSize = Lz4BlockCodec::CompressBlock(p_data.data(), p_data.size(), compressedData.data());
+   REQUIRE(p_compressedSize <= compressedData.size());
+
+   Std::vector<uint8_t> decompressedData(p_data.size());
+   const Lz4BlockCodec codec;
+   REQUIRE(codec.DecompressBlock(compressedData.data(), p_compressedSize, decompressedData.data(), decompressedData.size()));
+   return decompressedData;
+}
+
+// Data that doesn't compress, generated with a fixed seed
+Std::vector<uint8_t> GenerateNoise(uint64_t p_size)
+{
+   Std::vector<uint8_t> data(p_size);
+   uint32_t state = 0x12345678u;
+   for (uint8_t& value : data)
+   {
+      state ^= state << 13u;
+      state ^= state >> 17u;
+      state ^= state << 5u;
+      value = static_cast<uint8_t>(state);
+   }
+   return data;
+}
+
+// Data with short repeating patterns, mixed with noise
+Std::vector<uint8_t> GenerateCompressible(uint64_t p_size)
+{
+   Std::vector<uint8_t> data = GenerateNoise(p_size);
+   for (uint64_t i = 0u; i < p_size; i++)
+   {
+      if ((i / 64u) % 4u != 3u)
+      {
+         data[i] = static_cast<uint8_t>(i % 23u);
+      }
+   }
+   return data;
+}
+}; // namespace
+
+TEST_CASE("Lz4BlockCodec round-trips blocks", "[Lz4BlockCodec]")
+{
+   uint64_t compressedSize = 0u;
+
+   SECTION("Empty block")
+   {
+      const Std::vector<uint8_t> data;
+      REQUIRE(RoundTrip(data, compressedSize) == data);
+   }
+
+   SECTION("Blocks that are too small to hold a match")
+   {
+      for (uint64_t size = 1u; size < 16u; size++)
+      {
+         const Std::vector<uint8_t> data(size, static_cast<uint8_t>(size));
+         REQUIRE(RoundTrip(data, compressedSize) == data);
+      }
+   }
+
+   SECTION("Compressible block")
+   {
+      const Std::vector<uint8_t> data = GenerateCompressible(256u * 1024u);
+      REQUIRE(RoundTrip(data, compressedSize) == data);
+      REQUIRE(compressedSize < data.size() / 2u);
+   }
+
+   SECTION("Incompressible block stays within the worst case size")
+   {
+      const Std::vector<uint8_t> data = GenerateNoise(64u * 1024u);
+      REQUIRE(RoundTrip(data, compressedSize) == data);
+      REQUIRE(compressedSize <= Lz4BlockCodec::GetMaxCompressedSize(data.size()));
+   }
+
+   SECTION("Long runs produce matches that overlap their own output")
+   {
+      Std::vector<uint8_t> data(100u * 1024u, 7u);
+      data[0] = 1u;
+      REQUIRE(RoundTrip(data, compressedSize) == data);
+      REQUIRE(compressedSize < 1024u);
+   }
+
+   SECTION("Matches further back than the maximum offset")
+   {
+      const Std::vector<uint8_t> pattern = GenerateNoise(1024u);
+      Std::vector<uint8_t> data = GenerateNoise(Lz4BlockCodec::MaxMatchOffset + 4096u);
+      eastl::copy(pattern.begin(), pattern.end(), data.begin());
+      eastl::copy(pattern.begin(), pattern.end(), data.end() - pattern.size());
+      REQUIRE(RoundTrip(data, compressedSize) == data);
+   }
+}
+
+TEST_CASE("Lz4BlockCodec rejects truncated and corrupt blocks", "[Lz4BlockCodec]")
+{
+   const Lz4BlockCodec codec;
+
+   const Std::vector<uint8_t> data = GenerateCompressible(16u * 1024u);
+   Std::vector<uint8_t> compressedData(Lz4BlockCodec::GetMaxCompressedSize(data.size()));
+   const uint64_t compressedSize = Lz4BlockCodec::CompressBlock(data.data(), data.size(), compressedData.data());
+   compressedData.resize(compressedSize);
+
+   Std::vector<uint8_t> decompressedData(data.size());
+
+   SECTION("Truncated blocks")
+   {
+      for (uint64_t truncatedSize = 0u; truncatedSize < compressedSize; truncatedSize++)
+      {
+         // Copy the truncated block, reading past its end is detected by the sanitizers
+         const Std::vector<uint8_t> truncatedData(compressedData.begin(), compressedData.begin() + truncatedSize);
+         REQUIRE_FALSE(
+             codec.DecompressBlock(truncatedData.data(), truncatedSize, decompressedData.data(), decompressedData.size()));
+      }
+   }
+
+   SECTION("Decompressed size doesn't match")
+   {
+      REQUIRE_FALSE(
+          codec.DecompressBlock(compressedData.data(), compressedSize, decompressedData.data(), decompressedData.size() - 1u));
+
+      Std::vector<uint8_t> largerData(data.size() + 1u);
+      REQUIRE_FALSE(codec.DecompressBlock(compressedData.data(), compressedSize, largerData.data(), largerData.size()));
+   }
+
+   SECTION("Match offset of 0")
+   {
+      // One literal, followed by a match with offset 0
+      const uint8_t corruptData[] = {0x10u, 'a', 0x00u, 0x00u, 0x00u};
+      REQUIRE_FALSE(codec.DecompressBlock(corruptData, sizeof(corruptData), decompressedData.data(), 5u));
+   }
+
+   SECTION("Match offset before the start of the block")
+   {
+      // One literal, followed by a match that starts 2 bytes back
+      const uint8_t corruptData[] = {0x10u, 'a', 0x02u, 0x00u, 0x00u};
+      REQUIRE_FALSE(codec.DecompressBlock(corruptData, sizeof(corruptData), decompressedData.data(), 5u));
+   }
+
+   SECTION("Literal length past the end of the block")
+   {
+      // The extended literal length is larger than the remaining data
+      const uint8_t corruptData[] = {0xf0u, 0x10u, 'a', 'b'};
+      REQUIRE_FALSE(codec.DecompressBlock(corruptData, sizeof(corruptData), decompressedData.data(), decompressedData.size()));
+   }
+
+   SECTION("Match length past the end of the output")
+   {
+      // Four literals, followed by a match of 4 bytes, into an output of 6 bytes
+      const uint8_t corruptData[] = {0x40u, 'a', 'b', 'c', 'd', 0x04u, 0x00u, 0x00u};
+      REQUIRE_FALSE(codec.DecompressBlock(corruptData, sizeof(corruptData), decompressedData.data(), 6u));
+   }
+}
@@ -0,0 +1,88 @@
+#include <inttypes.h>
+
+#include <StagingRingAllocator.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace Render;
+
+namespace
+{
+constexpr uint64_t Capacity = 1024u;
+constexpr uint64_t Alignment = 16u;
+}; // namespace
+
+TEST_CASE("StagingRingAllocator reserves and retires in order", "[StagingRingAllocator]")
+{
+   StagingRingAllocator allocator;
+   allocator.Init(Capacity);
+
+   StagingRingAllocator::Reservation first;
+   REQUIRE(allocator.Reserve(100u, Alignment, first));
+   REQUIRE(first.m_reservedFrom == 0u);
+   REQUIRE(first.m_start == 0u);
+   REQUIRE(first.m_end == 100u);
+
+   // The start is aligned, the padding belongs to the reservation
+   StagingRingAllocator::Reservation second;
+   REQUIRE(allocator.Reserve(100u, Alignment, second));
+   REQUIRE(second.m_reservedFrom == first.m_end);
+   REQUIRE(second.m_start == 112u);
+   REQUIRE(allocator.GetOffset(second.m_start) % Alignment == 0u);
+
+   SECTION("Full ring")
+   {
+      StagingRingAllocator::Reservation reservation;
+      REQUIRE_FALSE(allocator.Reserve(Capacity - 200u, Alignment, reservation));
+
+      allocator.Retire(first.m_end);
+      REQUIRE(allocator.GetTail() == second.m_reservedFrom);
+      REQUIRE(allocator.Reserve(Capacity - 224u, Alignment, reservation));
+   }
+
+   SECTION("Regions don't wrap around the end of the buffer")
+   {
+      allocator.Retire(first.m_end);
+      allocator.Retire(second.m_end);
+
+      StagingRingAllocator::Reservation reservation;
+      REQUIRE(allocator.Reserve(Capacity - 256u, Alignment, reservation));
+      REQUIRE(allocator.Reserve(128u, Alignment, reservation));
+      REQUIRE(allocator.GetOffset(reservation.m_start) == 0u);
+      REQUIRE(reservation.m_start == Capacity);
+   }
+}
+
+TEST_CASE("StagingRingAllocator fits regions larger than half the capacity in an empty ring", "[StagingRingAllocator]")
+{
+   StagingRingAllocator allocator;
+   allocator.Init(Capacity);
+
+   // Move the head to an offset where a region of 3/4 of the capacity doesn't fit, neither before nor after the skip
+   StagingRingAllocator::Reservation small;
+   REQUIRE(allocator.Reserve(Capacity / 2u, Alignment, small));
+
+   const uint64_t largeSize = Capacity / 4u * 3u;
+   StagingRingAllocator::Reservation large;
+
+   SECTION("Doesn't fit while the ring isn't empty")
+   {
+      REQUIRE_FALSE(allocator.Reserve(largeSize, Alignment, large));
+   }
+
+   SECTION("Restarts the ring once it's empty")
+   {
+      allocator.Retire(small.m_end);
+      REQUIRE(allocator.Reserve(largeSize, Alignment, large));
+      REQUIRE(allocator.GetOffset(large.m_start) == 0u);
+      REQUIRE(large.m_reservedFrom == large.m_start);
+      REQUIRE(allocator.GetTail() == large.m_reservedFrom);
+
+      // The ring is in use again, the next region only fits after the large one is retired
+      StagingRingAllocator::Reservation next;
+      REQUIRE_FALSE(allocator.Reserve(largeSize, Alignment, next));
+      allocator.Retire(large.m_end);
+      REQUIRE(allocator.Reserve(largeSize, Alignment, next));
+      REQUIRE(next.m_start >= large.m_end);
+   }
+}
@@ -43,6 +43,7 @@
 #include <BufferView.h>
 #include <CommandPool.h>
 #include <AsyncUploadQueue.h>
+#include <AsyncReadbackQueue.h>
 #include <ResourceDeleter.h>
 #include <CommandPoolManager.h>
 #include <DescriptorPoolManager.h>
@@ -302,6 +303,14 @@ void RenderFunction()
       AsyncUploadQueueInterface::Register(asyncUploadQueue.get());
    }
 
+   // Create and register the AsyncReadbackQueue
+   Std::unique_ptr<AsyncReadbackQueue> asyncReadbackQueue;
+   {
+      AsyncReadbackQueueDescriptor asyncReadbackQueueDesc{.m_vulkanDevice = vulkanDevice};
+      asyncReadbackQueue = Std::unique_ptr<AsyncReadbackQueue>(new AsyncReadbackQueue(eastl::move(asyncReadbackQueueDesc)));
+      AsyncReadbackQueueInterface::Register(asyncReadbackQueue.get());
+   }
+
    // Create and register the CommandPoolManager
    Std::unique_ptr<CommandPoolManager> commandPoolManager;
    {
@@ -457,14 +466,17 @@ void RenderFunction()
       ImageDescriptor imageDesc;
       imageDesc.m_vulkanDevice = vulkanDevice;
       imageDesc.m_imageCreationFlags = {};
-      imageDesc.m_imageUsageFlags = ImageUsageFlags::DepthStencilAttachment;
+      // The DepthBuffer's contents aren't needed after the pass, create it as a transient attachment
+      imageDesc.m_imageUsageFlags = Foundation::Util::SetFlags<ImageUsageFlags>(ImageUsageFlags::DepthStencilAttachment,
+                                                                                ImageUsageFlags::TransientAttachment);
       imageDesc.m_imageType = VkImageType::VK_IMAGE_TYPE_2D;
       imageDesc.m_extend = extent;
       imageDesc.m_format = GetOptimalDepthFormat(vulkanDevice);
       imageDesc.m_mipLevels = 1u;
       imageDesc.m_arrayLayers = 1u;
       imageDesc.m_imageTiling = VK_IMAGE_TILING_OPTIMAL;
-      imageDesc.m_memoryProperties = MemoryPropertyFlags::DeviceLocal;
+      imageDesc.m_memoryProperties =
+          Foundation::Util::SetFlags<MemoryPropertyFlags>(MemoryPropertyFlags::DeviceLocal, MemoryPropertyFlags::LazilyAllocated);
       imageDesc.m_initialLayout = VkImageLayout::VK_IMAGE_LAYOUT_UNDEFINED;
       depthStencilImage = Image::CreateInstance(eastl::move(imageDesc));
    }
@@ -618,6 +630,9 @@ void RenderFunction()
                                              timelineSignalSemaphores, {});
 
                    highestWaitValue = commandBufferContext.m_timelineSemaphoreWaitValue;
+
+                   // Submit the readbacks that were queued while recording the frame, they're ordered after the frame
+                   AsyncReadbackQueueInterface::Get()->Flush();
                 }
 
                 // Present
@@ -656,6 +671,12 @@ void RenderFunction()
       // From here on, the frame from RendererDefines::MaxQueuedFrames ago is guaranteed to be finished
       ResourceDeleterInterface::Get()->DeleteStaleResources();
 
+      // Submit all the uploads that were queued since the last frame in a single submit
+      AsyncUploadQueueInterface::Get()->Flush();
+
+      // Invoke the callbacks of the readbacks that arrived
+      AsyncReadbackQueueInterface::Get()->Update();
+
       // Create the commandBuffer
       {
          CommandBufferDescriptor commandBufferDesc;
@@ -809,7 +830,7 @@ void RenderFunction()
             depthStencilAttachment.m_resolveImageView = nullptr;
             depthStencilAttachment.m_resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
             depthStencilAttachment.m_loadOp = AttachmentLoadOp::Clear;
-            depthStencilAttachment.m_storeOp = AttachmentStoreOp::Store;
+            // NOTE: StoreOp isn't set, BeginRenderingCommand defaults it to DontCare for transient attachments
             depthStencilAttachment.m_clearValue = {.depthStencil = {.depth = 0.0f, .stencil = 0}};
 
             VkRect2D renderArea = {};
@@ -859,6 +880,7 @@ void RenderFunction()
 
    CommandPoolManagerInterface::Unregister();
    DescriptorPoolManagerInterface::Unregister();
+   AsyncReadbackQueueInterface::Unregister();
    AsyncUploadQueueInterface::Unregister();
 }
 